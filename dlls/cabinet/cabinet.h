@@ -148,6 +148,7 @@ struct ZIPstate {
     cab_ULONG v[ZIPN_MAX];      /* values in order of bit length */
     cab_ULONG x[ZIPBMAX+1];     /* bit offsets, then code stack */
     cab_UBYTE *inpos;
+    const cab_UBYTE *inend;     /* end of the input data */
 };
   
 /* Quantum stuff */
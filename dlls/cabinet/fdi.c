@@ -164,7 +164,11 @@ typedef struct fdi_cds_fwd {
 } fdi_decomp_state;
 
 #define ZIPNEEDBITS(n) {while(k<(n)){cab_LONG c=*(ZIP(inpos)++);\
-    b|=((cab_ULONG)c)<<k;k+=8;}}
+    b|=((UINT64)c)<<k;k+=8;}}
+/* refills the bit buffer of fdi_Zipinflate_codes 32 bits at a time, enough
+ * for most length/distance pairs, while the input allows it */
+#define ZIPFILLBITS {if(k<=32&&ZIP(inpos)+4<=ZIP(inend)){\
+    b|=((UINT64)(cab_ULONG)EndGetI32(ZIP(inpos)))<<k;ZIP(inpos)+=4;k+=32;}}
 #define ZIPDUMPBITS(n) {b>>=(n);k-=(n);}
 
 /* endian-neutral reading of little-endian data */
@@ -1066,7 +1070,7 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
   cab_ULONG w;              /* current window position */
   const struct Ziphuft *t;  /* pointer to table entry */
   cab_ULONG ml, md;         /* masks for bl and bd bits */
-  register cab_ULONG b;     /* bit buffer */
+  register UINT64 b;        /* bit buffer */
   register cab_ULONG k;     /* number of bits in bit buffer */
 
   /* make local copies of globals */
@@ -1080,6 +1084,7 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
 
   for(;;)
   {
+    ZIPFILLBITS
     ZIPNEEDBITS((cab_ULONG)bl)
     if((e = (t = tl + (b & ml))->e) > 16)
       do
@@ -1124,7 +1129,13 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
         e = ZIPWSIZE - max(d, w);
         e = min(e, n);
         n -= e;
-        do
+        if (d < w && w - d >= e)    /* source and destination don't overlap */
+        {
+          memcpy(CAB(outbuf) + w, CAB(outbuf) + d, e);
+          w += e;
+          d += e;
+        }
+        else do
         {
           CAB(outbuf)[w++] = CAB(outbuf)[d++];
         } while (--e);
@@ -1132,9 +1143,13 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
     }
   }
 
+  /* hand the whole bytes left in the bit buffer back to the input */
+  ZIP(inpos) -= k >> 3;
+  k &= 7;
+
   /* restore the globals from the locals */
   ZIP(window_posn) = w;              /* restore global window pointer */
-  ZIP(bb) = b;                       /* restore global bit buffer */
+  ZIP(bb) = (cab_ULONG)b & Zipmask[k]; /* restore global bit buffer */
   ZIP(bk) = k;
 
   /* done */
@@ -1410,6 +1425,7 @@ static int ZIPfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
   TRACE("(inlen == %d, outlen == %d)\n", inlen, outlen);
 
   ZIP(inpos) = CAB(inbuf);
+  ZIP(inend) = CAB(inbuf) + inlen;
   ZIP(bb) = ZIP(bk) = ZIP(window_posn) = 0;
   if(outlen > ZIPWSIZE)
     return DECR_DATAFORMAT;
@@ -1775,7 +1791,10 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
             window_posn += match_length;
 
             /* copy match data - no worries about destination wraps */
-            while (match_length-- > 0) *rundest++ = *runsrc++;
+            if (runsrc + match_length <= rundest || rundest + match_length <= runsrc)
+              memcpy(rundest, runsrc, match_length);
+            else
+              while (match_length-- > 0) *rundest++ = *runsrc++;
           }
         }
         break;
@@ -1864,7 +1883,10 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
             window_posn += match_length;
 
             /* copy match data - no worries about destination wraps */
-            while (match_length-- > 0) *rundest++ = *runsrc++;
+            if (runsrc + match_length <= rundest || rundest + match_length <= runsrc)
+              memcpy(rundest, runsrc, match_length);
+            else
+              while (match_length-- > 0) *rundest++ = *runsrc++;
           }
         }
         break;
@@ -29,6 +29,7 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 
 #define COBJMACROS
 #include <d3d9.h>
@@ -21421,11 +21422,183 @@ done:
     DestroyWindow(window);
 }
 
+/* Runs in a child process, the command stream mode is read when wined3d is
+ * loaded. */
+static void test_multithreaded_cs_child(void)
+{
+    IDirect3DVertexBuffer9 *vb;
+    IDirect3DTexture9 *texture;
+    D3DLOCKED_RECT locked_rect;
+    IDirect3DDevice9 *device;
+    IDirect3D9 *d3d;
+    D3DCOLOR color, expected;
+    unsigned int i, j;
+    ULONG refcount;
+    HWND window;
+    HRESULT hr;
+    struct
+    {
+        struct vec3 position;
+        DWORD diffuse;
+    } *colored_quad;
+    static const struct
+    {
+        struct vec3 position;
+        struct vec2 texcoord;
+    }
+    tex_quad[] =
+    {
+        {{-1.0f, -1.0f, 0.1f}, {0.0f, 1.0f}},
+        {{-1.0f,  1.0f, 0.1f}, {0.0f, 0.0f}},
+        {{ 1.0f, -1.0f, 0.1f}, {1.0f, 1.0f}},
+        {{ 1.0f,  1.0f, 0.1f}, {1.0f, 0.0f}},
+    };
+
+    window = CreateWindowA("static", "d3d9_test", WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+            0, 0, 640, 480, NULL, NULL, NULL, NULL);
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+    if (!(device = create_device(d3d, window, window, TRUE)))
+    {
+        skip("Failed to create a D3D device, skipping tests.\n");
+        goto done;
+    }
+
+    hr = IDirect3DDevice9_CreateVertexBuffer(device, 4 * sizeof(*colored_quad), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,
+            D3DFVF_XYZ | D3DFVF_DIFFUSE, D3DPOOL_DEFAULT, &vb, NULL);
+    ok(SUCCEEDED(hr), "Failed to create vertex buffer, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_CreateTexture(device, 1, 1, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &texture, NULL);
+    ok(SUCCEEDED(hr), "Failed to create texture, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetRenderState(device, D3DRS_LIGHTING, FALSE);
+    ok(SUCCEEDED(hr), "Failed to disable lighting, hr %#x.\n", hr);
+
+    /* Every map has to see the results of the draws queued before it, and
+     * every draw the data written by the maps before it. */
+    for (i = 0; i < 64; ++i)
+    {
+        expected = D3DCOLOR_ARGB(0xff, i * 4, 0xff - i * 4, i & 1 ? 0xff : 0x00);
+
+        hr = IDirect3DVertexBuffer9_Lock(vb, 0, 0, (void **)&colored_quad, D3DLOCK_DISCARD);
+        ok(SUCCEEDED(hr), "Failed to lock vertex buffer, hr %#x.\n", hr);
+        for (j = 0; j < 4; ++j)
+        {
+            colored_quad[j].position.x = j & 2 ? 1.0f : -1.0f;
+            colored_quad[j].position.y = j & 1 ? 1.0f : -1.0f;
+            colored_quad[j].position.z = 0.1f;
+            colored_quad[j].diffuse = expected;
+        }
+        hr = IDirect3DVertexBuffer9_Unlock(vb);
+        ok(SUCCEEDED(hr), "Failed to unlock vertex buffer, hr %#x.\n", hr);
+
+        hr = IDirect3DDevice9_BeginScene(device);
+        ok(SUCCEEDED(hr), "Failed to begin scene, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetTexture(device, 0, NULL);
+        ok(SUCCEEDED(hr), "Failed to set texture, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ | D3DFVF_DIFFUSE);
+        ok(SUCCEEDED(hr), "Failed to set FVF, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetStreamSource(device, 0, vb, 0, sizeof(*colored_quad));
+        ok(SUCCEEDED(hr), "Failed to set stream source, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_DrawPrimitive(device, D3DPT_TRIANGLESTRIP, 0, 2);
+        ok(SUCCEEDED(hr), "Failed to draw, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_EndScene(device);
+        ok(SUCCEEDED(hr), "Failed to end scene, hr %#x.\n", hr);
+
+        color = getPixelColor(device, 320, 240);
+        ok(color_match(color, expected & 0x00ffffff, 1), "Iteration %u: got unexpected color 0x%08x.\n", i, color);
+
+        hr = IDirect3DTexture9_LockRect(texture, 0, &locked_rect, NULL, 0);
+        ok(SUCCEEDED(hr), "Failed to lock texture, hr %#x.\n", hr);
+        *(DWORD *)locked_rect.pBits = ~expected | 0xff000000;
+        hr = IDirect3DTexture9_UnlockRect(texture, 0);
+        ok(SUCCEEDED(hr), "Failed to unlock texture, hr %#x.\n", hr);
+
+        hr = IDirect3DDevice9_BeginScene(device);
+        ok(SUCCEEDED(hr), "Failed to begin scene, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetTexture(device, 0, (IDirect3DBaseTexture9 *)texture);
+        ok(SUCCEEDED(hr), "Failed to set texture, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ | D3DFVF_TEX1);
+        ok(SUCCEEDED(hr), "Failed to set FVF, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_DrawPrimitiveUP(device, D3DPT_TRIANGLESTRIP, 2, tex_quad, sizeof(*tex_quad));
+        ok(SUCCEEDED(hr), "Failed to draw, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_EndScene(device);
+        ok(SUCCEEDED(hr), "Failed to end scene, hr %#x.\n", hr);
+
+        color = getPixelColor(device, 320, 240);
+        ok(color_match(color, ~expected & 0x00ffffff, 1), "Iteration %u: got unexpected color 0x%08x.\n", i, color);
+
+        hr = IDirect3DDevice9_Present(device, NULL, NULL, NULL, NULL);
+        ok(SUCCEEDED(hr), "Failed to present, hr %#x.\n", hr);
+    }
+
+    IDirect3DTexture9_Release(texture);
+    IDirect3DVertexBuffer9_Release(vb);
+    refcount = IDirect3DDevice9_Release(device);
+    ok(!refcount, "Device has %u references left.\n", refcount);
+done:
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
+static void test_multithreaded_cs(void)
+{
+    static const char enabled[] = "enabled";
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    DWORD size, type;
+    char cmdline[MAX_PATH + 16], old_value[32];
+    BOOL had_value, ret;
+    char **argv;
+    HKEY key;
+
+    if (!GetProcAddress(GetModuleHandleA("ntdll.dll"), "wine_get_version"))
+    {
+        skip("The multithreaded command stream is specific to Wine.\n");
+        return;
+    }
+
+    if (RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\Direct3D", 0, NULL, 0,
+            KEY_QUERY_VALUE | KEY_SET_VALUE, NULL, &key, NULL))
+    {
+        skip("Failed to open the Direct3D settings key.\n");
+        return;
+    }
+    size = sizeof(old_value);
+    had_value = !RegQueryValueExA(key, "CSMT", NULL, &type, (BYTE *)old_value, &size);
+    RegSetValueExA(key, "CSMT", 0, REG_SZ, (const BYTE *)enabled, sizeof(enabled));
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" visual csmt", argv[0]);
+    si.cb = sizeof(si);
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "Failed to create process, error %u.\n", GetLastError());
+    if (ret)
+    {
+        winetest_wait_child_process(pi.hProcess);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+    }
+
+    if (had_value)
+        RegSetValueExA(key, "CSMT", 0, type, (const BYTE *)old_value, size);
+    else
+        RegDeleteValueA(key, "CSMT");
+    RegCloseKey(key);
+}
+
 START_TEST(visual)
 {
     D3DADAPTER_IDENTIFIER9 identifier;
     IDirect3D9 *d3d;
+    char **argv;
     HRESULT hr;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "csmt"))
+    {
+        test_multithreaded_cs_child();
+        return;
+    }
 
     if (!(d3d = Direct3DCreate9(D3D_SDK_VERSION)))
     {
@@ -21543,4 +21716,5 @@ START_TEST(visual)
     test_uninitialized_varyings();
     test_multisample_init();
     test_texture_blending();
+    test_multithreaded_cs();
 }
@@ -215,6 +215,7 @@ static unsigned push_instr(compiler_ctx_t *ctx, jsop_t op)
     }
 
     ctx->code->instrs[ctx->code_off].op = op;
+    ctx->code->instrs[ctx->code_off].cache = DISPID_UNKNOWN;
     return ctx->code_off++;
 }
 
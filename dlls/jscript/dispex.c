@@ -19,6 +19,7 @@
 #include <assert.h>
 
 #include "jscript.h"
+#include "engine.h"
 
 #include "wine/unicode.h"
 #include "wine/debug.h"
@@ -897,6 +898,8 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
 {
     TRACE("%p (%p)\n", dispex, prototype);
 
+    gc_check(ctx);
+
     dispex->IDispatchEx_iface.lpVtbl = &DispatchExVtbl;
     dispex->ref = 1;
     dispex->builtin_info = builtin_info;
@@ -920,6 +923,8 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
     script_addref(ctx);
     dispex->ctx = ctx;
 
+    list_add_tail(&ctx->objects, &dispex->entry);
+    ctx->object_cnt++;
     return S_OK;
 }
 
@@ -962,6 +967,8 @@ void jsdisp_free(jsdisp_t *obj)
         heap_free(prop->name);
     }
     heap_free(obj->props);
+    list_remove(&obj->entry);
+    obj->ctx->object_cnt--;
     script_release(obj->ctx);
     if(obj->prototype)
         jsdisp_release(obj->prototype);
@@ -1056,6 +1063,29 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/*
+ * Same as jsdisp_get_id, but first tries the id stored in *cache by a previous call.
+ * Property names are unique within an object and ids are never reused for another
+ * name, so the cached id is valid for any object that has a live property of that
+ * name at this index.
+ */
+HRESULT jsdisp_get_cached_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *cache, DISPID *id)
+{
+    dispex_prop_t *prop;
+    HRESULT hres;
+
+    prop = get_prop(jsdisp, *cache);
+    if(prop && !strcmpW(prop->name, name)) {
+        *id = *cache;
+        return S_OK;
+    }
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(SUCCEEDED(hres))
+        *cache = *id;
+    return hres;
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
@@ -1609,3 +1639,220 @@ HRESULT jsdisp_is_enumerable(jsdisp_t *obj, const WCHAR *name, BOOL *ret)
     *ret = prop && (prop->flags & PROPF_ENUM) && prop->type != PROP_PROTREF;
     return S_OK;
 }
+
+/* cycles are not looked for until the context has that many objects */
+#define GC_MIN_OBJECTS 256
+
+#define GC_LIVE (-1)
+
+typedef struct {
+    void **ptrs;
+    unsigned cnt;
+    unsigned size;
+} gc_array_t;
+
+static BOOL gc_array_push(gc_array_t *array, void *ptr)
+{
+    if(array->cnt == array->size) {
+        unsigned new_size = array->size ? array->size*2 : 64;
+        void **new_ptrs;
+
+        if(array->ptrs)
+            new_ptrs = heap_realloc(array->ptrs, new_size*sizeof(*new_ptrs));
+        else
+            new_ptrs = heap_alloc(new_size*sizeof(*new_ptrs));
+        if(!new_ptrs)
+            return FALSE;
+
+        array->ptrs = new_ptrs;
+        array->size = new_size;
+    }
+
+    array->ptrs[array->cnt++] = ptr;
+    return TRUE;
+}
+
+static jsdisp_t *gc_get_jsdisp(script_ctx_t *ctx, IDispatch *disp)
+{
+    jsdisp_t *jsdisp;
+
+    jsdisp = disp ? to_jsdisp(disp) : NULL;
+    return jsdisp && jsdisp->ctx == ctx ? jsdisp : NULL;
+}
+
+static BOOL gc_unref(jsdisp_t *obj, gc_array_t *stack)
+{
+    obj->gc_ref--;
+    return TRUE;
+}
+
+static BOOL gc_mark(jsdisp_t *obj, gc_array_t *stack)
+{
+    if(obj->gc_ref == GC_LIVE)
+        return TRUE;
+
+    obj->gc_ref = GC_LIVE;
+    return gc_array_push(stack, obj);
+}
+
+/* Calls visit for every object of the same context referenced by the properties
+ * or the prototype of obj. References kept in class specific data are not
+ * reported (except for function scopes, handled separately), which only makes
+ * the referenced objects look externally referenced. */
+static BOOL gc_traverse(script_ctx_t *ctx, jsdisp_t *obj, BOOL (*visit)(jsdisp_t*,gc_array_t*), gc_array_t *stack)
+{
+    dispex_prop_t *prop;
+    jsdisp_t *child;
+
+    for(prop = obj->props; prop < obj->props+obj->prop_cnt; prop++) {
+        if(prop->type == PROP_JSVAL && is_object_instance(prop->u.val)
+           && (child = gc_get_jsdisp(ctx, get_object(prop->u.val))) && !visit(child, stack))
+            return FALSE;
+    }
+
+    if(obj->prototype && (child = gc_get_jsdisp(ctx, to_disp(obj->prototype))) && !visit(child, stack))
+        return FALSE;
+
+    return TRUE;
+}
+
+static BOOL gc_mark_scope(script_ctx_t *ctx, scope_chain_t *scope, gc_array_t *stack)
+{
+    jsdisp_t *child;
+
+    for(; scope && scope->gc_ref != GC_LIVE; scope = scope->next) {
+        scope->gc_ref = GC_LIVE;
+        if((child = gc_get_jsdisp(ctx, scope->obj)) && !gc_mark(child, stack))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static BOOL gc_mark_stack(script_ctx_t *ctx, gc_array_t *stack)
+{
+    jsdisp_t *obj;
+
+    while(stack->cnt) {
+        obj = stack->ptrs[--stack->cnt];
+        if(!gc_traverse(ctx, obj, gc_mark, stack) || !gc_mark_scope(ctx, get_function_scope(obj), stack))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void gc_unlink(jsdisp_t *obj)
+{
+    dispex_prop_t *prop;
+    jsdisp_t *prototype;
+    jsval_t val;
+
+    for(prop = obj->props; prop < obj->props+obj->prop_cnt; prop++) {
+        if(prop->type == PROP_JSVAL) {
+            val = prop->u.val;
+            prop->u.val = jsval_undefined();
+            jsval_release(val);
+        }
+    }
+
+    if((prototype = obj->prototype)) {
+        obj->prototype = NULL;
+        jsdisp_release(prototype);
+    }
+
+    release_function_scope(obj);
+}
+
+/*
+ * Frees objects kept alive only by reference cycles (for example a closure stored in a
+ * property of its own scope). References from properties, prototypes and function scopes
+ * are subtracted from the reference counts; whatever is left is held from outside and
+ * everything reachable from there is alive. The remaining objects are unlinked and freed.
+ * It may run while a script is executing, the interpreter stack and the execution contexts
+ * hold counted references to everything they use.
+ */
+void gc_run(script_ctx_t *ctx)
+{
+    gc_array_t scopes = {NULL}, stack = {NULL}, garbage = {NULL};
+    DWORD gen = ++ctx->gc_gen;
+    scope_chain_t *scope;
+    jsdisp_t *obj, *child;
+    unsigned i;
+
+    TRACE("(%p) %u objects\n", ctx, ctx->object_cnt);
+
+    /* releasing the garbage must not start another run */
+    ctx->gc_threshold = ~0u;
+
+    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+        obj->gc_ref = obj->ref;
+
+        /* scope chains share their tails, stop at the first node already seen */
+        for(scope = get_function_scope(obj); scope && scope->gc_gen != gen; scope = scope->next) {
+            scope->gc_gen = gen;
+            scope->gc_ref = scope->ref;
+            if(!gc_array_push(&scopes, scope))
+                goto done;
+        }
+    }
+
+    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+        gc_traverse(ctx, obj, gc_unref, NULL);
+        if((scope = get_function_scope(obj)))
+            scope->gc_ref--;
+    }
+
+    for(i = 0; i < scopes.cnt; i++) {
+        scope = scopes.ptrs[i];
+        if(scope->next)
+            scope->next->gc_ref--;
+        if((child = gc_get_jsdisp(ctx, scope->obj)))
+            child->gc_ref--;
+    }
+
+    /* ctx->global and the ctx->*_constr pointers own a reference, which is left
+     * in gc_ref like any other reference held from outside the object graph */
+    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+        if(obj->gc_ref <= 0)
+            continue;
+        obj->gc_ref = GC_LIVE;
+        if(!gc_array_push(&stack, obj) || !gc_mark_stack(ctx, &stack))
+            goto done;
+    }
+
+    for(i = 0; i < scopes.cnt; i++) {
+        scope = scopes.ptrs[i];
+        if(scope->gc_ref > 0 && (!gc_mark_scope(ctx, scope, &stack) || !gc_mark_stack(ctx, &stack)))
+            goto done;
+    }
+
+    LIST_FOR_EACH_ENTRY(obj, &ctx->objects, jsdisp_t, entry) {
+        if(obj->gc_ref != GC_LIVE && !gc_array_push(&garbage, obj))
+            goto done;
+    }
+
+    TRACE("freeing %u objects\n", garbage.cnt);
+
+    /* keep the garbage alive until all of it is unlinked */
+    for(i = 0; i < garbage.cnt; i++)
+        jsdisp_addref(garbage.ptrs[i]);
+    for(i = 0; i < garbage.cnt; i++)
+        gc_unlink(garbage.ptrs[i]);
+    for(i = 0; i < garbage.cnt; i++)
+        jsdisp_release(garbage.ptrs[i]);
+
+done:
+    heap_free(scopes.ptrs);
+    heap_free(stack.ptrs);
+    heap_free(garbage.ptrs);
+    ctx->gc_threshold = max(ctx->object_cnt*2, GC_MIN_OBJECTS);
+}
+
+/* runs the collector once the number of objects doubled since the last run,
+ * called for every new object */
+void gc_check(script_ctx_t *ctx)
+{
+    if(ctx->object_cnt >= max(ctx->gc_threshold, GC_MIN_OBJECTS))
+        gc_run(ctx);
+}
@@ -251,6 +251,7 @@ HRESULT scope_push(scope_chain_t *scope, jsdisp_t *jsobj, IDispatch *obj, scope_
         return E_OUTOFMEMORY;
 
     new_scope->ref = 1;
+    new_scope->gc_gen = 0;
 
     IDispatch_AddRef(obj);
     new_scope->jsobj = jsobj;
@@ -361,7 +362,8 @@ void exec_release(exec_ctx_t *ctx)
     heap_free(ctx);
 }
 
-static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
+static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags,
+        DISPID *cache, DISPID *id)
 {
     IDispatchEx *dispex;
     jsdisp_t *jsdisp;
@@ -370,7 +372,10 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
 
     jsdisp = iface_to_jsdisp((IUnknown*)disp);
     if(jsdisp) {
-        hres = jsdisp_get_id(jsdisp, name, flags, id);
+        if(cache)
+            hres = jsdisp_get_cached_id(jsdisp, name, flags, cache, id);
+        else
+            hres = jsdisp_get_id(jsdisp, name, flags, id);
         jsdisp_release(jsdisp);
         return hres;
     }
@@ -489,7 +494,7 @@ static BOOL lookup_global_members(script_ctx_t *ctx, BSTR identifier, exprval_t
 
     for(item = ctx->named_items; item; item = item->next) {
         if(item->flags & SCRIPTITEM_GLOBALMEMBERS) {
-            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, &id);
+            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, NULL, &id);
             if(SUCCEEDED(hres)) {
                 if(ret)
                     exprval_set_idref(ret, item->disp, id);
@@ -502,7 +507,8 @@ static BOOL lookup_global_members(script_ctx_t *ctx, BSTR identifier, exprval_t
 }
 
 /* ECMA-262 3rd Edition    10.1.4 */
-static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *ret)
+/* cache is the per instruction id cache or NULL */
+static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, DISPID *cache, exprval_t *ret)
 {
     scope_chain_t *scope;
     named_item_t *item;
@@ -513,10 +519,12 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
 
     if(ctx->exec_ctx) {
         for(scope = ctx->exec_ctx->scope_chain; scope; scope = scope->next) {
-            if(scope->jsobj)
+            if(scope->jsobj && cache)
+                hres = jsdisp_get_cached_id(scope->jsobj, identifier, fdexNameImplicit, cache, &id);
+            else if(scope->jsobj)
                 hres = jsdisp_get_id(scope->jsobj, identifier, fdexNameImplicit, &id);
             else
-                hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, &id);
+                hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, NULL, &id);
             if(SUCCEEDED(hres)) {
                 exprval_set_idref(ret, scope->obj, id);
                 return S_OK;
@@ -524,7 +532,10 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
         }
     }
 
-    hres = jsdisp_get_id(ctx->global, identifier, 0, &id);
+    if(cache)
+        hres = jsdisp_get_cached_id(ctx->global, identifier, 0, cache, &id);
+    else
+        hres = jsdisp_get_id(ctx->global, identifier, 0, &id);
     if(SUCCEEDED(hres)) {
         exprval_set_idref(ret, to_disp(ctx->global), id);
         return S_OK;
@@ -587,6 +598,10 @@ static inline double get_op_double(exec_ctx_t *ctx){
     return ctx->code->instrs[ctx->ip].u.dbl;
 }
 
+static inline DISPID *get_op_cache(exec_ctx_t *ctx){
+    return &ctx->code->instrs[ctx->ip].cache;
+}
+
 /* ECMA-262 3rd Edition    12.2 */
 static HRESULT interp_var_set(exec_ctx_t *ctx)
 {
@@ -865,7 +880,7 @@ static HRESULT interp_array(exec_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx->script, obj, name, NULL, 0, &id);
+    hres = disp_get_id(ctx->script, obj, name, NULL, 0, NULL, &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx->script, obj, id, &v);
@@ -895,7 +910,7 @@ static HRESULT interp_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, arg, arg, 0, &id);
+    hres = disp_get_id(ctx->script, obj, arg, arg, 0, get_op_cache(ctx), &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx->script, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -936,7 +951,7 @@ static HRESULT interp_memberid(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, name, NULL, arg, &id);
+    hres = disp_get_id(ctx->script, obj, name, NULL, arg, NULL, &id);
     jsstr_release(name_str);
     if(FAILED(hres)) {
         IDispatch_Release(obj);
@@ -1068,7 +1083,7 @@ static HRESULT interp_ident(exec_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1093,7 +1108,7 @@ static HRESULT interp_identid(exec_ctx_t *ctx)
 
     TRACE("%s %x\n", debugstr_w(arg), flags);
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1430,7 +1445,7 @@ static HRESULT interp_in(exec_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx->script, get_object(obj), str, NULL, 0, &id);
+    hres = disp_get_id(ctx->script, get_object(obj), str, NULL, 0, NULL, &id);
     IDispatch_Release(get_object(obj));
     jsstr_release(jsstr);
     if(SUCCEEDED(hres))
@@ -1638,7 +1653,7 @@ static HRESULT interp_delete_ident(exec_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1748,7 +1763,7 @@ static HRESULT interp_typeofident(exec_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -2514,7 +2529,7 @@ static HRESULT bind_event_target(script_ctx_t *ctx, function_code_t *func, jsdis
     jsval_t v;
     HRESULT hres;
 
-    hres = identifier_eval(ctx, func->event_target, &exprval);
+    hres = identifier_eval(ctx, func->event_target, NULL, &exprval);
     if(FAILED(hres))
         return hres;
 
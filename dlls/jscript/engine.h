@@ -119,6 +119,7 @@ typedef enum {
 
 typedef struct {
     jsop_t op;
+    DISPID cache;  /* id found by the last property lookup, see jsdisp_get_cached_id */
     union {
         instr_arg_t arg[2];
         double dbl;
@@ -174,6 +175,8 @@ static inline void bytecode_addref(bytecode_t *code)
 
 typedef struct _scope_chain_t {
     LONG ref;
+    LONG gc_ref;
+    DWORD gc_gen;
     jsdisp_t *jsobj;
     IDispatch *obj;
     struct _scope_chain_t *next;
@@ -220,3 +223,5 @@ void exec_release(exec_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT create_exec_ctx(script_ctx_t*,IDispatch*,jsdisp_t*,scope_chain_t*,BOOL,exec_ctx_t**) DECLSPEC_HIDDEN;
 HRESULT exec_source(exec_ctx_t*,bytecode_t*,function_code_t*,BOOL,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT create_source_function(script_ctx_t*,bytecode_t*,function_code_t*,scope_chain_t*,jsdisp_t**) DECLSPEC_HIDDEN;
+scope_chain_t *get_function_scope(jsdisp_t*) DECLSPEC_HIDDEN;
+void release_function_scope(jsdisp_t*) DECLSPEC_HIDDEN;
@@ -585,6 +585,25 @@ static const builtin_prop_t Function_props[] = {
     {toStringW,              Function_toString,              PROPF_METHOD}
 };
 
+scope_chain_t *get_function_scope(jsdisp_t *jsdisp)
+{
+    return is_class(jsdisp, JSCLASS_FUNCTION) ? function_from_jsdisp(jsdisp)->scope_chain : NULL;
+}
+
+void release_function_scope(jsdisp_t *jsdisp)
+{
+    FunctionInstance *function;
+
+    if(!is_class(jsdisp, JSCLASS_FUNCTION))
+        return;
+
+    function = function_from_jsdisp(jsdisp);
+    if(function->scope_chain) {
+        scope_release(function->scope_chain);
+        function->scope_chain = NULL;
+    }
+}
+
 static const builtin_info_t Function_info = {
     JSCLASS_FUNCTION,
     DEFAULT_FUNCTION_VALUE,
@@ -74,6 +74,7 @@ void script_release(script_ctx_t *ctx)
     heap_pool_free(&ctx->tmp_heap);
     if(ctx->last_match)
         jsstr_release(ctx->last_match);
+    release_regexp_cache(ctx);
 
     ctx->jscaller->ctx = NULL;
     IServiceProvider_Release(&ctx->jscaller->IServiceProvider_iface);
@@ -216,6 +217,7 @@ static void decrease_state(JScript *This, SCRIPTSTATE state)
             if(This->ctx->global) {
                 jsdisp_release(This->ctx->global);
                 This->ctx->global = NULL;
+                gc_run(This->ctx);
             }
             /* FALLTHROUGH */
         case SCRIPTSTATE_UNINITIALIZED:
@@ -718,6 +720,7 @@ static HRESULT WINAPI JScriptParse_InitNew(IActiveScriptParse *iface)
     ctx->version = This->version;
     ctx->ei.val = jsval_undefined();
     heap_pool_init(&ctx->tmp_heap);
+    list_init(&ctx->objects);
 
     hres = create_jscaller(ctx);
     if(FAILED(hres)) {
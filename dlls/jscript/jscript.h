@@ -217,6 +217,8 @@ struct jsdisp_t {
     IDispatchEx IDispatchEx_iface;
 
     LONG ref;
+    LONG gc_ref;  /* references not held by other objects of the context, see gc_run */
+    struct list entry;  /* entry in the script context object list */
 
     DWORD buf_size;
     DWORD prop_cnt;
@@ -284,6 +286,9 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_cached_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*,DISPID*) DECLSPEC_HIDDEN;
+void gc_run(script_ctx_t*) DECLSPEC_HIDDEN;
+void gc_check(script_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -379,6 +384,8 @@ typedef struct {
     unsigned length;
 } match_result_t;
 
+#define REGEXP_CACHE_SIZE 16
+
 struct _script_ctx_t {
     LONG ref;
 
@@ -398,6 +405,11 @@ struct _script_ctx_t {
 
     heap_pool_t tmp_heap;
 
+    struct list objects;
+    unsigned object_cnt;
+    unsigned gc_threshold;
+    DWORD gc_gen;
+
     IDispatch *host_global;
 
     jsstr_t *last_match;
@@ -405,6 +417,8 @@ struct _script_ctx_t {
     DWORD last_match_index;
     DWORD last_match_length;
 
+    struct regexp_t *regexp_cache[REGEXP_CACHE_SIZE];
+
     jsdisp_t *global;
     jsdisp_t *function_constr;
     jsdisp_t *array_constr;
@@ -458,6 +472,7 @@ HRESULT create_jscaller(script_ctx_t*) DECLSPEC_HIDDEN;
 #define REM_NO_PARENS      0x0010
 struct match_state_t;
 HRESULT regexp_match_next(script_ctx_t*,jsdisp_t*,DWORD,jsstr_t*,struct match_state_t**) DECLSPEC_HIDDEN;
+void release_regexp_cache(script_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT parse_regexp_flags(const WCHAR*,DWORD,DWORD*) DECLSPEC_HIDDEN;
 HRESULT regexp_string_match(script_ctx_t*,jsdisp_t*,jsstr_t*,jsval_t*) DECLSPEC_HIDDEN;
 
@@ -592,7 +592,7 @@ static void RegExp_destructor(jsdisp_t *dispex)
     RegExpInstance *This = (RegExpInstance*)dispex;
 
     if(This->jsregexp)
-        regexp_destroy(This->jsregexp);
+        regexp_release(This->jsregexp);
     jsval_release(This->last_index_val);
     jsstr_release(This->str);
     heap_free(This);
@@ -658,6 +658,42 @@ static HRESULT alloc_regexp(script_ctx_t *ctx, jsdisp_t *object_prototype, RegEx
     return S_OK;
 }
 
+/* Compiled regexps are shared by RegExp objects with the same source and flags. */
+static regexp_t *compile_regexp(script_ctx_t *ctx, const WCHAR *str, DWORD len, DWORD flags)
+{
+    regexp_t **cache = ctx->regexp_cache, *re;
+    unsigned i;
+
+    for(i = 0; i < REGEXP_CACHE_SIZE && cache[i]; i++) {
+        re = cache[i];
+        if(re->flags == flags && re->source_len == len && !memcmp(re->source, str, len*sizeof(WCHAR))) {
+            memmove(cache+1, cache, i*sizeof(*cache));
+            cache[0] = re;
+            return regexp_addref(re);
+        }
+    }
+
+    re = regexp_new(ctx, &ctx->tmp_heap, str, len, flags, FALSE);
+    if(!re)
+        return NULL;
+
+    if(cache[REGEXP_CACHE_SIZE-1])
+        regexp_release(cache[REGEXP_CACHE_SIZE-1]);
+    memmove(cache+1, cache, (REGEXP_CACHE_SIZE-1)*sizeof(*cache));
+    cache[0] = regexp_addref(re);
+    return re;
+}
+
+void release_regexp_cache(script_ctx_t *ctx)
+{
+    unsigned i;
+
+    for(i = 0; i < REGEXP_CACHE_SIZE && ctx->regexp_cache[i]; i++) {
+        regexp_release(ctx->regexp_cache[i]);
+        ctx->regexp_cache[i] = NULL;
+    }
+}
+
 HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **ret)
 {
     RegExpInstance *regexp;
@@ -677,7 +713,7 @@ HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **r
     regexp->str = jsstr_addref(src);
     regexp->last_index_val = jsval_number(0);
 
-    regexp->jsregexp = regexp_new(ctx, &ctx->tmp_heap, str, jsstr_length(regexp->str), flags, FALSE);
+    regexp->jsregexp = compile_regexp(ctx, str, jsstr_length(regexp->str), flags);
     if(!regexp->jsregexp) {
         WARN("regexp_new failed\n");
         jsdisp_release(&regexp->dispex);
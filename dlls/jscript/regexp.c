@@ -2532,6 +2532,32 @@ SimpleMatch(REGlobalData *gData, match_state_t *x, REOp op,
     return NULL;
 }
 
+/*
+ * If the program starts with a case sensitive literal, return its first
+ * character so that candidate match positions can be located with memchrW
+ * instead of running SimpleMatch at every position of the input.
+ */
+static BOOL
+GetFirstChar(regexp_t *re, REOp op, jsbytecode *pc, WCHAR *ret)
+{
+    size_t offset;
+
+    switch (op) {
+      case REOP_FLAT:
+        ReadCompactIndex(pc, &offset);
+        *ret = re->source[offset];
+        return TRUE;
+      case REOP_FLAT1:
+        *ret = *pc;
+        return TRUE;
+      case REOP_UCFLAT1:
+        *ret = GET_ARG(pc);
+        return TRUE;
+      default:
+        return FALSE;
+    }
+}
+
 static inline match_state_t *
 ExecuteREBytecode(REGlobalData *gData, match_state_t *x)
 {
@@ -2548,7 +2574,8 @@ ExecuteREBytecode(REGlobalData *gData, match_state_t *x)
     WCHAR matchCh1, matchCh2;
     RECharSet *charSet;
 
-    BOOL anchor;
+    BOOL anchor, prefilter;
+    WCHAR firstCh;
     jsbytecode *pc = gData->regexp->program;
     REOp op = (REOp) *pc++;
 
@@ -2558,7 +2585,15 @@ ExecuteREBytecode(REGlobalData *gData, match_state_t *x)
      */
     if (REOP_IS_SIMPLE(op) && !(gData->regexp->flags & REG_STICKY)) {
         anchor = FALSE;
+        prefilter = GetFirstChar(gData->regexp, op, pc, &firstCh);
         while (x->cp <= gData->cpend) {
+            if (prefilter) {
+                const WCHAR *next = memchrW(x->cp, firstCh, gData->cpend - x->cp);
+                if (!next)
+                    break;
+                gData->skipped += next - x->cp;
+                x->cp = next;
+            }
             nextpc = pc;    /* reset back to start each time */
             result = SimpleMatch(gData, x, op, &nextpc, TRUE);
             if (result) {
@@ -3178,8 +3213,11 @@ HRESULT regexp_execute(regexp_t *regexp, void *cx, heap_pool_t *pool,
     return S_OK;
 }
 
-void regexp_destroy(regexp_t *re)
+void regexp_release(regexp_t *re)
 {
+    if (--re->ref)
+        return;
+
     if (re->classList) {
         UINT i;
         for (i = 0; i < re->classCount; i++) {
@@ -3189,6 +3227,7 @@ void regexp_destroy(regexp_t *re)
         }
         heap_free(re->classList);
     }
+    heap_free(re->source);
     heap_free(re);
 }
 
@@ -3242,12 +3281,14 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
     if (!re)
         goto out;
 
+    re->ref = 1;
+    re->source = NULL;
     assert(state.classBitmapsMem <= CLASS_BITMAPS_MEM_LIMIT);
     re->classCount = state.classCount;
     if (re->classCount) {
         re->classList = heap_alloc(re->classCount * sizeof(RECharSet));
         if (!re->classList) {
-            regexp_destroy(re);
+            regexp_release(re);
             re = NULL;
             goto out;
         }
@@ -3258,7 +3299,7 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
     }
     endPC = EmitREBytecode(&state, re, state.treeDepth, re->program, state.result);
     if (!endPC) {
-        regexp_destroy(re);
+        regexp_release(re);
         re = NULL;
         goto out;
     }
@@ -3277,9 +3318,20 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
             re = tmp;
     }
 
+    /*
+     * Keep a private copy of the source, so that the compiled regexp may
+     * be shared by RegExp objects created from different strings.
+     */
+    re->source = heap_alloc((str_len ? str_len : 1) * sizeof(WCHAR));
+    if (!re->source) {
+        regexp_release(re);
+        re = NULL;
+        goto out;
+    }
+    memcpy(re->source, str, str_len * sizeof(WCHAR));
+
     re->flags = flags;
     re->parenCount = state.parenCount;
-    re->source = str;
     re->source_len = str_len;
 
 out:
@@ -1453,6 +1453,30 @@ ok(returnTest() === undefined, "returnTest = " + returnTest());
 ActiveXObject = 1;
 ok(ActiveXObject === 1, "ActiveXObject = " + ActiveXObject);
 
+function testPropertyCache() {
+    var objs = [{a: 1, b: 2}, {b: 3, a: 4}, {c: 5}, {a: 6}], i, r = "";
+
+    /* the same member expression is evaluated on objects with different layouts */
+    for(i = 0; i < objs.length; i++)
+        r += objs[i].a + ",";
+    ok(r === "1,4,undefined,6,", "r = " + r);
+
+    function getA(o) { return o.a; }
+    ok(getA(objs[0]) === 1, "getA(objs[0]) = " + getA(objs[0]));
+    delete objs[0].a;
+    ok(getA(objs[0]) === undefined, "getA(objs[0]) = " + getA(objs[0]));
+    objs[0].a = 7;
+    ok(getA(objs[0]) === 7, "getA(objs[0]) = " + getA(objs[0]));
+
+    r = "";
+    for(i = 0; i < 2; i++) {
+        var x = i ? "local" : x;
+        r += x + ",";
+    }
+    ok(r === "undefined,local,", "r = " + r);
+}
+testPropertyCache();
+
 Boolean = 1;
 ok(Boolean === 1, "Boolean = " + Boolean);
 
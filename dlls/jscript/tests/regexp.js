@@ -660,4 +660,27 @@ tmp = new RegExp("abc/", "mgi");
 ok(tmp.toString() === "/abc//igm", "(new RegExp(\"abc/\")).toString() = " + tmp.toString());
 ok(/abc/.toString(1, false, "3") === "/abc/", "/abc/.toString(1, false, \"3\") = " + /abc/.toString());
 
+var re1 = new RegExp("ab+c", "g"), re2 = new RegExp("ab+c", "g");
+ok(re1 !== re2, "re1 === re2");
+re1.exec("xabbc abc");
+ok(re1.lastIndex === 5, "re1.lastIndex = " + re1.lastIndex);
+ok(re2.lastIndex === 0, "re2.lastIndex = " + re2.lastIndex);
+m = re2.exec("xxabcabbc");
+ok(m.index === 2, "m.index = " + m.index);
+ok(re2.lastIndex === 5, "re2.lastIndex = " + re2.lastIndex);
+m = new RegExp("ab+c", "gi").exec("ABBC");
+ok(m[0] === "ABBC", "m[0] = " + m[0]);
+ok(new RegExp("ab+c").exec("ABBC") === null, "exec(\"ABBC\") != null");
+
+for(i = 0; i < 20; i++)
+    tmp = new RegExp("a" + i + "b").exec("xa" + i + "b");
+ok(tmp.index === 1, "tmp.index = " + tmp.index);
+tmp = new RegExp("ab+c").exec("xabbc");
+ok(tmp[0] === "abbc", "tmp[0] = " + tmp[0]);
+
+ok("a.b.c".replace(/\./g, "-") === "a-b-c", "replace returned " + "a.b.c".replace(/\./g, "-"));
+ok("xxyxxy".search(/xy/) === 1, "search returned " + "xxyxxy".search(/xy/));
+ok("xxx".search(/xy/) === -1, "search returned " + "xxx".search(/xy/));
+ok("\u0100x\u0100y".search(/\u0100y/) === 2, "search returned " + "\u0100x\u0100y".search(/\u0100y/));
+
 reportSuccess();
@@ -144,6 +144,8 @@ DEFINE_EXPECT(BindHandler);
 #define DISPID_GLOBAL_TESTPROPPUTREF 0x101b
 #define DISPID_GLOBAL_GETSCRIPTSTATE 0x101c
 #define DISPID_GLOBAL_BINDEVENTHANDLER 0x101d
+#define DISPID_GLOBAL_REFOBJ        0x101e
+#define DISPID_GLOBAL_REFOBJREF     0x101f
 
 #define DISPID_GLOBAL_TESTPROPDELETE      0x2000
 #define DISPID_GLOBAL_TESTNOPROPDELETE    0x2001
@@ -664,6 +666,52 @@ static IDispatchExVtbl bindEventHandlerDispVtbl = {
 
 static IDispatchEx bindEventHandlerDisp = { &bindEventHandlerDispVtbl };
 
+static LONG refobj_ref;
+
+static HRESULT WINAPI refObj_QueryInterface(IDispatchEx *iface, REFIID riid, void **ppv)
+{
+    if(IsEqualGUID(riid, &IID_IUnknown) || IsEqualGUID(riid, &IID_IDispatch)
+       || IsEqualGUID(riid, &IID_IDispatchEx)) {
+        *ppv = iface;
+        IDispatchEx_AddRef(iface);
+        return S_OK;
+    }
+
+    *ppv = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG WINAPI refObj_AddRef(IDispatchEx *iface)
+{
+    return ++refobj_ref;
+}
+
+static ULONG WINAPI refObj_Release(IDispatchEx *iface)
+{
+    ok(refobj_ref > 0, "refobj_ref = %d\n", refobj_ref);
+    return --refobj_ref;
+}
+
+static IDispatchExVtbl refObjVtbl = {
+    refObj_QueryInterface,
+    refObj_AddRef,
+    refObj_Release,
+    DispatchEx_GetTypeInfoCount,
+    DispatchEx_GetTypeInfo,
+    DispatchEx_GetIDsOfNames,
+    DispatchEx_Invoke,
+    DispatchEx_GetDispID,
+    DispatchEx_InvokeEx,
+    DispatchEx_DeleteMemberByName,
+    DispatchEx_DeleteMemberByDispID,
+    DispatchEx_GetMemberProperties,
+    DispatchEx_GetMemberName,
+    DispatchEx_GetNextDispID,
+    DispatchEx_GetNameSpaceParent
+};
+
+static IDispatchEx refObj = { &refObjVtbl };
+
 static HRESULT WINAPI Global_GetDispID(IDispatchEx *iface, BSTR bstrName, DWORD grfdex, DISPID *pid)
 {
     if(!strcmp_wa(bstrName, "ok")) {
@@ -855,6 +903,16 @@ static HRESULT WINAPI Global_GetDispID(IDispatchEx *iface, BSTR bstrName, DWORD
         return S_OK;
     }
 
+    if(!strcmp_wa(bstrName, "refObj")) {
+        *pid = DISPID_GLOBAL_REFOBJ;
+        return S_OK;
+    }
+
+    if(!strcmp_wa(bstrName, "refObjRef")) {
+        *pid = DISPID_GLOBAL_REFOBJREF;
+        return S_OK;
+    }
+
     if(strict_dispid_check && strcmp_wa(bstrName, "t"))
         ok(0, "unexpected call %s\n", wine_dbgstr_w(bstrName));
     return DISP_E_UNKNOWNNAME;
@@ -1224,6 +1282,18 @@ static HRESULT WINAPI Global_InvokeEx(IDispatchEx *iface, DISPID id, LCID lcid,
         V_DISPATCH(pvarRes) = (IDispatch*)&bindEventHandlerDisp;
         return S_OK;
 
+    case DISPID_GLOBAL_REFOBJ:
+        ok(wFlags == INVOKE_PROPERTYGET, "wFlags = %x\n", wFlags);
+        IDispatchEx_AddRef(&refObj);
+        V_VT(pvarRes) = VT_DISPATCH;
+        V_DISPATCH(pvarRes) = (IDispatch*)&refObj;
+        return S_OK;
+
+    case DISPID_GLOBAL_REFOBJREF:
+        V_VT(pvarRes) = VT_I4;
+        V_I4(pvarRes) = refobj_ref;
+        return S_OK;
+
     case DISPID_GLOBAL_PROPARGPUT:
         CHECK_EXPECT(global_propargput_i);
         ok(wFlags == INVOKE_PROPERTYPUT, "wFlags = %x\n", wFlags);
@@ -2357,6 +2427,22 @@ struct bom_test
     HRESULT hres;
 };
 
+static void test_gc(void)
+{
+    /* a cycle holding a host object is freed when the engine is closed */
+    refobj_ref = 0;
+    parse_script_a("(function() { var o = {obj: refObj}; o.self = o; })();");
+    ok(!refobj_ref, "refobj_ref = %d\n", refobj_ref);
+
+    /* and while the script runs, once enough objects were allocated */
+    refobj_ref = 0;
+    parse_script_a("(function() { var o = {obj: refObj}, f = function() { return o; }; o.f = f; })();"
+                   "var a = [];"
+                   "for(var i = 0; i < 5000; i++) a.push({});"
+                   "ok(refObjRef() === 0, 'refObjRef() = ' + refObjRef());");
+    ok(!refobj_ref, "refobj_ref = %d\n", refobj_ref);
+}
+
 static void run_bom_tests(void)
 {
     BSTR src;
@@ -2682,6 +2768,7 @@ static BOOL run_tests(void)
 
     test_script_exprs();
     test_invokeex();
+    test_gc();
 
     parse_script_with_error_a(
         "?",
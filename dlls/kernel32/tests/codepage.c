@@ -1194,6 +1194,43 @@ static void test_dbcs_to_widechar(void)
     }
 }
 
+static void test_utf8_ascii_runs(void)
+{
+    char src[64];
+    WCHAR wbuf[64];
+    int i, pos, count;
+
+    /* a single multi-byte sequence at every position of an otherwise ASCII string */
+    for (pos = 0; pos < 40; pos++)
+    {
+        memset( src, 'a', 42 );
+        src[pos] = 0xc3;
+        src[pos + 1] = 0xa9;
+
+        count = MultiByteToWideChar( CP_UTF8, 0, src, 42, NULL, 0 );
+        ok( count == 41, "%d: returned %d (expected 41)\n", pos, count );
+
+        memset( wbuf, 0xcc, sizeof(wbuf) );
+        count = MultiByteToWideChar( CP_UTF8, 0, src, 42, wbuf, 41 );
+        ok( count == 41, "%d: returned %d (expected 41)\n", pos, count );
+        for (i = 0; i < 41; i++)
+        {
+            WCHAR expect = (i == pos) ? 0xe9 : 'a';
+            if (wbuf[i] != expect) break;
+        }
+        ok( i == 41, "%d: wrong char %04x at %d\n", pos, wbuf[i], i );
+        ok( wbuf[41] == 0xcccc, "%d: buffer overrun %04x\n", pos, wbuf[41] );
+
+        /* destination one char too short */
+        SetLastError( 0xdeadbeef );
+        memset( wbuf, 0xcc, sizeof(wbuf) );
+        count = MultiByteToWideChar( CP_UTF8, 0, src, 42, wbuf, 40 );
+        ok( !count, "%d: returned %d (expected 0)\n", pos, count );
+        ok( GetLastError() == ERROR_INSUFFICIENT_BUFFER, "%d: wrong error %u\n", pos, GetLastError() );
+        ok( wbuf[40] == 0xcccc, "%d: buffer overrun %04x\n", pos, wbuf[40] );
+    }
+}
+
 START_TEST(codepage)
 {
     BOOL bUsedDefaultChar;
@@ -1216,4 +1253,5 @@ START_TEST(codepage)
     test_threadcp();
 
     test_dbcs_to_widechar();
+    test_utf8_ascii_runs();
 }
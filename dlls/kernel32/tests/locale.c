@@ -1651,6 +1651,10 @@ static const struct comparestringa_entry comparestringa_data[] = {
   { LOCALE_SYSTEM_DEFAULT, 0, "a", 2, "a\0x", 4, CSTR_LESS_THAN },
   { LOCALE_SYSTEM_DEFAULT, 0, "a\0x", 4, "a", 1, CSTR_GREATER_THAN },
   { LOCALE_SYSTEM_DEFAULT, 0, "a\0x", 4, "a", 2, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "abcdefghijK", -1, "abcdefghijk", -1, CSTR_GREATER_THAN },
+  { LOCALE_SYSTEM_DEFAULT, 0, "abcdefghija", -1, "abcdefghijB", -1, CSTR_LESS_THAN },
+  { LOCALE_SYSTEM_DEFAULT, NORM_IGNORECASE, "abcdefghijK", -1, "abcdefghijk", -1, CSTR_EQUAL },
+  { LOCALE_SYSTEM_DEFAULT, 0, "abcdefghij", -1, "abcdefghij", -1, CSTR_EQUAL },
 };
 
 static void test_CompareStringA(void)
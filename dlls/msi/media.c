@@ -142,8 +142,35 @@ static void CDECL cabinet_free(void *pv)
     msi_free(pv);
 }
 
+/* file handle given to FDI */
+struct cab_file
+{
+    HANDLE             handle;
+    struct cab_writer *writer;   /* writer of an extracted file, NULL for a cabinet */
+    WCHAR             *path;     /* path of an extracted file */
+};
+
+static struct cab_file *alloc_cab_file( HANDLE handle, struct cab_writer *writer, WCHAR *path )
+{
+    struct cab_file *file;
+
+    if (!(file = msi_alloc( sizeof(*file) ))) return NULL;
+    file->handle = handle;
+    file->writer = writer;
+    file->path   = path;
+    return file;
+}
+
+static void free_cab_file( struct cab_file *file )
+{
+    msi_free( file->path );
+    msi_free( file );
+}
+
 static INT_PTR CDECL cabinet_open(char *pszFile, int oflag, int pmode)
 {
+    struct cab_file *file;
+    HANDLE handle;
     DWORD dwAccess = 0;
     DWORD dwShareMode = 0;
     DWORD dwCreateDisposition = OPEN_EXISTING;
@@ -169,13 +196,21 @@ static INT_PTR CDECL cabinet_open(char *pszFile, int oflag, int pmode)
     else if (oflag & _O_CREAT)
         dwCreateDisposition = CREATE_ALWAYS;
 
-    return (INT_PTR)CreateFileA(pszFile, dwAccess, dwShareMode, NULL,
-                                dwCreateDisposition, 0, NULL);
+    handle = CreateFileA(pszFile, dwAccess, dwShareMode, NULL, dwCreateDisposition, 0, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+        return -1;
+
+    if (!(file = alloc_cab_file(handle, NULL, NULL)))
+    {
+        CloseHandle(handle);
+        return -1;
+    }
+    return (INT_PTR)file;
 }
 
 static UINT CDECL cabinet_read(INT_PTR hf, void *pv, UINT cb)
 {
-    HANDLE handle = (HANDLE)hf;
+    HANDLE handle = ((struct cab_file *)hf)->handle;
     DWORD read;
 
     if (ReadFile(handle, pv, cb, &read, NULL))
@@ -184,12 +219,202 @@ static UINT CDECL cabinet_read(INT_PTR hf, void *pv, UINT cb)
     return 0;
 }
 
+/*
+ * Extracted files are written by a separate thread, so that disk writes and
+ * closing the files overlap with decompressing the next blocks. Each extraction
+ * has its own writer, reached from MSICABDATA in the notifications and from the
+ * FDI file handles in the file callbacks. FDI ignores the result of pfnwrite, so
+ * write failures are only logged; failing to set the time of an extracted file
+ * makes the next notification fail, or the extraction if there is none.
+ */
+#define WRITER_MAX_PENDING (8 * 1024 * 1024)
+
+struct cab_writer
+{
+    CRITICAL_SECTION   cs;
+    CONDITION_VARIABLE cv;
+    struct list        queue;
+    UINT               pending;
+    BOOL               done;
+    BOOL               failed;
+    HANDLE             thread;
+};
+
+struct write_request
+{
+    struct list      entry;
+    struct cab_file *file;
+    BOOL             close;      /* set the time and close the file after writing */
+    FILETIME         time;
+    UINT             size;
+    BYTE             data[1];
+};
+
+static DWORD WINAPI writer_proc( void *arg )
+{
+    struct cab_writer *writer = arg;
+    struct write_request *req;
+    DWORD written;
+    BOOL failed;
+
+    EnterCriticalSection( &writer->cs );
+    for (;;)
+    {
+        while (list_empty( &writer->queue ) && !writer->done)
+            SleepConditionVariableCS( &writer->cv, &writer->cs, INFINITE );
+        if (list_empty( &writer->queue ))
+            break;
+
+        req = LIST_ENTRY( list_head( &writer->queue ), struct write_request, entry );
+        LeaveCriticalSection( &writer->cs );
+
+        failed = FALSE;
+        if (req->size && (!WriteFile( req->file->handle, req->data, req->size, &written, NULL ) || written != req->size))
+            ERR("failed to write %u bytes, error %u\n", req->size, GetLastError());
+        if (req->close)
+        {
+            if (!SetFileTime( req->file->handle, &req->time, 0, &req->time ))
+            {
+                WARN("failed to set time of %s, error %u\n", debugstr_w(req->file->path), GetLastError());
+                failed = TRUE;
+            }
+            CloseHandle( req->file->handle );
+        }
+
+        EnterCriticalSection( &writer->cs );
+        list_remove( &req->entry );
+        writer->pending -= req->size;
+        if (failed) writer->failed = TRUE;
+        WakeAllConditionVariable( &writer->cv );
+        if (req->close) free_cab_file( req->file );
+        msi_free( req );
+    }
+    LeaveCriticalSection( &writer->cs );
+    return 0;
+}
+
+/* returns NULL if the files have to be written synchronously */
+static struct cab_writer *create_writer(void)
+{
+    struct cab_writer *writer;
+
+    if (!(writer = msi_alloc( sizeof(*writer) ))) return NULL;
+
+    InitializeCriticalSection( &writer->cs );
+    writer->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": cab_writer.cs");
+    InitializeConditionVariable( &writer->cv );
+    list_init( &writer->queue );
+    writer->pending = 0;
+    writer->done    = FALSE;
+    writer->failed  = FALSE;
+
+    if (!(writer->thread = CreateThread( NULL, 0, writer_proc, writer, 0, NULL )))
+    {
+        WARN("failed to create writer thread, error %u\n", GetLastError());
+        writer->cs.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection( &writer->cs );
+        msi_free( writer );
+        return NULL;
+    }
+    return writer;
+}
+
+/* waits until the queued requests are completed */
+static void writer_flush( struct cab_writer *writer )
+{
+    EnterCriticalSection( &writer->cs );
+    while (!list_empty( &writer->queue ))
+        SleepConditionVariableCS( &writer->cv, &writer->cs, INFINITE );
+    LeaveCriticalSection( &writer->cs );
+}
+
+/* waits for the queued requests if one of them still holds the file open */
+static void writer_flush_path( struct cab_writer *writer, const WCHAR *path )
+{
+    struct write_request *req;
+    BOOL found = FALSE;
+
+    EnterCriticalSection( &writer->cs );
+    LIST_FOR_EACH_ENTRY( req, &writer->queue, struct write_request, entry )
+    {
+        if (req->close && !strcmpiW( req->file->path, path ))
+        {
+            found = TRUE;
+            break;
+        }
+    }
+    LeaveCriticalSection( &writer->cs );
+
+    if (found) writer_flush( writer );
+}
+
+static BOOL writer_failed( struct cab_writer *writer )
+{
+    BOOL ret;
+
+    EnterCriticalSection( &writer->cs );
+    ret = writer->failed;
+    LeaveCriticalSection( &writer->cs );
+    return ret;
+}
+
+/* completes the queued requests, returns FALSE if one of them failed */
+static BOOL destroy_writer( struct cab_writer *writer )
+{
+    BOOL ret;
+
+    EnterCriticalSection( &writer->cs );
+    writer->done = TRUE;
+    WakeAllConditionVariable( &writer->cv );
+    LeaveCriticalSection( &writer->cs );
+
+    WaitForSingleObject( writer->thread, INFINITE );
+    CloseHandle( writer->thread );
+    ret = !writer->failed;
+    writer->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &writer->cs );
+    msi_free( writer );
+    return ret;
+}
+
+/* queues a request, or waits for the queue to be empty and returns FALSE
+ * if it can't, so that the caller can do it synchronously in order */
+static BOOL writer_queue( struct cab_file *file, const void *data, UINT size, const FILETIME *time )
+{
+    struct cab_writer *writer = file->writer;
+    struct write_request *req;
+
+    if (!(req = msi_alloc( FIELD_OFFSET( struct write_request, data[size] ) )))
+    {
+        writer_flush( writer );
+        return FALSE;
+    }
+
+    req->file  = file;
+    req->size  = size;
+    req->close = time != NULL;
+    if (time) req->time = *time;
+    memcpy( req->data, data, size );
+
+    EnterCriticalSection( &writer->cs );
+    while (writer->pending > WRITER_MAX_PENDING)
+        SleepConditionVariableCS( &writer->cv, &writer->cs, INFINITE );
+    list_add_tail( &writer->queue, &req->entry );
+    writer->pending += size;
+    WakeAllConditionVariable( &writer->cv );
+    LeaveCriticalSection( &writer->cs );
+    return TRUE;
+}
+
 static UINT CDECL cabinet_write(INT_PTR hf, void *pv, UINT cb)
 {
-    HANDLE handle = (HANDLE)hf;
+    struct cab_file *file = (struct cab_file *)hf;
     DWORD written;
 
-    if (WriteFile(handle, pv, cb, &written, NULL))
+    if (file->writer && writer_queue( file, pv, cb, NULL ))
+        return cb;
+
+    if (WriteFile(file->handle, pv, cb, &written, NULL))
         return written;
 
     return 0;
@@ -197,13 +422,19 @@ static UINT CDECL cabinet_write(INT_PTR hf, void *pv, UINT cb)
 
 static int CDECL cabinet_close(INT_PTR hf)
 {
-    HANDLE handle = (HANDLE)hf;
-    return CloseHandle(handle) ? 0 : -1;
+    struct cab_file *file = (struct cab_file *)hf;
+    BOOL ret;
+
+    /* this may be an extracted file that still has writes queued */
+    if (file->writer) writer_flush( file->writer );
+    ret = CloseHandle(file->handle);
+    free_cab_file( file );
+    return ret ? 0 : -1;
 }
 
 static LONG CDECL cabinet_seek(INT_PTR hf, LONG dist, int seektype)
 {
-    HANDLE handle = (HANDLE)hf;
+    HANDLE handle = ((struct cab_file *)hf)->handle;
     /* flags are compatible and so are passed straight through */
     return SetFilePointer(handle, dist, NULL, seektype);
 }
@@ -441,10 +672,14 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
                                  PFDINOTIFICATION pfdin)
 {
     MSICABDATA *data = pfdin->pv;
+    struct cab_file *file;
     HANDLE handle = 0;
     LPWSTR path = NULL;
     DWORD attrs;
 
+    if (data->writer && writer_failed( data->writer ))
+        return -1;
+
     data->curfile = strdupAtoW(pfdin->psz1);
     if (!data->cb(data->package, data->curfile, MSICABEXTRACT_BEGINEXTRACT, &path,
                   &attrs, data->user))
@@ -457,6 +692,8 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
 
     TRACE("extracting %s -> %s\n", debugstr_w(data->curfile), debugstr_w(path));
 
+    if (data->writer) writer_flush_path( data->writer, path );
+
     attrs = attrs & (FILE_ATTRIBUTE_READONLY|FILE_ATTRIBUTE_HIDDEN|FILE_ATTRIBUTE_SYSTEM);
     if (!attrs) attrs = FILE_ATTRIBUTE_NORMAL;
 
@@ -519,9 +756,18 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
     }
 
 done:
-    msi_free(path);
-
-    return (INT_PTR)handle;
+    if (!handle || handle == INVALID_HANDLE_VALUE)
+    {
+        msi_free(path);
+        return (INT_PTR)handle;
+    }
+    if (!(file = alloc_cab_file(handle, data->writer, path)))
+    {
+        CloseHandle(handle);
+        msi_free(path);
+        return -1;
+    }
+    return (INT_PTR)file;
 }
 
 static INT_PTR cabinet_close_file_info(FDINOTIFICATIONTYPE fdint,
@@ -530,7 +776,8 @@ static INT_PTR cabinet_close_file_info(FDINOTIFICATIONTYPE fdint,
     MSICABDATA *data = pfdin->pv;
     FILETIME ft;
     FILETIME ftLocal;
-    HANDLE handle = (HANDLE)pfdin->hf;
+    struct cab_file *file = (struct cab_file *)pfdin->hf;
+    struct cab_writer *writer = file->writer;
 
     data->mi->is_continuous = FALSE;
 
@@ -538,10 +785,19 @@ static INT_PTR cabinet_close_file_info(FDINOTIFICATIONTYPE fdint,
         return -1;
     if (!LocalFileTimeToFileTime(&ft, &ftLocal))
         return -1;
-    if (!SetFileTime(handle, &ftLocal, 0, &ftLocal))
-        return -1;
 
-    CloseHandle(handle);
+    /* the writer thread frees the file once the request is completed */
+    if (!writer || !writer_queue( file, NULL, 0, &ftLocal ))
+    {
+        BOOL ret = SetFileTime(file->handle, &ftLocal, 0, &ftLocal);
+
+        CloseHandle(file->handle);
+        free_cab_file( file );
+        if (!ret)
+            return -1;
+    }
+    else if (writer_failed( writer ))
+        return -1;
 
     data->cb(data->package, data->curfile, MSICABEXTRACT_FILEEXTRACTED, NULL, NULL,
              data->user);
@@ -598,7 +854,7 @@ static INT_PTR CDECL cabinet_notify_stream( FDINOTIFICATIONTYPE fdint, PFDINOTIF
     }
 }
 
-static BOOL extract_cabinet( MSIPACKAGE* package, MSIMEDIAINFO *mi, LPVOID data )
+static BOOL extract_cabinet( MSIPACKAGE* package, MSIMEDIAINFO *mi, MSICABDATA *data )
 {
     LPSTR cabinet, cab_path = NULL;
     HFDI hfdi;
@@ -623,7 +879,10 @@ static BOOL extract_cabinet( MSIPACKAGE* package, MSIMEDIAINFO *mi, LPVOID data
     if (!cab_path)
         goto done;
 
+    data->writer = create_writer();
     ret = FDICopy( hfdi, cabinet, cab_path, 0, cabinet_notify, NULL, data );
+    if (data->writer && !destroy_writer( data->writer )) ret = FALSE;
+    data->writer = NULL;
     if (!ret)
         ERR("FDICopy failed\n");
 
@@ -638,7 +897,7 @@ done:
     return ret;
 }
 
-static BOOL extract_cabinet_stream( MSIPACKAGE *package, MSIMEDIAINFO *mi, LPVOID data )
+static BOOL extract_cabinet_stream( MSIPACKAGE *package, MSIMEDIAINFO *mi, MSICABDATA *data )
 {
     static char filename[] = {'<','S','T','R','E','A','M','>',0};
     HFDI hfdi;
@@ -658,7 +917,10 @@ static BOOL extract_cabinet_stream( MSIPACKAGE *package, MSIMEDIAINFO *mi, LPVOI
     package_disk.package = package;
     package_disk.id      = mi->disk_id;
 
+    data->writer = create_writer();
     ret = FDICopy( hfdi, filename, NULL, 0, cabinet_notify_stream, NULL, data );
+    if (data->writer && !destroy_writer( data->writer )) ret = FALSE;
+    data->writer = NULL;
     if (!ret) ERR("FDICopy failed\n");
 
     FDIDestroy( hfdi );
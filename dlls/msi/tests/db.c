@@ -1741,6 +1741,19 @@ static void test_streamtable(void)
     MsiViewClose( view );
     MsiCloseHandle( view );
 
+    r = MsiDatabaseOpenViewA( hdb,
+            "SELECT `Name`, `Data` FROM `_Streams` WHERE `Name` = 'nosuch'", &view );
+    ok( r == ERROR_SUCCESS, "Failed to open database view: %d\n", r);
+
+    r = MsiViewExecute( view, 0 );
+    ok( r == ERROR_SUCCESS, "Failed to execute view: %d\n", r);
+
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+
+    MsiViewClose( view );
+    MsiCloseHandle( view );
+
     /* perform an update */
     create_file( "test2.txt" );
     rec = MsiCreateRecord( 1 );
@@ -4041,6 +4054,44 @@ static void test_join(void)
     MsiViewClose(hview);
     MsiCloseHandle(hview);
 
+    /* join restricted by a parameter, run again after inserting a row */
+    for (i = 0; i < 2; i++)
+    {
+        query = "SELECT `Component`.`Component`, `FeatureComponents`.`Feature_` "
+                "FROM `Component`, `FeatureComponents` "
+                "WHERE `FeatureComponents`.`Component_` = `Component`.`Component` "
+                "AND `FeatureComponents`.`Feature_` = ?";
+        r = MsiDatabaseOpenViewA(hdb, query, &hview);
+        ok( r == ERROR_SUCCESS, "failed to open view: %d\n", r );
+
+        hrec = MsiCreateRecord(1);
+        MsiRecordSetStringA(hrec, 1, "nasalis");
+        r = MsiViewExecute(hview, hrec);
+        ok( r == ERROR_SUCCESS, "failed to execute view: %d\n", r );
+        MsiCloseHandle(hrec);
+
+        count = 0;
+        while (MsiViewFetch(hview, &hrec) == ERROR_SUCCESS)
+        {
+            size = MAX_PATH;
+            r = MsiRecordGetStringA( hrec, 2, buf, &size );
+            ok( r == ERROR_SUCCESS, "failed to get record string: %d\n", r );
+            ok( !lstrcmpA( buf, "nasalis" ), "expected 'nasalis', got %s\n", buf );
+            MsiCloseHandle(hrec);
+            count++;
+        }
+        ok( count == 2 + i, "expected %u rows, got %u\n", 2 + i, count );
+
+        MsiViewClose(hview);
+        MsiCloseHandle(hview);
+
+        if (!i)
+        {
+            r = add_feature_components_entry( hdb, "'nasalis', 'maxilla'" );
+            ok( r == ERROR_SUCCESS, "cannot add feature components: %d\n", r );
+        }
+    }
+
     MsiCloseHandle(hdb);
     DeleteFileA(msifile);
 }
@@ -7585,6 +7636,43 @@ static void test_storages_table(void)
     MsiViewClose(hview);
     MsiCloseHandle(hview);
 
+    /* the only row is also the last one */
+    query = "SELECT `Name` FROM `_Storages` WHERE `Name` = 'stgname'";
+    r = MsiDatabaseOpenViewA(hdb, query, &hview);
+    ok(r == ERROR_SUCCESS, "Failed to open database hview: %d\n", r);
+
+    r = MsiViewExecute(hview, 0);
+    ok(r == ERROR_SUCCESS, "Failed to execute hview: %d\n", r);
+
+    r = MsiViewFetch(hview, &hrec);
+    ok(r == ERROR_SUCCESS, "Failed to fetch hrecord: %d\n", r);
+
+    size = MAX_PATH;
+    r = MsiRecordGetStringA(hrec, 1, file, &size);
+    ok(r == ERROR_SUCCESS, "Failed to get string: %d\n", r);
+    ok(!lstrcmpA(file, "stgname"), "Expected \"stgname\", got \"%s\"\n", file);
+
+    MsiCloseHandle(hrec);
+
+    r = MsiViewFetch(hview, &hrec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+
+    MsiViewClose(hview);
+    MsiCloseHandle(hview);
+
+    query = "SELECT `Name` FROM `_Storages` WHERE `Name` = 'nosuch'";
+    r = MsiDatabaseOpenViewA(hdb, query, &hview);
+    ok(r == ERROR_SUCCESS, "Failed to open database hview: %d\n", r);
+
+    r = MsiViewExecute(hview, 0);
+    ok(r == ERROR_SUCCESS, "Failed to execute hview: %d\n", r);
+
+    r = MsiViewFetch(hview, &hrec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+
+    MsiViewClose(hview);
+    MsiCloseHandle(hview);
+
     MsiDatabaseCommit(hdb);
     MsiCloseHandle(hdb);
 
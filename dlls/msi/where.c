@@ -52,6 +52,9 @@ typedef struct tagJOINTABLE
     UINT col_count;
     UINT row_count;
     UINT table_index;
+    UINT index_column;                   /* column looked up instead of a full scan, or 0 */
+    const union ext_column *index_join;  /* joined column providing the lookup value */
+    UINT index_value;                    /* lookup value when not joined */
 } JOINTABLE;
 
 typedef struct tagMSIORDERINFO
@@ -599,38 +602,61 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **tables,
+                             UINT table_rows[] );
+
+static UINT check_row( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **tables,
+                       UINT table_rows[], BOOL *done )
+{
+    UINT r;
+    INT val = 0;
+
+    wv->rec_index = 0;
+    r = WHERE_evaluate( wv, table_rows, wv->cond, &val, record );
+    if (r != ERROR_SUCCESS && r != ERROR_CONTINUE)
+    {
+        *done = TRUE;
+        return r;
+    }
+    if (val)
+    {
+        if (*(tables + 1))
+            r = check_condition(wv, record, tables + 1, table_rows);
+        else if (r == ERROR_SUCCESS)
+            add_row (wv, table_rows);
+        *done = (r != ERROR_SUCCESS);
+    }
+    return r;
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **tables,
                              UINT table_rows[] )
 {
+    JOINTABLE *table = *tables;
+    UINT *row = &table_rows[table->table_index];
     UINT r = ERROR_FUNCTION_FAILED;
-    INT val;
+    BOOL done = FALSE;
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    if (table->index_column)
     {
-        val = 0;
-        wv->rec_index = 0;
-        r = WHERE_evaluate( wv, table_rows, wv->cond, &val, record );
-        if (r != ERROR_SUCCESS && r != ERROR_CONTINUE)
-            break;
-        if (val)
-        {
-            if (*(tables + 1))
-            {
-                r = check_condition(wv, record, tables + 1, table_rows);
-                if (r != ERROR_SUCCESS)
-                    break;
-            }
-            else
-            {
-                if (r != ERROR_SUCCESS)
-                    break;
-                add_row (wv, table_rows);
-            }
-        }
+        MSIITERHANDLE handle = NULL;
+        UINT key = table->index_value;
+
+        /* rows with a different value in the index column can't match */
+        r = ERROR_SUCCESS;
+        if (table->index_join)
+            r = expr_fetch_value(table->index_join, table_rows, &key);
+        while (r == ERROR_SUCCESS && !done &&
+               table->view->ops->find_matching_rows(table->view, table->index_column,
+                                                    key, row, &handle) == ERROR_SUCCESS)
+            r = check_row(wv, record, tables, table_rows, &done);
+    }
+    else
+    {
+        for (*row = 0; !done && *row < table->row_count; (*row)++)
+            r = check_row(wv, record, tables, table_rows, &done);
     }
-    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    *row = INVALID_ROW_INDEX;
     return r;
 }
 
@@ -763,6 +789,150 @@ static JOINTABLE **ordertables( MSIWHEREVIEW *wv )
     return tables;
 }
 
+static BOOL is_joined_before( JOINTABLE **tables, JOINTABLE *table, JOINTABLE *other )
+{
+    while (*tables != table)
+    {
+        if (*tables == other)
+            return TRUE;
+        tables++;
+    }
+    return FALSE;
+}
+
+static BOOL get_string_key( MSIWHEREVIEW *wv, const WCHAR *str, UINT *key )
+{
+    if (!str || !*str)
+    {
+        *key = 0;
+        return TRUE;
+    }
+    return msi_string2id( wv->db->strings, str, -1, key ) == ERROR_SUCCESS;
+}
+
+/* checks whether column = value can be used to look up rows of the table;
+ * rec_index is the number of wildcards evaluated before value */
+static BOOL set_index_key( MSIWHEREVIEW *wv, JOINTABLE **tables, JOINTABLE *table,
+                           const struct expr *column, const struct expr *value,
+                           MSIRECORD *record, UINT rec_index )
+{
+    UINT bias = column->type == EXPR_COL_NUMBER ? 0x8000 : 0x80000000;
+
+    if (column->type != EXPR_COL_NUMBER && column->type != EXPR_COL_NUMBER32 &&
+        column->type != EXPR_COL_NUMBER_STRING)
+        return FALSE;
+    if (column->u.column.parsed.table != table)
+        return FALSE;
+
+    switch (value->type)
+    {
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+    case EXPR_COL_NUMBER_STRING:
+        if (value->type != column->type ||
+            !is_joined_before(tables, table, value->u.column.parsed.table))
+            return FALSE;
+        table->index_join = &value->u.column;
+        break;
+    case EXPR_UVAL:
+        if (column->type == EXPR_COL_NUMBER_STRING)
+            return FALSE;
+        table->index_value = value->u.uval + bias;
+        break;
+    case EXPR_SVAL:
+        if (column->type != EXPR_COL_NUMBER_STRING ||
+            !get_string_key(wv, value->u.sval, &table->index_value))
+            return FALSE;
+        break;
+    case EXPR_WILDCARD:
+        if (!record)
+            return FALSE;
+        if (column->type == EXPR_COL_NUMBER_STRING)
+        {
+            if (!get_string_key(wv, MSI_RecordGetString(record, rec_index + 1), &table->index_value))
+                return FALSE;
+        }
+        else
+            table->index_value = MSI_RecordGetInteger(record, rec_index + 1) + bias;
+        break;
+    default:
+        return FALSE;
+    }
+
+    table->index_column = column->u.column.parsed.column;
+    return TRUE;
+}
+
+/* looks for an equality in the top level conjunction of the condition that
+ * lets the rows of the table be found through its column hash */
+static void find_index_key( MSIWHEREVIEW *wv, const struct expr *expr, BOOL conjunct,
+                            JOINTABLE **tables, JOINTABLE *table, MSIRECORD *record,
+                            UINT *rec_index )
+{
+    const struct expr *left, *right;
+
+    switch (expr->type)
+    {
+    case EXPR_WILDCARD:
+        (*rec_index)++;
+        return;
+    case EXPR_COMPLEX:
+    case EXPR_STRCMP:
+        left = expr->u.expr.left;
+        right = expr->u.expr.right;
+
+        if (conjunct && expr->u.expr.op == OP_EQ && !table->index_column)
+        {
+            table->index_join = NULL;
+            if (!set_index_key(wv, tables, table, left, right, record,
+                               *rec_index + (left->type == EXPR_WILDCARD)))
+                set_index_key(wv, tables, table, right, left, record, *rec_index);
+        }
+
+        conjunct = conjunct && expr->type == EXPR_COMPLEX && expr->u.expr.op == OP_AND;
+        find_index_key(wv, left, conjunct, tables, table, record, rec_index);
+        find_index_key(wv, right, conjunct, tables, table, record, rec_index);
+        return;
+    default:
+        return;
+    }
+}
+
+/* decides for each table in evaluation order how its rows are enumerated */
+static void plan_lookups( MSIWHEREVIEW *wv, JOINTABLE **tables, MSIRECORD *record )
+{
+    UINT i, rec_index;
+
+    for (i = 0; tables[i]; i++)
+    {
+        JOINTABLE *table = tables[i];
+
+        table->index_column = 0;
+        table->index_join = NULL;
+        if (wv->cond && table->view->ops->find_matching_rows)
+        {
+            rec_index = 0;
+            find_index_key(wv, wv->cond, TRUE, tables, table, record, &rec_index);
+        }
+
+        if (TRACE_ON(msidb))
+        {
+            LPCWSTR name = NULL, table_name = NULL;
+
+            table->view->ops->get_column_info(table->view, table->index_column ? table->index_column : 1,
+                                              &name, NULL, NULL, &table_name);
+            if (table->index_column && table->index_join)
+                TRACE("%u: %s, %u rows, join lookup on %s\n", i, debugstr_w(table_name),
+                      table->row_count, debugstr_w(name));
+            else if (table->index_column)
+                TRACE("%u: %s, %u rows, lookup of %u on %s\n", i, debugstr_w(table_name),
+                      table->row_count, table->index_value, debugstr_w(name));
+            else
+                TRACE("%u: %s, %u rows, full scan\n", i, debugstr_w(table_name), table->row_count);
+        }
+    }
+}
+
 static UINT WHERE_execute( struct tagMSIVIEW *view, MSIRECORD *record )
 {
     MSIWHEREVIEW *wv = (MSIWHEREVIEW*)view;
@@ -799,6 +969,7 @@ static UINT WHERE_execute( struct tagMSIVIEW *view, MSIRECORD *record )
     while ((table = table->next));
 
     ordered_tables = ordertables( wv );
+    plan_lookups( wv, ordered_tables, record );
 
     rows = msi_alloc( wv->table_count * sizeof(*rows) );
     for (i = 0; i < wv->table_count; i++)
@@ -891,12 +891,9 @@ MSVCRT_size_t __cdecl MSVCRT_strlen(const char *str)
  */
 MSVCRT_size_t CDECL MSVCRT_strnlen(const char *s, MSVCRT_size_t maxlen)
 {
-    MSVCRT_size_t i;
-
-    for(i=0; i<maxlen; i++)
-        if(!s[i]) break;
+    const char *end = memchr(s, 0, maxlen);
 
-    return i;
+    return end ? end - s : maxlen;
 }
 
 /*********************************************************************
@@ -67,6 +67,7 @@ static int (__cdecl *p_wcsncpy_s)(wchar_t *wcDest, size_t size, const wchar_t *w
 static int (__cdecl *p_wcsncat_s)(wchar_t *dst, size_t elem, const wchar_t *src, size_t count);
 static int (__cdecl *p_wcsupr_s)(wchar_t *str, size_t size);
 static size_t (__cdecl *p_strnlen)(const char *, size_t);
+static size_t (__cdecl *p_wcsnlen)(const wchar_t *, size_t);
 static __int64 (__cdecl *p_strtoi64)(const char *, char **, int);
 static unsigned __int64 (__cdecl *p_strtoui64)(const char *, char **, int);
 static __int64 (__cdecl *p_wcstoi64)(const wchar_t *, wchar_t **, int);
@@ -1570,6 +1571,32 @@ static void test_strnlen(void)
     ok(res == 0, "Returned length = %d\n", (int)res);
 }
 
+static void test_wcsnlen(void)
+{
+    wchar_t buf[32];
+    size_t res, i, len;
+
+    if(!p_wcsnlen) {
+        win_skip("wcsnlen not found\n");
+        return;
+    }
+
+    /* check all alignments and lengths around the word size */
+    for(i=0; i<4; i++) {
+        for(len=0; len<20; len++) {
+            memset(buf, 0x41, sizeof(buf));
+            buf[i+len] = 0;
+
+            res = wcslen(buf+i);
+            ok(res == len, "%d/%d: wcslen returned %d\n", (int)i, (int)len, (int)res);
+            res = p_wcsnlen(buf+i, 20);
+            ok(res == len, "%d/%d: wcsnlen returned %d\n", (int)i, (int)len, (int)res);
+            res = p_wcsnlen(buf+i, len/2);
+            ok(res == len/2, "%d/%d: wcsnlen returned %d\n", (int)i, (int)len, (int)res);
+        }
+    }
+}
+
 static void test__strtoi64(void)
 {
     static const char no1[] = "31923";
@@ -3086,6 +3113,7 @@ START_TEST(string)
     p_wcsncat_s = (void *)GetProcAddress( hMsvcrt,"wcsncat_s" );
     p_wcsupr_s = (void *)GetProcAddress( hMsvcrt,"_wcsupr_s" );
     p_strnlen = (void *)GetProcAddress( hMsvcrt,"strnlen" );
+    p_wcsnlen = (void *)GetProcAddress( hMsvcrt,"wcsnlen" );
     p_strtoi64 = (void *)GetProcAddress(hMsvcrt, "_strtoi64");
     p_strtoui64 = (void *)GetProcAddress(hMsvcrt, "_strtoui64");
     p_wcstoi64 = (void *)GetProcAddress(hMsvcrt, "_wcstoi64");
@@ -3148,6 +3176,7 @@ START_TEST(string)
     test__wcsupr_s();
     test_strtol();
     test_strnlen();
+    test_wcsnlen();
     test__strtoi64();
     test__strtod();
     test_mbstowcs();
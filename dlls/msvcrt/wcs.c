@@ -2196,14 +2196,30 @@ MSVCRT_ulong __cdecl MSVCRT_wcstoul(const MSVCRT_wchar_t *s, MSVCRT_wchar_t **en
     return MSVCRT__wcstoul_l(s, end, base, NULL);
 }
 
+/* check if any of the wide chars packed in a word is 0 */
+static inline BOOL word_has_null_wchar(ULONG_PTR word)
+{
+    static const ULONG_PTR ones = (ULONG_PTR)~0 / 0xffff;
+
+    return ((word - ones) & ~word & (ones << 15)) != 0;
+}
+
 /******************************************************************
  *  wcsnlen (MSVCRT.@)
  */
 MSVCRT_size_t CDECL MSVCRT_wcsnlen(const MSVCRT_wchar_t *s, MSVCRT_size_t maxlen)
 {
+    static const MSVCRT_size_t word_chars = sizeof(ULONG_PTR) / sizeof(MSVCRT_wchar_t);
     MSVCRT_size_t i;
 
-    for (i = 0; i < maxlen; i++)
+    for (i = 0; i < maxlen && ((ULONG_PTR)(s + i) % sizeof(ULONG_PTR)); i++)
+        if (!s[i]) return i;
+
+    /* aligned word reads never cross a page boundary */
+    for (; maxlen - i >= word_chars; i += word_chars)
+        if (word_has_null_wchar(*(const ULONG_PTR *)(s + i))) break;
+
+    for (; i < maxlen; i++)
         if (!s[i]) break;
     return i;
 }
@@ -2253,7 +2269,17 @@ MSVCRT_wchar_t* CDECL MSVCRT_wcschr(const MSVCRT_wchar_t *str, MSVCRT_wchar_t ch
  */
 int CDECL MSVCRT_wcslen(const MSVCRT_wchar_t *str)
 {
-    return strlenW(str);
+    const MSVCRT_wchar_t *s = str;
+    const ULONG_PTR *p;
+
+    for (; (ULONG_PTR)s % sizeof(ULONG_PTR); s++)
+        if (!*s) return s - str;
+
+    /* aligned word reads never cross a page boundary */
+    for (p = (const ULONG_PTR *)s; !word_has_null_wchar(*p); p++) ;
+
+    for (s = (const MSVCRT_wchar_t *)p; *s; s++) ;
+    return s - str;
 }
 
 /*********************************************************************
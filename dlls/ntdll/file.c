@@ -600,6 +600,14 @@ NTSTATUS FILE_GetNtStatus(void)
     }
 }
 
+/* operations that complete synchronously don't queue a completion packet on success
+ * if the file was set to FILE_SKIP_COMPLETION_PORT_ON_SUCCESS */
+static inline BOOL needs_completion( ULONG_PTR cvalue, NTSTATUS status, unsigned int options )
+{
+    if (!cvalue) return FALSE;
+    return status < 0 || !(options & FD_OPTION_SKIP_COMPLETION_ON_SUCCESS);
+}
+
 /* helper function for FSCTL_PIPE_PEEK and read_unix_fd */
 static NTSTATUS unix_fd_avail(int fd, int *avail)
 {
@@ -1180,7 +1188,7 @@ NTSTATUS WINAPI SYSCALL(NtReadFile)(HANDLE hFile, HANDLE hEvent,
     }
 
 done:
-    send_completion = cvalue != 0;
+    send_completion = needs_completion( cvalue, status, options );
 
 err:
     if (needs_close) close( unix_handle );
@@ -1268,7 +1276,7 @@ NTSTATUS WINAPI SYSCALL(NtReadFileScatter)( HANDLE file, HANDLE event, PIO_APC_R
         }
     }
 
-    send_completion = cvalue != 0;
+    send_completion = needs_completion( cvalue, status, options );
 
  error:
     if (needs_close) close( unix_handle );
@@ -1591,7 +1599,7 @@ NTSTATUS WINAPI SYSCALL(NtWriteFile)(HANDLE hFile, HANDLE hEvent,
     }
 
 done:
-    send_completion = cvalue != 0;
+    send_completion = needs_completion( cvalue, status, options );
 
 err:
     if (needs_close) close( unix_handle );
@@ -1688,7 +1696,7 @@ NTSTATUS WINAPI SYSCALL(NtWriteFileGather)( HANDLE file, HANDLE event, PIO_APC_R
         }
     }
 
-    send_completion = cvalue != 0;
+    send_completion = needs_completion( cvalue, status, options );
 
  error:
     if (needs_close) close( unix_handle );
@@ -3146,6 +3154,16 @@ NTSTATUS WINAPI SYSCALL(NtSetInformationFile)(HANDLE handle, PIO_STATUS_BLOCK io
             io->u.Status = STATUS_INVALID_PARAMETER_3;
         break;
 
+    case FileIoCompletionNotificationInformation:
+        if (len >= sizeof(FILE_IO_COMPLETION_NOTIFICATION_INFORMATION))
+        {
+            FILE_IO_COMPLETION_NOTIFICATION_INFORMATION *info = ptr;
+
+            io->u.Status = server_set_fd_completion_mode( handle, info->Flags );
+        } else
+            io->u.Status = STATUS_INFO_LENGTH_MISMATCH;
+        break;
+
     case FileAllInformation:
         io->u.Status = STATUS_INVALID_INFO_CLASS;
         break;
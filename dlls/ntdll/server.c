@@ -936,6 +936,48 @@ int server_remove_fd_from_cache( HANDLE handle )
 }
 
 
+/***********************************************************************
+ *           server_set_fd_completion_mode
+ *
+ * Set the completion notification modes of a file, and update the cached
+ * options so that the skip flag can be checked without a server call.
+ */
+NTSTATUS server_set_fd_completion_mode( HANDLE handle, ULONG flags )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    sigset_t sigset;
+    NTSTATUS ret;
+
+    /* hold the cache lock so that a concurrent lookup can't cache stale options */
+    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+
+    SERVER_START_REQ( set_fd_completion_mode )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        req->flags  = flags;
+        ret = wine_server_call( req );
+    }
+    SERVER_END_REQ;
+
+    if (!ret && (flags & FILE_SKIP_COMPLETION_PORT_ON_SUCCESS) &&
+        entry < FD_CACHE_ENTRIES && fd_cache[entry])
+    {
+        union fd_cache_entry cache, old;
+
+        do
+        {
+            old.data = interlocked_cmpxchg64( &fd_cache[entry][idx].data, 0, 0 );
+            if (!old.s.fd) break;
+            cache.data = old.data;
+            cache.s.options |= FD_OPTION_SKIP_COMPLETION_ON_SUCCESS;
+        } while (interlocked_cmpxchg64( &fd_cache[entry][idx].data, cache.data, old.data ) != old.data);
+    }
+
+    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+    return ret;
+}
+
+
 /***********************************************************************
  *           wine_server_close_fds_by_type
  *
@@ -3995,6 +3995,24 @@ static ULONG Storage32Impl_AddExtBlockDepot(StorageImpl* This)
   return index;
 }
 
+/************************************************************************
+ * StorageImpl_FindCachedDepotBlock
+ *
+ * Returns the cached copy of the given big block depot sector, or NULL.
+ */
+static BlockDepotCacheEntry *StorageImpl_FindCachedDepotBlock(
+  StorageImpl* This,
+  ULONG        depotBlockCount)
+{
+  int i;
+
+  for (i = 0; i < BLOCKDEPOT_CACHE_SIZE; i++)
+    if (This->blockDepotCache[i].index == depotBlockCount)
+      return &This->blockDepotCache[i];
+
+  return NULL;
+}
+
 /************************************************************************
  * StorageImpl_GetNextBlockInChain
  *
@@ -4030,6 +4048,7 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   BYTE depotBuffer[MAX_BIG_BLOCK_SIZE];
   ULONG read;
   ULONG depotBlockIndexPos;
+  BlockDepotCacheEntry *entry;
   int index, num_blocks;
 
   *nextBlockIndex   = BLOCK_SPECIAL;
@@ -4042,11 +4061,16 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   }
 
   /*
-   * Cache the currently accessed depot block.
+   * Cache the currently accessed depot block, evicting the least recently
+   * used one.
    */
-  if (depotBlockCount != This->indexBlockDepotCached)
+  if (!(entry = StorageImpl_FindCachedDepotBlock(This, depotBlockCount)))
   {
-    This->indexBlockDepotCached = depotBlockCount;
+    entry = &This->blockDepotCache[0];
+    for (index = 1; index < BLOCKDEPOT_CACHE_SIZE; index++)
+      if (This->blockDepotCache[index].lastUse < entry->lastUse)
+        entry = &This->blockDepotCache[index];
+    entry->index = 0xFFFFFFFF;
 
     if (depotBlockCount < COUNT_BBDEPOTINHEADER)
     {
@@ -4070,11 +4094,13 @@ static HRESULT StorageImpl_GetNextBlockInChain(
     for (index = 0; index < num_blocks; index++)
     {
       StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), nextBlockIndex);
-      This->blockDepotCached[index] = *nextBlockIndex;
+      entry->entries[index] = *nextBlockIndex;
     }
+    entry->index = depotBlockCount;
   }
 
-  *nextBlockIndex = This->blockDepotCached[depotBlockOffset/sizeof(ULONG)];
+  entry->lastUse = ++This->blockDepotCacheUse;
+  *nextBlockIndex = entry->entries[depotBlockOffset/sizeof(ULONG)];
 
   return S_OK;
 }
@@ -4128,6 +4154,7 @@ static void StorageImpl_SetNextBlockInChain(
   ULONG depotBlockCount  = offsetInDepot / This->bigBlockSize;
   ULONG depotBlockOffset = offsetInDepot % This->bigBlockSize;
   ULONG depotBlockIndexPos;
+  BlockDepotCacheEntry *entry;
 
   assert(depotBlockCount < This->bigBlockDepotCount);
   assert(blockIndex != nextBlock);
@@ -4156,9 +4183,9 @@ static void StorageImpl_SetNextBlockInChain(
   /*
    * Update the cached block depot, if necessary.
    */
-  if (depotBlockCount == This->indexBlockDepotCached)
+  if ((entry = StorageImpl_FindCachedDepotBlock(This, depotBlockCount)))
   {
-    This->blockDepotCached[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+    entry->entries[depotBlockOffset/sizeof(ULONG)] = nextBlock;
   }
 }
 
@@ -4627,6 +4654,7 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   DirEntry currentEntry;
   DirRef      currentEntryRef;
   BlockChainStream *blockChainStream;
+  int i;
 
   if (create)
   {
@@ -4693,7 +4721,12 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   /*
    * There is no block depot cached yet.
    */
-  This->indexBlockDepotCached = 0xFFFFFFFF;
+  for (i = 0; i < BLOCKDEPOT_CACHE_SIZE; i++)
+  {
+    This->blockDepotCache[i].index = 0xFFFFFFFF;
+    This->blockDepotCache[i].lastUse = 0;
+  }
+  This->blockDepotCacheUse = 0;
   This->indexExtBlockDepotCached = 0xFFFFFFFF;
 
   /*
@@ -7259,6 +7292,24 @@ static HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
   return S_OK;
 }
 
+/* Returns how many of the count blocks starting at the given offset follow
+ * sector in the file and are not cached, so they can be accessed at once. */
+static ULONG BlockChainStream_GetContiguousBlocks(BlockChainStream *This,
+    ULONG index, ULONG sector, ULONG count)
+{
+  ULONG i;
+
+  for (i=0; i<count; i++)
+  {
+    if (This->cachedBlocks[0].index == index + i || This->cachedBlocks[1].index == index + i)
+      break;
+    if (BlockChainStream_GetSectorOfOffset(This, index + i) != sector + i)
+      break;
+  }
+
+  return i;
+}
+
 BlockChainStream* BlockChainStream_Construct(
   StorageImpl* parentStorage,
   ULONG*         headOfStreamPlaceHolder,
@@ -7610,7 +7661,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
   ULONG blockNoInSequence = offset.QuadPart / This->parentStorage->bigBlockSize;
   ULONG offsetInBlock     = offset.QuadPart % This->parentStorage->bigBlockSize;
   ULONG bytesToReadInBuffer;
-  ULONG blockIndex;
+  ULONG blockIndex, blockCount;
   BYTE* bufferWalker;
   ULARGE_INTEGER stream_size;
   HRESULT hr;
@@ -7646,6 +7697,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
      */
     bytesToReadInBuffer =
       min(This->parentStorage->bigBlockSize - offsetInBlock, size);
+    blockCount = 1;
 
     hr = BlockChainStream_GetBlockAtOffset(This, blockNoInSequence, &cachedBlock, &blockIndex, size == bytesToReadInBuffer);
 
@@ -7654,7 +7706,13 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to read past the end of the block. */
+      /* Not in cache, and we're going to read past the end of the block.
+       * Also read the following whole blocks that are stored next to it,
+       * leaving the last one to the cache. */
+      blockCount += BlockChainStream_GetContiguousBlocks(This, blockNoInSequence + 1, blockIndex + 1,
+          (size - bytesToReadInBuffer - 1) / This->parentStorage->bigBlockSize);
+      bytesToReadInBuffer += (blockCount - 1) * This->parentStorage->bigBlockSize;
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -7679,7 +7737,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
       bytesReadAt = bytesToReadInBuffer;
     }
 
-    blockNoInSequence++;
+    blockNoInSequence += blockCount;
     bufferWalker += bytesReadAt;
     size         -= bytesReadAt;
     *bytesRead   += bytesReadAt;
@@ -7707,7 +7765,7 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
   ULONG blockNoInSequence = offset.QuadPart / This->parentStorage->bigBlockSize;
   ULONG offsetInBlock     = offset.QuadPart % This->parentStorage->bigBlockSize;
   ULONG bytesToWrite;
-  ULONG blockIndex;
+  ULONG blockIndex, blockCount;
   const BYTE* bufferWalker;
   HRESULT hr;
   BlockChainBlock *cachedBlock;
@@ -7725,6 +7783,7 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
      */
     bytesToWrite =
       min(This->parentStorage->bigBlockSize - offsetInBlock, size);
+    blockCount = 1;
 
     hr = BlockChainStream_GetBlockAtOffset(This, blockNoInSequence, &cachedBlock, &blockIndex, size == bytesToWrite);
 
@@ -7738,7 +7797,13 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to write past the end of the block. */
+      /* Not in cache, and we're going to write past the end of the block.
+       * Also write the following whole blocks that are stored next to it,
+       * leaving the last one to the cache. */
+      blockCount += BlockChainStream_GetContiguousBlocks(This, blockNoInSequence + 1, blockIndex + 1,
+          (size - bytesToWrite - 1) / This->parentStorage->bigBlockSize);
+      bytesToWrite += (blockCount - 1) * This->parentStorage->bigBlockSize;
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -7763,7 +7828,7 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
       cachedBlock->dirty = TRUE;
     }
 
-    blockNoInSequence++;
+    blockNoInSequence += blockCount;
     bufferWalker  += bytesWrittenAt;
     size          -= bytesWrittenAt;
     *bytesWritten += bytesWrittenAt;
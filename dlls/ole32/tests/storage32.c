@@ -3871,6 +3871,103 @@ static void test_overwrite(void)
     DeleteFileA(filenameA);
 }
 
+static void test_interleaved_streams(void)
+{
+    static const WCHAR stmname[] = { 'C','O','N','T','E','N','T','S',0 };
+    static const WCHAR stmname2[] = { 'C','O','N','T','E','N','T','2',0 };
+    IStorage *stg = NULL;
+    IStream *stm[2];
+    LARGE_INTEGER pos;
+    ULONG count;
+    BYTE *buffer;
+    HRESULT r;
+    int i, j, k;
+
+    buffer = HeapAlloc(GetProcessHeap(), 0, 64 * 3000);
+
+    DeleteFileA(filenameA);
+
+    r = StgCreateDocfile(filename, STGM_CREATE | STGM_SHARE_EXCLUSIVE | STGM_READWRITE, 0, &stg);
+    ok(r==S_OK, "StgCreateDocfile failed %x\n", r);
+
+    r = IStorage_CreateStream(stg, stmname, STGM_SHARE_EXCLUSIVE | STGM_READWRITE, 0, 0, &stm[0]);
+    ok(r==S_OK, "IStorage->CreateStream failed %x\n", r);
+    r = IStorage_CreateStream(stg, stmname2, STGM_SHARE_EXCLUSIVE | STGM_READWRITE, 0, 0, &stm[1]);
+    ok(r==S_OK, "IStorage->CreateStream failed %x\n", r);
+
+    /* alternate the writes, so that both block chains are fragmented */
+    for (i=0; i<64; i++)
+    {
+        for (j=0; j<2; j++)
+        {
+            for (k=0; k<3000; k++)
+                buffer[k] = (i * 3000 + k) * (j + 3) / 7;
+            r = IStream_Write(stm[j], buffer, 3000, &count);
+            ok(r==S_OK, "IStream->Write failed %x\n", r);
+            ok(count == 3000, "wrote %u bytes\n", count);
+        }
+    }
+
+    for (j=0; j<2; j++)
+    {
+        pos.QuadPart = 0;
+        r = IStream_Seek(stm[j], pos, STREAM_SEEK_SET, NULL);
+        ok(r==S_OK, "IStream->Seek failed %x\n", r);
+
+        /* overwrite most of the stream in a single call, starting mid-block */
+        if (j)
+        {
+            pos.QuadPart = 100;
+            r = IStream_Seek(stm[j], pos, STREAM_SEEK_SET, NULL);
+            ok(r==S_OK, "IStream->Seek failed %x\n", r);
+            for (k=100; k<63 * 3000; k++)
+                buffer[k] = k * 5 / 3;
+            r = IStream_Write(stm[j], buffer + 100, 63 * 3000 - 100, &count);
+            ok(r==S_OK, "IStream->Write failed %x\n", r);
+            ok(count == 63 * 3000 - 100, "wrote %u bytes\n", count);
+
+            pos.QuadPart = 0;
+            r = IStream_Seek(stm[j], pos, STREAM_SEEK_SET, NULL);
+            ok(r==S_OK, "IStream->Seek failed %x\n", r);
+        }
+
+        memset(buffer, 0, 64 * 3000);
+        r = IStream_Read(stm[j], buffer, 64 * 3000, &count);
+        ok(r==S_OK, "IStream->Read failed %x\n", r);
+        ok(count == 64 * 3000, "read %u bytes\n", count);
+
+        for (k=0; k<64 * 3000; k++)
+        {
+            BYTE expected = (j && k >= 100 && k < 63 * 3000) ? k * 5 / 3 : k * (j + 3) / 7;
+            if (buffer[k] != expected)
+                break;
+        }
+        ok(k == 64 * 3000, "stream %d: unexpected data at byte %d\n", j, k);
+
+        /* unaligned reads across block boundaries */
+        pos.QuadPart = 1234;
+        r = IStream_Seek(stm[j], pos, STREAM_SEEK_SET, NULL);
+        ok(r==S_OK, "IStream->Seek failed %x\n", r);
+        r = IStream_Read(stm[j], buffer, 5000, &count);
+        ok(r==S_OK, "IStream->Read failed %x\n", r);
+        ok(count == 5000, "read %u bytes\n", count);
+        for (k=0; k<5000; k++)
+        {
+            BYTE expected = (j && k + 1234 < 63 * 3000) ? (k + 1234) * 5 / 3 : (k + 1234) * (j + 3) / 7;
+            if (buffer[k] != expected)
+                break;
+        }
+        ok(k == 5000, "stream %d: unexpected data at byte %d\n", j, k + 1234);
+    }
+
+    IStream_Release(stm[0]);
+    IStream_Release(stm[1]);
+    IStorage_Release(stg);
+
+    HeapFree(GetProcessHeap(), 0, buffer);
+    DeleteFileA(filenameA);
+}
+
 static void test_custom_lockbytes(void)
 {
     static const WCHAR stmname[] = { 'C','O','N','T','E','N','T','S',0 };
@@ -3967,5 +4064,6 @@ START_TEST(storage32)
     test_locking();
     test_transacted_shared();
     test_overwrite();
+    test_interleaved_streams();
     test_custom_lockbytes();
 }
@@ -56,6 +56,18 @@ WINE_DECLARE_DEBUG_CHANNEL(key);
 
 #define MAX_PACK_COUNT 4
 
+/* how long the shared queue bits may be trusted before a get_message request
+ * is forced; must stay well below the server hung application timeout (5 s) */
+#define SHM_GET_MESSAGE_INTERVAL 2000
+
+static LONG skipped_server_calls;
+
+static inline void count_skipped_server_call(void)
+{
+    LONG count = InterlockedIncrement( &skipped_server_calls );
+    if (!(count % 1000)) TRACE( "%d queue server requests avoided so far\n", count );
+}
+
 /* the various structures that can be sent in messages, in platform-independent layout */
 struct packed_CREATESTRUCTW
 {
@@ -2742,13 +2754,17 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
 
     /* From time to time we are forced to do a wineserver call in
      * order to update last_msg_time stored for each server thread. */
-    if (shm && GetTickCount() - thread_info->last_get_msg < 500)
+    if (shm && GetTickCount() - thread_info->last_get_msg < SHM_GET_MESSAGE_INTERVAL)
     {
         int filter = flags >> 16;
         if (!filter) filter = QS_ALLINPUT;
         filter |= QS_SENDMESSAGE;
         if (filter & QS_INPUT) filter |= QS_INPUT;
-        if (!(shm->queue_bits & filter)) return FALSE;
+        if (!(shm->queue_bits & filter))
+        {
+            count_skipped_server_call();
+            return FALSE;
+        }
     }
 
     if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
@@ -3062,12 +3078,34 @@ static DWORD wait_objects( DWORD count, const HANDLE *handles, DWORD timeout,
                            DWORD wake_mask, DWORD changed_mask, DWORD flags )
 {
     struct user_thread_info *thread_info = get_user_thread_info();
+    shmlocal_t *shm = wine_get_shmlocal();
     DWORD ret;
 
     assert( count );  /* we must have at least the server queue */
 
     flush_window_surfaces( TRUE );
 
+    /* when the queue is the only object, the shared queue bits tell us
+     * whether the wait would be satisfied without asking the server */
+    if (shm && count == 1 && !(flags & (MWMO_WAITALL | MWMO_ALERTABLE)))
+    {
+        if ((shm->queue_bits & wake_mask) || (shm->changed_bits & changed_mask))
+        {
+            count_skipped_server_call();
+            return WAIT_OBJECT_0;
+        }
+        if (!timeout)
+        {
+            /* let the driver process its events, they may queue new messages */
+            ret = wow_handlers.wait_message( 0, NULL, 0, changed_mask, flags );
+            count_skipped_server_call();
+            if (ret != WAIT_TIMEOUT &&
+                ((shm->queue_bits & wake_mask) || (shm->changed_bits & changed_mask)))
+                return WAIT_OBJECT_0;
+            return WAIT_TIMEOUT;
+        }
+    }
+
     if (thread_info->wake_mask != wake_mask || thread_info->changed_mask != changed_mask)
     {
         SERVER_START_REQ( set_queue_mask )
@@ -7905,6 +7905,136 @@ static void test_window_from_point(const char *argv0)
     DestroyWindow(hwnd);
 }
 
+static void other_process_windows_proc(void)
+{
+    HANDLE start_event, end_event;
+    HWND top, child, hidden;
+
+    start_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_opw_start");
+    ok(start_event != 0, "OpenEvent failed\n");
+    end_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_opw_end");
+    ok(end_event != 0, "OpenEvent failed\n");
+
+    top = CreateWindowExA(0, "static", "opw_top", WS_POPUP | WS_VISIBLE,
+            100, 100, 300, 200, 0, 0, NULL, NULL);
+    ok(top != 0, "CreateWindowEx failed\n");
+    child = CreateWindowExA(0, "static", "opw_child", WS_CHILD | WS_VISIBLE,
+            10, 20, 50, 40, top, 0, NULL, NULL);
+    ok(child != 0, "CreateWindowEx failed\n");
+    hidden = CreateWindowExA(0, "static", "opw_hidden", WS_CHILD,
+            70, 20, 50, 40, top, 0, NULL, NULL);
+    ok(hidden != 0, "CreateWindowEx failed\n");
+    SetEvent(start_event);
+
+    /* keep processing the SetWindowPos and ShowWindow calls of the parent process */
+    ok(wait_for_event(end_event, 5000), "didn't get end_event\n");
+
+    DestroyWindow(top);
+    CloseHandle(start_event);
+    CloseHandle(end_event);
+}
+
+static void check_other_process_rects(HWND hwnd, int x, int y, int cx, int cy, int line)
+{
+    RECT rect;
+
+    SetRectEmpty(&rect);
+    ok_(__FILE__, line)(GetWindowRect(hwnd, &rect), "GetWindowRect failed\n");
+    ok_(__FILE__, line)(rect.left == x && rect.top == y && rect.right == x + cx && rect.bottom == y + cy,
+                        "%p: wrong window rect %d,%d-%d,%d\n", hwnd,
+                        rect.left, rect.top, rect.right, rect.bottom);
+    SetRectEmpty(&rect);
+    ok_(__FILE__, line)(GetClientRect(hwnd, &rect), "GetClientRect failed\n");
+    ok_(__FILE__, line)(rect.left == 0 && rect.top == 0 && rect.right == cx && rect.bottom == cy,
+                        "%p: wrong client rect %d,%d-%d,%d\n", hwnd,
+                        rect.left, rect.top, rect.right, rect.bottom);
+}
+
+static void test_other_process_windows(const char *argv0)
+{
+    HWND top, child, hidden, parent;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmd[MAX_PATH];
+    HANDLE start_event, end_event;
+    DWORD tid, pid;
+
+    start_event = CreateEventA(NULL, FALSE, FALSE, "test_opw_start");
+    ok(start_event != 0, "CreateEvent failed\n");
+    end_event = CreateEventA(NULL, FALSE, FALSE, "test_opw_end");
+    ok(end_event != 0, "CreateEvent failed\n");
+
+    sprintf(cmd, "%s win other_process_windows\n", argv0);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    ok(CreateProcessA(NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL,
+                &startup, &info), "CreateProcess failed.\n");
+    ok(wait_for_event(start_event, 5000), "didn't get start_event\n");
+
+    top = FindWindowA("static", "opw_top");
+    ok(top != 0, "top window not found\n");
+    child = FindWindowExA(top, 0, "static", "opw_child");
+    ok(child != 0, "child window not found\n");
+    hidden = FindWindowExA(top, 0, "static", "opw_hidden");
+    ok(hidden != 0, "hidden window not found\n");
+    if (!top || !child || !hidden)
+    {
+        SetEvent(end_event);
+        goto done;
+    }
+
+    tid = GetWindowThreadProcessId(top, &pid);
+    ok(tid == info.dwThreadId, "got tid %04x, expected %04x\n", tid, info.dwThreadId);
+    ok(pid == info.dwProcessId, "got pid %04x, expected %04x\n", pid, info.dwProcessId);
+    pid = 0;
+    tid = GetWindowThreadProcessId(child, &pid);
+    ok(tid == info.dwThreadId, "got tid %04x, expected %04x\n", tid, info.dwThreadId);
+    ok(pid == info.dwProcessId, "got pid %04x, expected %04x\n", pid, info.dwProcessId);
+
+    parent = GetParent(child);
+    ok(parent == top, "GetParent returned %p, expected %p\n", parent, top);
+    parent = GetParent(hidden);
+    ok(parent == top, "GetParent returned %p, expected %p\n", parent, top);
+    parent = GetParent(top);
+    ok(parent == 0, "GetParent returned %p, expected 0\n", parent);
+
+    ok(IsWindowVisible(top), "top window should be visible\n");
+    ok(IsWindowVisible(child), "child window should be visible\n");
+    ok(!IsWindowVisible(hidden), "hidden window should not be visible\n");
+
+    check_other_process_rects(top, 100, 100, 300, 200, __LINE__);
+    check_other_process_rects(child, 110, 120, 50, 40, __LINE__);
+    check_other_process_rects(hidden, 170, 120, 50, 40, __LINE__);
+
+    /* changes made by the owner thread must be seen immediately */
+    SetWindowPos(top, 0, 200, 150, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+    check_other_process_rects(top, 200, 150, 300, 200, __LINE__);
+    check_other_process_rects(child, 210, 170, 50, 40, __LINE__);
+    SetWindowPos(child, 0, 5, 5, 30, 30, SWP_NOZORDER | SWP_NOACTIVATE);
+    check_other_process_rects(child, 205, 155, 30, 30, __LINE__);
+
+    ShowWindow(hidden, SW_SHOWNA);
+    ok(IsWindowVisible(hidden), "hidden window should be visible\n");
+    ShowWindow(top, SW_HIDE);
+    ok(!IsWindowVisible(top), "top window should not be visible\n");
+    ok(!IsWindowVisible(child), "child of a hidden window should not be visible\n");
+    ok(GetWindowLongA(child, GWL_STYLE) & WS_VISIBLE, "child should keep WS_VISIBLE\n");
+
+    SetEvent(end_event);
+    winetest_wait_child_process(info.hProcess);
+
+    ok(!IsWindow(top), "top window should be destroyed\n");
+    ok(!IsWindow(child), "child window should be destroyed\n");
+    ok(!IsWindowVisible(child), "destroyed window should not be visible\n");
+    ok(!GetParent(child), "destroyed window should not have a parent\n");
+
+done:
+    CloseHandle(start_event);
+    CloseHandle(end_event);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+}
+
 static void test_map_points(void)
 {
     BOOL ret;
@@ -8696,6 +8826,12 @@ START_TEST(win)
         return;
     }
 
+    if (argc==3 && !strcmp(argv[2], "other_process_windows"))
+    {
+        other_process_windows_proc();
+        return;
+    }
+
     if (!RegisterWindowClasses()) assert(0);
 
     hwndMain = CreateWindowExA(/*WS_EX_TOOLWINDOW*/ 0, "MainWindowClass", "Main window",
@@ -8734,6 +8870,7 @@ START_TEST(win)
     /* Add the tests below this line */
     test_child_window_from_point();
     test_window_from_point(argv[0]);
+    test_other_process_windows(argv[0]);
     test_thick_child_size(hwndMain);
     test_fullscreen();
     test_hwnd_message();
@@ -629,6 +629,106 @@ WND *WIN_GetPtr( HWND hwnd )
 }
 
 
+/* orders the reads of the shared memory against the sequence counter */
+static inline void shm_read_barrier(void)
+{
+#ifdef __GNUC__
+    __sync_synchronize();
+#else
+    LONG dummy;
+    InterlockedExchange( &dummy, 0 );
+#endif
+}
+
+/***********************************************************************
+ *           get_shm_window
+ *
+ * Get the information of a window not local to the process from the
+ * server shared memory. Returns FALSE if it has to be asked to the server.
+ */
+static BOOL get_shm_window( HWND hwnd, shmwindow_t *info )
+{
+    shmglobal_t *shm = wine_get_shmglobal();
+    const volatile shmwindow_t *entry;
+    user_handle_t handle = wine_server_user_handle( hwnd );
+    unsigned int seq, retries, index = (LOWORD(handle) - FIRST_USER_HANDLE) >> 1;
+
+    if (!shm || LOWORD(handle) < FIRST_USER_HANDLE || index >= SHM_MAX_WINDOWS) return FALSE;
+    entry = &shm->windows[index];
+
+    /* the server may be in the middle of an update, or stopped there */
+    for (retries = 0; retries < 100; retries++)
+    {
+        if ((seq = entry->seq) & 1) continue;
+        shm_read_barrier();
+        *info = *entry;
+        shm_read_barrier();
+        if (entry->seq == seq) break;
+    }
+    if (retries == 100) return FALSE;
+
+    if (!info->handle) return FALSE;
+    return info->handle == handle || !HIWORD(handle) || HIWORD(handle) == 0xffff;
+}
+
+
+/***********************************************************************
+ *           get_shm_rectangles
+ *
+ * Get the rectangles of a window not local to the process from the
+ * server shared memory, converted like the get_window_rectangles request.
+ */
+static BOOL get_shm_rectangles( HWND hwnd, enum coords_relative relative, RECT *rectWindow, RECT *rectClient )
+{
+    shmwindow_t info, parent;
+    RECT window_rect, client_rect, rect;
+
+    if (!get_shm_window( hwnd, &info )) return FALSE;
+    SetRect( &window_rect, info.window.left, info.window.top, info.window.right, info.window.bottom );
+    SetRect( &client_rect, info.client.left, info.client.top, info.client.right, info.client.bottom );
+
+    switch (relative)
+    {
+    case COORDS_CLIENT:
+        rect = client_rect;
+        OffsetRect( &window_rect, -rect.left, -rect.top );
+        OffsetRect( &client_rect, -rect.left, -rect.top );
+        if (info.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &window_rect );
+        break;
+    case COORDS_WINDOW:
+        rect = window_rect;
+        OffsetRect( &window_rect, -rect.left, -rect.top );
+        OffsetRect( &client_rect, -rect.left, -rect.top );
+        if (info.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &client_rect );
+        break;
+    case COORDS_PARENT:
+        if (!info.parent) break;
+        if (!get_shm_window( wine_server_ptr_handle( info.parent ), &parent )) return FALSE;
+        if (parent.ex_style & WS_EX_LAYOUTRTL)
+        {
+            SetRect( &rect, parent.client.left, parent.client.top, parent.client.right, parent.client.bottom );
+            mirror_rect( &rect, &window_rect );
+            mirror_rect( &rect, &client_rect );
+        }
+        break;
+    case COORDS_SCREEN:
+        for (; info.parent; info = parent)
+        {
+            if (!get_shm_window( wine_server_ptr_handle( info.parent ), &parent )) return FALSE;
+            if (!parent.parent) break;  /* desktop window */
+            OffsetRect( &window_rect, parent.client.left, parent.client.top );
+            OffsetRect( &client_rect, parent.client.left, parent.client.top );
+        }
+        break;
+    default:
+        return FALSE;
+    }
+    if (rectWindow) *rectWindow = window_rect;
+    if (rectClient) *rectClient = client_rect;
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           WIN_IsCurrentProcess
  *
@@ -692,6 +792,9 @@ HWND WIN_GetFullHandle( HWND hwnd )
     }
     else  /* may belong to another process */
     {
+        shmwindow_t info;
+
+        if (get_shm_window( hwnd, &info )) return wine_server_ptr_handle( info.handle );
         SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -898,6 +1001,8 @@ BOOL WIN_GetRectangles( HWND hwnd, enum coords_relative relative, RECT *rectWind
     }
 
 other_process:
+    if (get_shm_rectangles( hwnd, relative, rectWindow, rectClient )) return TRUE;
+
     SERVER_START_REQ( get_window_rectangles )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2220,11 +2325,15 @@ static LONG_PTR WIN_GetWindowLong( HWND hwnd, INT offset, UINT size, BOOL unicod
 
     if (wndPtr == WND_OTHER_PROCESS || wndPtr == WND_DESKTOP)
     {
+        shmwindow_t info;
+
         if (offset == GWLP_WNDPROC)
         {
             SetLastError( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if ((offset == GWL_STYLE || offset == GWL_EXSTYLE) && get_shm_window( hwnd, &info ))
+            return offset == GWL_STYLE ? info.style : info.ex_style;
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -2839,6 +2948,7 @@ DWORD WINAPI GetWindowThreadProcessId( HWND hwnd, LPDWORD process )
 {
     WND *ptr;
     DWORD tid = 0;
+    shmwindow_t info;
 
     if (!(ptr = WIN_GetPtr( hwnd )))
     {
@@ -2856,6 +2966,11 @@ DWORD WINAPI GetWindowThreadProcessId( HWND hwnd, LPDWORD process )
     }
 
     /* check other processes */
+    if (get_shm_window( hwnd, &info ))
+    {
+        if (process) *process = info.pid;
+        return info.tid;
+    }
     SERVER_START_REQ( get_window_info )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2886,20 +3001,24 @@ HWND WINAPI GetParent( HWND hwnd )
     if (wndPtr == WND_DESKTOP) return 0;
     if (wndPtr == WND_OTHER_PROCESS)
     {
-        LONG style = GetWindowLongW( hwnd, GWL_STYLE );
-        if (style & (WS_POPUP | WS_CHILD))
+        shmwindow_t info;
+
+        if (get_shm_window( hwnd, &info ))
         {
-            SERVER_START_REQ( get_window_tree )
+            if (info.style & WS_POPUP) retvalue = wine_server_ptr_handle( info.owner );
+            else if (info.style & WS_CHILD) retvalue = wine_server_ptr_handle( info.parent );
+            return retvalue;
+        }
+        SERVER_START_REQ( get_window_tree )
+        {
+            req->handle = wine_server_user_handle( hwnd );
+            if (!wine_server_call_err( req ))
             {
-                req->handle = wine_server_user_handle( hwnd );
-                if (!wine_server_call_err( req ))
-                {
-                    if (style & WS_POPUP) retvalue = wine_server_ptr_handle( reply->owner );
-                    else if (style & WS_CHILD) retvalue = wine_server_ptr_handle( reply->parent );
-                }
+                if (reply->style & WS_POPUP) retvalue = wine_server_ptr_handle( reply->owner );
+                else if (reply->style & WS_CHILD) retvalue = wine_server_ptr_handle( reply->parent );
             }
-            SERVER_END_REQ;
         }
+        SERVER_END_REQ;
     }
     else
     {
@@ -3088,8 +3207,40 @@ BOOL WINAPI IsWindowVisible( HWND hwnd )
 {
     HWND *list;
     BOOL retval = TRUE;
+    WND *win;
     int i;
 
+    if ((win = WIN_GetPtr( hwnd )) == WND_OTHER_PROCESS)
+    {
+        shmwindow_t info;
+
+        if (get_shm_window( hwnd, &info ))
+        {
+            HWND parent;
+
+            /* same as the local case below */
+            if (!(info.style & WS_VISIBLE)) return FALSE;
+            if (!info.parent) return TRUE;
+            for (;;)
+            {
+                parent = wine_server_ptr_handle( info.parent );
+                if (!get_shm_window( parent, &info )) break;
+                if (!info.parent) return parent == GetDesktopWindow();  /* top message window isn't visible */
+                if (!(info.style & WS_VISIBLE)) return FALSE;
+            }
+        }
+
+        /* let the server walk the parents instead of querying each of them */
+        SERVER_START_REQ( get_window_info )
+        {
+            req->handle = wine_server_user_handle( hwnd );
+            retval = !wine_server_call_err( req ) && reply->is_visible;
+        }
+        SERVER_END_REQ;
+        return retval;
+    }
+    if (win && win != WND_DESKTOP) WIN_ReleasePtr( win );
+
     if (!(GetWindowLongW( hwnd, GWL_STYLE ) & WS_VISIBLE)) return FALSE;
     if (!(list = list_window_parents( hwnd ))) return TRUE;
     if (list[0])
@@ -443,10 +443,91 @@ static HRESULT compile_member_expression(compile_ctx_t *ctx, member_expression_t
     return hres;
 }
 
+static BOOL eval_const_expression(expression_t *expr, VARIANT *ret)
+{
+    VARIANT l, r;
+    HRESULT hres;
+
+    switch(expr->type) {
+    case EXPR_USHORT:
+        V_VT(ret) = VT_I2;
+        V_I2(ret) = ((int_expression_t*)expr)->value;
+        return TRUE;
+    case EXPR_ULONG:
+        V_VT(ret) = VT_I4;
+        V_I4(ret) = ((int_expression_t*)expr)->value;
+        return TRUE;
+    case EXPR_DOUBLE:
+        V_VT(ret) = VT_R8;
+        V_R8(ret) = ((double_expression_t*)expr)->value;
+        return TRUE;
+    case EXPR_BRACKETS:
+        return eval_const_expression(((unary_expression_t*)expr)->subexpr, ret);
+    case EXPR_NEG:
+        if(!eval_const_expression(((unary_expression_t*)expr)->subexpr, &l))
+            return FALSE;
+        hres = VarNeg(&l, ret);
+        break;
+    case EXPR_ADD:
+    case EXPR_SUB:
+    case EXPR_MUL:
+    case EXPR_DIV:
+        if(!eval_const_expression(((binary_expression_t*)expr)->left, &l)
+           || !eval_const_expression(((binary_expression_t*)expr)->right, &r))
+            return FALSE;
+
+        switch(expr->type) {
+        case EXPR_ADD:
+            hres = VarAdd(&l, &r, ret);
+            break;
+        case EXPR_SUB:
+            hres = VarSub(&l, &r, ret);
+            break;
+        case EXPR_MUL:
+            hres = VarMul(&l, &r, ret);
+            break;
+        default:
+            hres = VarDiv(&l, &r, ret);
+        }
+        break;
+    default:
+        return FALSE;
+    }
+
+    /* Errors such as division by zero are left to be reported at run time. */
+    return SUCCEEDED(hres) && (V_VT(ret) == VT_I2 || V_VT(ret) == VT_I4 || V_VT(ret) == VT_R8);
+}
+
+/* Returns S_FALSE if expr is not an arithmetic expression on numeric literals. */
+static HRESULT compile_const_expression(compile_ctx_t *ctx, expression_t *expr)
+{
+    VARIANT v;
+
+    if(!eval_const_expression(expr, &v))
+        return S_FALSE;
+
+    TRACE("folded to %s\n", debugstr_variant(&v));
+
+    switch(V_VT(&v)) {
+    case VT_I2:
+        return push_instr_int(ctx, OP_short, V_I2(&v));
+    case VT_I4:
+        return push_instr_int(ctx, OP_long, V_I4(&v));
+    default:
+        return push_instr_double(ctx, OP_double, V_R8(&v));
+    }
+}
+
 static HRESULT compile_unary_expression(compile_ctx_t *ctx, unary_expression_t *expr, vbsop_t op)
 {
     HRESULT hres;
 
+    if(op == OP_neg) {
+        hres = compile_const_expression(ctx, &expr->expr);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     hres = compile_expression(ctx, expr->subexpr);
     if(FAILED(hres))
         return hres;
@@ -458,6 +539,12 @@ static HRESULT compile_binary_expression(compile_ctx_t *ctx, binary_expression_t
 {
     HRESULT hres;
 
+    if(op == OP_add || op == OP_sub || op == OP_mul || op == OP_div) {
+        hres = compile_const_expression(ctx, &expr->expr);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     hres = compile_expression(ctx, expr->left);
     if(FAILED(hres))
         return hres;
@@ -1302,6 +1389,78 @@ static void resolve_labels(compile_ctx_t *ctx, unsigned off)
     ctx->labels_cnt = 0;
 }
 
+/* Make jumps that land on an unconditional jump go straight to its target. */
+static void thread_jumps(compile_ctx_t *ctx, unsigned off)
+{
+    instr_t *instr;
+    unsigned addr, i;
+
+    for(instr = ctx->code->instrs+off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        if(instr->op != OP_jmp && instr->op != OP_jmp_false && instr->op != OP_jmp_true)
+            continue;
+
+        addr = instr->arg1.uint;
+        for(i = 0; i < 16 && ctx->code->instrs[addr].op == OP_jmp; i++)
+            addr = ctx->code->instrs[addr].arg1.uint;
+        instr->arg1.uint = addr;
+    }
+}
+
+static BOOL lookup_local_slot(function_t *func, const WCHAR *name, unsigned *ret)
+{
+    unsigned i;
+
+    for(i = 0; i < func->var_cnt; i++) {
+        if(!strcmpiW(func->vars[i].name, name)) {
+            *ret = i;
+            return TRUE;
+        }
+    }
+
+    for(i = 0; i < func->arg_cnt; i++) {
+        if(!strcmpiW(func->args[i].name, name)) {
+            *ret = func->var_cnt + i;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+ * Once the body of a procedure is compiled, all its local variables are
+ * known, so plain reads and assignments of locals and arguments can be bound
+ * to their slots instead of looking them up by name on each execution.
+ */
+static void bind_local_vars(compile_ctx_t *ctx, function_t *func)
+{
+    instr_t *instr;
+    unsigned slot;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+            if(instr->arg2.uint || !lookup_local_slot(func, instr->arg1.bstr, &slot))
+                continue;
+            instr->op = OP_local;
+            break;
+        case OP_assign_ident:
+            /* assignments to the function name set its return value */
+            if(instr->arg2.uint || ((func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET
+                    || func->type == FUNC_DEFGET) && !strcmpiW(instr->arg1.bstr, func->name))
+               || !lookup_local_slot(func, instr->arg1.bstr, &slot))
+                continue;
+            instr->op = OP_assign_local;
+            break;
+        default:
+            continue;
+        }
+
+        instr->arg1.uint = slot;
+        instr->arg2.uint = 0;
+    }
+}
+
 static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_desc_t *array_desc)
 {
     unsigned dim_cnt = 0, i;
@@ -1417,6 +1576,10 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         }
     }
 
+    if(func->type != FUNC_GLOBAL)
+        bind_local_vars(ctx, func);
+    thread_jumps(ctx, func->code_off);
+
     if(func->array_cnt) {
         unsigned array_id = 0;
         dim_decl_t *dim_decl;
@@ -642,6 +642,26 @@ static HRESULT interp_icallv(exec_ctx_t *ctx)
     return do_icall(ctx, NULL);
 }
 
+static inline VARIANT *get_local_var(exec_ctx_t *ctx, unsigned slot)
+{
+    VARIANT *v;
+
+    v = slot < ctx->func->var_cnt ? ctx->vars+slot : ctx->args+slot-ctx->func->var_cnt;
+    return V_VT(v) == (VT_VARIANT|VT_BYREF) ? V_VARIANTREF(v) : v;
+}
+
+static HRESULT interp_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    VARIANT v;
+
+    TRACE("%u\n", slot);
+
+    V_VT(&v) = VT_BYREF|VT_VARIANT;
+    V_BYREF(&v) = get_local_var(ctx, slot);
+    return stack_push(ctx, &v);
+}
+
 static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
 {
     const BSTR identifier = ctx->instr->arg1.bstr;
@@ -820,6 +840,28 @@ static HRESULT interp_assign_ident(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_assign_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    VARIANT *v;
+    HRESULT hres;
+
+    TRACE("%u\n", slot);
+
+    v = get_local_var(ctx, slot);
+    if(V_VT(v) == (VT_ARRAY|VT_BYREF|VT_VARIANT)) {
+        FIXME("non-array assign\n");
+        return E_NOTIMPL;
+    }
+
+    hres = assign_value(ctx, v, stack_top(ctx, 0), DISPATCH_PROPERTYPUT);
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, 1);
+    return S_OK;
+}
+
 static HRESULT interp_set_ident(exec_ctx_t *ctx)
 {
     const BSTR arg = ctx->instr->arg1.bstr;
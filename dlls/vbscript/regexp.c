@@ -2532,6 +2532,32 @@ SimpleMatch(REGlobalData *gData, match_state_t *x, REOp op,
     return NULL;
 }
 
+/*
+ * If the program starts with a case sensitive literal, return its first
+ * character so that candidate match positions can be located with memchrW
+ * instead of running SimpleMatch at every position of the input.
+ */
+static BOOL
+GetFirstChar(regexp_t *re, REOp op, jsbytecode *pc, WCHAR *ret)
+{
+    size_t offset;
+
+    switch (op) {
+      case REOP_FLAT:
+        ReadCompactIndex(pc, &offset);
+        *ret = re->source[offset];
+        return TRUE;
+      case REOP_FLAT1:
+        *ret = *pc;
+        return TRUE;
+      case REOP_UCFLAT1:
+        *ret = GET_ARG(pc);
+        return TRUE;
+      default:
+        return FALSE;
+    }
+}
+
 static inline match_state_t *
 ExecuteREBytecode(REGlobalData *gData, match_state_t *x)
 {
@@ -2548,7 +2574,8 @@ ExecuteREBytecode(REGlobalData *gData, match_state_t *x)
     WCHAR matchCh1, matchCh2;
     RECharSet *charSet;
 
-    BOOL anchor;
+    BOOL anchor, prefilter;
+    WCHAR firstCh;
     jsbytecode *pc = gData->regexp->program;
     REOp op = (REOp) *pc++;
 
@@ -2558,7 +2585,15 @@ ExecuteREBytecode(REGlobalData *gData, match_state_t *x)
      */
     if (REOP_IS_SIMPLE(op) && !(gData->regexp->flags & REG_STICKY)) {
         anchor = FALSE;
+        prefilter = GetFirstChar(gData->regexp, op, pc, &firstCh);
         while (x->cp <= gData->cpend) {
+            if (prefilter) {
+                const WCHAR *next = memchrW(x->cp, firstCh, gData->cpend - x->cp);
+                if (!next)
+                    break;
+                gData->skipped += next - x->cp;
+                x->cp = next;
+            }
             nextpc = pc;    /* reset back to start each time */
             result = SimpleMatch(gData, x, op, &nextpc, TRUE);
             if (result) {
@@ -83,6 +83,36 @@ static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
+/* Expands 24bpp pixels read at the start of each row of a 32bpp buffer, from
+ * the end of the row so that no temporary buffer is needed. */
+static void expand_24bpp_to_32bppBGRA(BYTE *bits, UINT width, UINT height, UINT stride, BOOL rgb)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++)
+    {
+        const BYTE *srcpixel = bits + stride * y + 3 * width;
+        DWORD *dstpixel = (DWORD *)(bits + stride * y) + width;
+
+        if (rgb)
+        {
+            for (x=0; x<width; x++)
+            {
+                srcpixel -= 3;
+                *--dstpixel = 0xff000000 | (srcpixel[0] << 16) | (srcpixel[1] << 8) | srcpixel[2];
+            }
+        }
+        else
+        {
+            for (x=0; x<width; x++)
+            {
+                srcpixel -= 3;
+                *--dstpixel = 0xff000000 | (srcpixel[2] << 16) | (srcpixel[1] << 8) | srcpixel[0];
+            }
+        }
+    }
+}
+
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -561,92 +591,18 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         }
         return S_OK;
     case format_24bppBGR:
-        if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
-        return S_OK;
     case format_24bppRGB:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            if (cbStride < 4 * prc->Width)
+                return E_INVALIDARG;
 
+            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
+                expand_24bpp_to_32bppBGRA(pbBuffer, prc->Width, prc->Height, cbStride,
+                    source_format == format_24bppRGB);
 
             return res;
         }
@@ -675,21 +631,31 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         {
             HRESULT res;
             INT x, y;
+            UINT recip[256];
+            BYTE *pixel;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
+            /* c * recip[alpha] >> 16 equals c * 255 / alpha for every byte
+             * value, and avoids three divisions per pixel */
+            for (x=1; x<256; x++)
+                recip[x] = (255 * 65536 + x - 1) / x;
+
             for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
+            {
+                pixel = pbBuffer + cbStride * y;
+                for (x=0; x<prc->Width; x++, pixel += 4)
                 {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
+                    BYTE alpha = pixel[3];
                     if (alpha != 0 && alpha != 255)
                     {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
+                        pixel[0] = pixel[0] * recip[alpha] >> 16;
+                        pixel[1] = pixel[1] * recip[alpha] >> 16;
+                        pixel[2] = pixel[2] * recip[alpha] >> 16;
                     }
                 }
+            }
         }
         return S_OK;
     case format_48bppRGB:
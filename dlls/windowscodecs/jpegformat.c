@@ -62,6 +62,7 @@ WINE_DECLARE_DEBUG_CHANNEL(jpeg);
 static void *libjpeg_handle;
 
 #define MAKE_FUNCPTR(f) static typeof(f) * p##f
+MAKE_FUNCPTR(jpeg_abort_decompress);
 MAKE_FUNCPTR(jpeg_CreateCompress);
 MAKE_FUNCPTR(jpeg_CreateDecompress);
 MAKE_FUNCPTR(jpeg_destroy_compress);
@@ -87,6 +88,7 @@ static void *load_libjpeg(void)
         return NULL; \
     }
 
+        LOAD_FUNCPTR(jpeg_abort_decompress);
         LOAD_FUNCPTR(jpeg_CreateCompress);
         LOAD_FUNCPTR(jpeg_CreateDecompress);
         LOAD_FUNCPTR(jpeg_destroy_compress);
@@ -148,7 +150,9 @@ typedef struct {
     struct jpeg_error_mgr jerr;
     struct jpeg_source_mgr source_mgr;
     BYTE source_buffer[1024];
-    BYTE *image_data;
+    BYTE *image_data;      /* decoded rows from first_row to cinfo.output_scanline */
+    UINT first_row;
+    UINT image_data_rows;  /* number of rows image_data can hold */
     CRITICAL_SECTION lock;
 } JpegDecoder;
 
@@ -284,11 +288,69 @@ static void source_mgr_term_source(j_decompress_ptr cinfo)
 {
 }
 
+/* Reads the header from the current stream position and starts decompressing
+ * the image, must be called with the lock held and cinfo.client_data set. */
+static HRESULT start_decompress(JpegDecoder *This)
+{
+    int ret;
+
+    ret = pjpeg_read_header(&This->cinfo, TRUE);
+
+    if (ret != JPEG_HEADER_OK) {
+        WARN("Jpeg image in stream has bad format, read header returned %d.\n",ret);
+        return E_FAIL;
+    }
+
+    switch (This->cinfo.jpeg_color_space)
+    {
+    case JCS_GRAYSCALE:
+        This->cinfo.out_color_space = JCS_GRAYSCALE;
+        break;
+    case JCS_RGB:
+    case JCS_YCbCr:
+        This->cinfo.out_color_space = JCS_RGB;
+        break;
+    case JCS_CMYK:
+    case JCS_YCCK:
+        This->cinfo.out_color_space = JCS_CMYK;
+        break;
+    default:
+        ERR("Unknown JPEG color space %i\n", This->cinfo.jpeg_color_space);
+        return E_FAIL;
+    }
+
+    if (!pjpeg_start_decompress(&This->cinfo))
+    {
+        ERR("jpeg_start_decompress failed\n");
+        return E_FAIL;
+    }
+
+    return S_OK;
+}
+
+/* Decompresses the image again from the start of the stream. */
+static HRESULT restart_decompress(JpegDecoder *This)
+{
+    LARGE_INTEGER seek;
+    HRESULT hr;
+
+    pjpeg_abort_decompress(&This->cinfo);
+
+    seek.QuadPart = 0;
+    hr = IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+    if (FAILED(hr)) return hr;
+
+    This->source_mgr.bytes_in_buffer = 0;
+    This->first_row = 0;
+
+    return start_decompress(This);
+}
+
 static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *pIStream,
     WICDecodeOptions cacheOptions)
 {
     JpegDecoder *This = impl_from_IWICBitmapDecoder(iface);
-    int ret;
+    HRESULT hr;
     LARGE_INTEGER seek;
     jmp_buf jmpbuf;
     TRACE("(%p,%p,%u)\n", iface, pIStream, cacheOptions);
@@ -335,45 +397,14 @@ static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *
 
     This->cinfo.src = &This->source_mgr;
 
-    ret = pjpeg_read_header(&This->cinfo, TRUE);
+    hr = start_decompress(This);
 
-    if (ret != JPEG_HEADER_OK) {
-        WARN("Jpeg image in stream has bad format, read header returned %d.\n",ret);
-        LeaveCriticalSection(&This->lock);
-        return E_FAIL;
-    }
-
-    switch (This->cinfo.jpeg_color_space)
-    {
-    case JCS_GRAYSCALE:
-        This->cinfo.out_color_space = JCS_GRAYSCALE;
-        break;
-    case JCS_RGB:
-    case JCS_YCbCr:
-        This->cinfo.out_color_space = JCS_RGB;
-        break;
-    case JCS_CMYK:
-    case JCS_YCCK:
-        This->cinfo.out_color_space = JCS_CMYK;
-        break;
-    default:
-        ERR("Unknown JPEG color space %i\n", This->cinfo.jpeg_color_space);
-        LeaveCriticalSection(&This->lock);
-        return E_FAIL;
-    }
-
-    if (!pjpeg_start_decompress(&This->cinfo))
-    {
-        ERR("jpeg_start_decompress failed\n");
-        LeaveCriticalSection(&This->lock);
-        return E_FAIL;
-    }
-
-    This->initialized = TRUE;
+    if (SUCCEEDED(hr))
+        This->initialized = TRUE;
 
     LeaveCriticalSection(&This->lock);
 
-    return S_OK;
+    return hr;
 }
 
 static HRESULT WINAPI JpegDecoder_GetContainerFormat(IWICBitmapDecoder *iface,
@@ -587,10 +618,11 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
     UINT bpp;
     UINT stride;
-    UINT data_size;
     UINT max_row_needed;
+    UINT rows_needed;
     jmp_buf jmpbuf;
     WICRect rect;
+    HRESULT hr;
     TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
     if (!prc)
@@ -599,43 +631,75 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
         rect.Y = 0;
         rect.Width = This->cinfo.output_width;
         rect.Height = This->cinfo.output_height;
-        prc = &rect;
     }
     else
     {
         if (prc->X < 0 || prc->Y < 0 || prc->X+prc->Width > This->cinfo.output_width ||
             prc->Y+prc->Height > This->cinfo.output_height)
             return E_INVALIDARG;
+        rect = *prc;
     }
 
     if (This->cinfo.out_color_space == JCS_GRAYSCALE) bpp = 8;
     else if (This->cinfo.out_color_space == JCS_CMYK) bpp = 32;
     else bpp = 24;
 
-    stride = bpp * This->cinfo.output_width;
-    data_size = stride * This->cinfo.output_height;
+    stride = bpp / 8 * This->cinfo.output_width;
 
-    max_row_needed = prc->Y + prc->Height;
+    max_row_needed = rect.Y + rect.Height;
     if (max_row_needed > This->cinfo.output_height) return E_INVALIDARG;
 
     EnterCriticalSection(&This->lock);
 
-    if (!This->image_data)
+    This->cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+    {
+        LeaveCriticalSection(&This->lock);
+        return E_FAIL;
+    }
+
+    /* Only the rows from the top of the last rectangle are kept, so that reading
+     * the image from top to bottom needs memory for one rectangle at a time.
+     * Going back up means decompressing the image again. */
+    if (rect.Y < This->first_row)
     {
-        This->image_data = HeapAlloc(GetProcessHeap(), 0, data_size);
-        if (!This->image_data)
+        hr = restart_decompress(This);
+        if (FAILED(hr))
         {
             LeaveCriticalSection(&This->lock);
-            return E_OUTOFMEMORY;
+            return hr;
         }
     }
+    else if (rect.Y > This->first_row)
+    {
+        UINT skip = min(rect.Y, This->cinfo.output_scanline) - This->first_row;
 
-    This->cinfo.client_data = jmpbuf;
+        if (skip)
+            memmove(This->image_data, This->image_data + stride * skip,
+                stride * (This->cinfo.output_scanline - This->first_row - skip));
+        This->first_row += skip;
+    }
 
-    if (setjmp(jmpbuf))
+    /* Rows are decoded in batches of up to four, and only the last batch
+     * that starts above the rectangle is kept. */
+    rows_needed = max_row_needed - max(This->first_row, rect.Y > 3 ? (UINT)rect.Y - 3 : 0);
+    rows_needed = max(rows_needed, 4);
+    if (rows_needed > This->image_data_rows)
     {
-        LeaveCriticalSection(&This->lock);
-        return E_FAIL;
+        BYTE *image_data;
+
+        if (This->image_data)
+            image_data = HeapReAlloc(GetProcessHeap(), 0, This->image_data, stride * rows_needed);
+        else
+            image_data = HeapAlloc(GetProcessHeap(), 0, stride * rows_needed);
+        if (!image_data)
+        {
+            LeaveCriticalSection(&This->lock);
+            return E_OUTOFMEMORY;
+        }
+        This->image_data = image_data;
+        This->image_data_rows = rows_needed;
     }
 
     while (max_row_needed > This->cinfo.output_scanline)
@@ -643,12 +707,18 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
         UINT first_scanline = This->cinfo.output_scanline;
         UINT max_rows;
         JSAMPROW out_rows[4];
+        BYTE *first_data;
         UINT i;
         JDIMENSION ret;
 
-        max_rows = min(This->cinfo.output_height-first_scanline, 4);
+        /* the rows above the rectangle are decoded and dropped */
+        if (first_scanline < rect.Y)
+            This->first_row = first_scanline;
+        first_data = This->image_data + stride * (first_scanline - This->first_row);
+
+        max_rows = min(max_row_needed-first_scanline, 4);
         for (i=0; i<max_rows; i++)
-            out_rows[i] = This->image_data + stride * (first_scanline+i);
+            out_rows[i] = first_data + stride * i;
 
         ret = pjpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
 
@@ -662,22 +732,25 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
         if (bpp == 24)
         {
             /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
-            reverse_bgr8(3, This->image_data + stride * first_scanline,
+            reverse_bgr8(3, first_data,
                 This->cinfo.output_width, This->cinfo.output_scanline - first_scanline,
                 stride);
         }
 
         if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
             /* Adobe JPEG's have inverted CMYK data. */
-            for (i=0; i<data_size; i++)
-                This->image_data[i] ^= 0xff;
+            for (i=0; i<stride * (This->cinfo.output_scanline - first_scanline); i++)
+                first_data[i] ^= 0xff;
     }
 
+    rect.Y -= This->first_row;
+    hr = copy_pixels(bpp, This->image_data,
+        This->cinfo.output_width, This->cinfo.output_scanline - This->first_row, stride,
+        &rect, cbStride, cbBufferSize, pbBuffer);
+
     LeaveCriticalSection(&This->lock);
 
-    return copy_pixels(bpp, This->image_data,
-        This->cinfo.output_width, This->cinfo.output_height, stride,
-        prc, cbStride, cbBufferSize, pbBuffer);
+    return hr;
 }
 
 static HRESULT WINAPI JpegDecoder_Frame_GetMetadataQueryReader(IWICBitmapFrameDecode *iface,
@@ -740,6 +813,8 @@ HRESULT JpegDecoder_CreateInstance(REFIID iid, void** ppv)
     This->cinfo_initialized = FALSE;
     This->stream = NULL;
     This->image_data = NULL;
+    This->first_row = 0;
+    This->image_data_rows = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": JpegDecoder.lock");
 
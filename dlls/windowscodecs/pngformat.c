@@ -262,6 +262,7 @@ MAKE_FUNCPTR(png_set_write_fn);
 MAKE_FUNCPTR(png_read_end);
 MAKE_FUNCPTR(png_read_image);
 MAKE_FUNCPTR(png_read_info);
+MAKE_FUNCPTR(png_read_row);
 MAKE_FUNCPTR(png_write_end);
 MAKE_FUNCPTR(png_write_info);
 MAKE_FUNCPTR(png_write_rows);
@@ -327,6 +328,7 @@ static void *load_libpng(void)
         LOAD_FUNCPTR(png_read_end);
         LOAD_FUNCPTR(png_read_image);
         LOAD_FUNCPTR(png_read_info);
+        LOAD_FUNCPTR(png_read_row);
         LOAD_FUNCPTR(png_write_end);
         LOAD_FUNCPTR(png_write_info);
         LOAD_FUNCPTR(png_write_rows);
@@ -378,6 +380,9 @@ typedef struct {
     UINT stride;
     const WICPixelFormatGUID *format;
     BYTE *image_bits;
+    UINT rows_read;        /* rows of image_bits decoded so far */
+    BOOL read_failed;
+    ULARGE_INTEGER read_pos; /* stream position where libpng continues reading */
     CRITICAL_SECTION lock; /* must be held when png structures are accessed or initialized is set */
     ULONG metadata_count;
     metadata_block_info* metadata_blocks;
@@ -666,7 +671,7 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     /* read the image data */
     This->width = ppng_get_image_width(This->png_ptr, This->info_ptr);
     This->height = ppng_get_image_height(This->png_ptr, This->info_ptr);
-    This->stride = This->width * This->bpp;
+    This->stride = (This->width * This->bpp + 7) / 8;
     image_size = This->stride * This->height;
 
     This->image_bits = HeapAlloc(GetProcessHeap(), 0, image_size);
@@ -676,22 +681,35 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
         goto end;
     }
 
-    row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
-    if (!row_pointers)
+    if (ppng_set_interlace_handling(This->png_ptr) > 1)
     {
-        hr = E_OUTOFMEMORY;
-        goto end;
-    }
+        /* every pass of an interlaced image covers all the rows */
+        row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
+        if (!row_pointers)
+        {
+            hr = E_OUTOFMEMORY;
+            goto end;
+        }
 
-    for (i=0; i<This->height; i++)
-        row_pointers[i] = This->image_bits + i * This->stride;
+        for (i=0; i<This->height; i++)
+            row_pointers[i] = This->image_bits + i * This->stride;
 
-    ppng_read_image(This->png_ptr, row_pointers);
+        ppng_read_image(This->png_ptr, row_pointers);
 
-    HeapFree(GetProcessHeap(), 0, row_pointers);
-    row_pointers = NULL;
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        row_pointers = NULL;
 
-    ppng_read_end(This->png_ptr, This->end_info);
+        ppng_read_end(This->png_ptr, This->end_info);
+        This->rows_read = This->height;
+    }
+    else
+    {
+        /* other images are decoded as CopyPixels needs their rows, continuing
+         * from here since the metadata readers also use the stream */
+        seek.QuadPart = 0;
+        hr = IStream_Seek(pIStream, seek, STREAM_SEEK_CUR, &This->read_pos);
+        if (FAILED(hr)) goto end;
+    }
 
     /* Find the metadata chunks in the file. */
     seek.QuadPart = 8;
@@ -1006,12 +1024,64 @@ end:
     return hr;
 }
 
+/* Decodes the rows of a non-interlaced image up to max_row, must be called with the lock held. */
+static HRESULT read_rows(PngDecoder *This, UINT max_row)
+{
+    LARGE_INTEGER seek;
+    jmp_buf jmpbuf;
+    HRESULT hr;
+
+    if (This->read_failed) return E_FAIL;
+    if (This->rows_read >= max_row) return S_OK;
+
+    if (setjmp(jmpbuf))
+    {
+        This->read_failed = TRUE;
+        return E_FAIL;
+    }
+    ppng_set_error_fn(This->png_ptr, jmpbuf, user_error_fn, user_warning_fn);
+
+    seek.QuadPart = This->read_pos.QuadPart;
+    hr = IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+    if (FAILED(hr)) return hr;
+
+    while (This->rows_read < max_row)
+    {
+        ppng_read_row(This->png_ptr, This->image_bits + This->rows_read * This->stride, NULL);
+        This->rows_read++;
+    }
+
+    if (This->rows_read == This->height)
+        ppng_read_end(This->png_ptr, This->end_info);
+
+    seek.QuadPart = 0;
+    return IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, &This->read_pos);
+}
+
 static HRESULT WINAPI PngDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     PngDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    UINT max_row_needed;
+    HRESULT hr;
     TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
+    if (!prc)
+        max_row_needed = This->height;
+    else
+    {
+        if (prc->X < 0 || prc->Y < 0 || prc->X+prc->Width > This->width ||
+            prc->Y+prc->Height > This->height)
+            return E_INVALIDARG;
+        max_row_needed = prc->Y + prc->Height;
+    }
+
+    EnterCriticalSection(&This->lock);
+    hr = read_rows(This, max_row_needed);
+    LeaveCriticalSection(&This->lock);
+
+    if (FAILED(hr)) return hr;
+
     return copy_pixels(This->bpp, This->image_bits,
         This->width, This->height, This->stride,
         prc, cbStride, cbBufferSize, pbBuffer);
@@ -1222,6 +1292,8 @@ HRESULT PngDecoder_CreateInstance(REFIID iid, void** ppv)
     This->stream = NULL;
     This->initialized = FALSE;
     This->image_bits = NULL;
+    This->rows_read = 0;
+    This->read_failed = FALSE;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": PngDecoder.lock");
     This->metadata_count = 0;
@@ -33,6 +33,13 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Source pixels used for a destination column by the filtering modes. */
+typedef struct ScalerColumn {
+    UINT offset[4];  /* byte offsets in the source rows */
+    INT weight[4];   /* in 1/256, unused by Fant */
+    UINT count;      /* number of pixels from offset[0], only used by Fant */
+} ScalerColumn;
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -43,6 +50,8 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    void (*fn_init_columns)(struct BitmapScaler*,UINT,UINT,UINT,ScalerColumn*);
+    ScalerColumn *columns; /* for the destination rectangle being copied */
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -191,6 +200,232 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+/* Maps the center of a destination pixel to the source, in 1/256 pixels. */
+static UINT get_src_position(UINT dst, UINT dst_size, UINT src_size)
+{
+    LONGLONG pos = ((LONGLONG)(2 * dst + 1) * src_size - dst_size) * 256 / (2 * (LONGLONG)dst_size);
+
+    if (pos < 0) return 0;
+    if (pos > (LONGLONG)(src_size - 1) * 256) return (src_size - 1) * 256;
+    return pos;
+}
+
+static void Linear_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    UINT pos_x = get_src_position(x, This->width, This->src_width);
+    UINT pos_y = get_src_position(y, This->height, This->src_height);
+
+    src_rect->X = pos_x >> 8;
+    src_rect->Y = pos_y >> 8;
+    src_rect->Width = (pos_x & 0xff) ? 2 : 1;
+    src_rect->Height = (pos_y & 0xff) ? 2 : 1;
+}
+
+static void Linear_InitColumns(BitmapScaler *This,
+    UINT dst_x, UINT dst_width, UINT src_data_x, ScalerColumn *columns)
+{
+    UINT i;
+    UINT bytesperpixel = This->bpp/8;
+
+    for (i=0; i<dst_width; i++)
+    {
+        UINT pos_x = get_src_position(dst_x + i, This->width, This->src_width);
+        UINT fx = pos_x & 0xff;
+
+        columns[i].offset[0] = ((pos_x >> 8) - src_data_x) * bytesperpixel;
+        columns[i].offset[1] = fx ? columns[i].offset[0] + bytesperpixel : columns[i].offset[0];
+        columns[i].weight[0] = 256 - fx;
+        columns[i].weight[1] = fx;
+    }
+}
+
+static void Linear_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    UINT i, c;
+    UINT bytesperpixel = This->bpp/8;
+    UINT pos_y = get_src_position(dst_y, This->height, This->src_height);
+    UINT fy = pos_y & 0xff;
+    const BYTE *row0 = src_data[(pos_y >> 8) - src_data_y];
+    const BYTE *row1 = fy ? src_data[(pos_y >> 8) + 1 - src_data_y] : row0;
+
+    for (i=0; i<dst_width; i++)
+    {
+        const ScalerColumn *column = &This->columns[i];
+        UINT x0 = column->offset[0], x1 = column->offset[1];
+        UINT w0 = column->weight[0], w1 = column->weight[1];
+
+        for (c=0; c<bytesperpixel; c++)
+        {
+            UINT top = row0[x0 + c] * w0 + row0[x1 + c] * w1;
+            UINT bottom = row1[x0 + c] * w0 + row1[x1 + c] * w1;
+            *pbBuffer++ = (top * (256 - fy) + bottom * fy + 32768) >> 16;
+        }
+    }
+}
+
+/* Catmull-Rom weights for the source pixels at -1, 0, 1 and 2, in 1/256. */
+static void get_cubic_weights(UINT t, INT *weights)
+{
+    INT t2 = t * t, t3 = t2 * t;
+
+    weights[0] = (-t3 + 512 * t2 - 65536 * (INT)t) / 131072;
+    weights[1] = (3 * t3 - 1280 * t2 + 33554432) / 131072;
+    weights[2] = (-3 * t3 + 1024 * t2 + 65536 * (INT)t) / 131072;
+    weights[3] = 256 - weights[0] - weights[1] - weights[2];
+}
+
+static void Cubic_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    UINT x0 = get_src_position(x, This->width, This->src_width) >> 8;
+    UINT y0 = get_src_position(y, This->height, This->src_height) >> 8;
+
+    src_rect->X = x0 ? x0 - 1 : 0;
+    src_rect->Y = y0 ? y0 - 1 : 0;
+    src_rect->Width = min(x0 + 2, This->src_width - 1) - src_rect->X + 1;
+    src_rect->Height = min(y0 + 2, This->src_height - 1) - src_rect->Y + 1;
+}
+
+static void Cubic_InitColumns(BitmapScaler *This,
+    UINT dst_x, UINT dst_width, UINT src_data_x, ScalerColumn *columns)
+{
+    UINT i, k;
+    UINT bytesperpixel = This->bpp/8;
+
+    for (i=0; i<dst_width; i++)
+    {
+        UINT pos_x = get_src_position(dst_x + i, This->width, This->src_width);
+
+        get_cubic_weights(pos_x & 0xff, columns[i].weight);
+        for (k=0; k<4; k++)
+        {
+            INT x = (INT)(pos_x >> 8) + k - 1;
+            x = max(0, min(x, (INT)This->src_width - 1));
+            columns[i].offset[k] = (x - src_data_x) * bytesperpixel;
+        }
+    }
+}
+
+static void Cubic_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    UINT i, j, k, c;
+    UINT bytesperpixel = This->bpp/8;
+    UINT pos_y = get_src_position(dst_y, This->height, This->src_height);
+    const BYTE *rows[4];
+    INT wy[4];
+
+    get_cubic_weights(pos_y & 0xff, wy);
+    for (j=0; j<4; j++)
+    {
+        INT y = (INT)(pos_y >> 8) + j - 1;
+        y = max(0, min(y, (INT)This->src_height - 1));
+        rows[j] = src_data[y - src_data_y];
+    }
+
+    for (i=0; i<dst_width; i++)
+    {
+        const ScalerColumn *column = &This->columns[i];
+
+        for (c=0; c<bytesperpixel; c++)
+        {
+            INT value = 0;
+
+            for (j=0; j<4; j++)
+            {
+                INT row = 0;
+                for (k=0; k<4; k++)
+                    row += rows[j][column->offset[k] + c] * column->weight[k];
+                value += row * wy[j];
+            }
+
+            value = (value + 32768) >> 16;
+            *pbBuffer++ = max(0, min(value, 255));
+        }
+    }
+}
+
+/* Fant scaling averages all the source pixels covered by a destination pixel. */
+static void get_fant_range(UINT dst, UINT dst_size, UINT src_size, UINT *start, UINT *count)
+{
+    *start = (ULONGLONG)dst * src_size / dst_size;
+    *count = max(1, ((ULONGLONG)(dst + 1) * src_size + dst_size - 1) / dst_size - *start);
+}
+
+static void Fant_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    UINT src_x, src_y, width, height;
+
+    get_fant_range(x, This->width, This->src_width, &src_x, &width);
+    get_fant_range(y, This->height, This->src_height, &src_y, &height);
+    src_rect->X = src_x;
+    src_rect->Y = src_y;
+    src_rect->Width = width;
+    src_rect->Height = height;
+}
+
+static void Fant_InitColumns(BitmapScaler *This,
+    UINT dst_x, UINT dst_width, UINT src_data_x, ScalerColumn *columns)
+{
+    UINT i, start;
+    UINT bytesperpixel = This->bpp/8;
+
+    for (i=0; i<dst_width; i++)
+    {
+        get_fant_range(dst_x + i, This->width, This->src_width, &start, &columns[i].count);
+        columns[i].offset[0] = (start - src_data_x) * bytesperpixel;
+    }
+}
+
+static void Fant_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    UINT i, x, y, c;
+    UINT bytesperpixel = This->bpp/8;
+    UINT src_y, height;
+
+    get_fant_range(dst_y, This->height, This->src_height, &src_y, &height);
+
+    for (i=0; i<dst_width; i++)
+    {
+        const ScalerColumn *column = &This->columns[i];
+        ULONGLONG count = (ULONGLONG)column->count * height;
+
+        for (c=0; c<bytesperpixel; c++)
+        {
+            ULONGLONG sum = 0;
+
+            for (y=0; y<height; y++)
+            {
+                const BYTE *src = src_data[src_y + y - src_data_y] + column->offset[0] + c;
+                for (x=0; x<column->count; x++, src += bytesperpixel)
+                    sum += *src;
+            }
+
+            *pbBuffer++ = (sum + count / 2) / count;
+        }
+    }
+}
+
+/* The filtering modes interpolate each byte of a pixel separately. */
+static BOOL is_8bpc_format(const WICPixelFormatGUID *format)
+{
+    return IsEqualGUID(format, &GUID_WICPixelFormat8bppGray) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppRGB) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppRGBA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPRGBA);
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -282,6 +517,16 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
         buffer_size, src_bits);
 
+    if (SUCCEEDED(hr) && This->fn_init_columns)
+    {
+        /* the source columns are the same for every row */
+        This->columns = HeapAlloc(GetProcessHeap(), 0, sizeof(ScalerColumn) * dest_rect.Width);
+        if (This->columns)
+            This->fn_init_columns(This, dest_rect.X, dest_rect.Width, src_rect.X, This->columns);
+        else
+            hr = E_OUTOFMEMORY;
+    }
+
     if (SUCCEEDED(hr))
     {
         for (y=0; y < dest_rect.Height; y++)
@@ -291,6 +536,8 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         }
     }
 
+    HeapFree(GetProcessHeap(), 0, This->columns);
+    This->columns = NULL;
     HeapFree(GetProcessHeap(), 0, src_rows);
     HeapFree(GetProcessHeap(), 0, src_bits);
 
@@ -336,6 +583,39 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            if (is_8bpc_format(&src_pixelformat))
+            {
+                IWICBitmapSource_AddRef(pISource);
+                This->source = pISource;
+            }
+            else
+            {
+                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                    pISource, &This->source);
+                This->bpp = 32;
+            }
+            if (mode == WICBitmapInterpolationModeLinear)
+            {
+                This->fn_get_required_source_rect = Linear_GetRequiredSourceRect;
+                This->fn_copy_scanline = Linear_CopyScanline;
+                This->fn_init_columns = Linear_InitColumns;
+            }
+            else if (mode == WICBitmapInterpolationModeCubic)
+            {
+                This->fn_get_required_source_rect = Cubic_GetRequiredSourceRect;
+                This->fn_copy_scanline = Cubic_CopyScanline;
+                This->fn_init_columns = Cubic_InitColumns;
+            }
+            else
+            {
+                This->fn_get_required_source_rect = Fant_GetRequiredSourceRect;
+                This->fn_copy_scanline = Fant_CopyScanline;
+                This->fn_init_columns = Fant_InitColumns;
+            }
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
@@ -353,6 +633,7 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
             }
             This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
             This->fn_copy_scanline = NearestNeighbor_CopyScanline;
+            This->fn_init_columns = NULL;
             break;
         }
     }
@@ -391,6 +672,7 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    This->columns = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -367,6 +367,162 @@ static void test_default_converter(void)
     DeleteTestBitmap(src_obj);
 }
 
+static void test_scaler(void)
+{
+    static BYTE bits[6 * 5 * 4];
+    static const struct bitmap_data testdata = {
+        &GUID_WICPixelFormat32bppBGRA, 32, bits, 6, 5, 96.0, 96.0};
+    static const struct { UINT width, height; } sizes[] = { {2, 2}, {6, 5}, {13, 7} };
+    IWICImagingFactory *factory;
+    IWICBitmapScaler *scaler;
+    BitmapTestSrc *src_obj;
+    WICPixelFormatGUID format;
+    BYTE buffer[13 * 7 * 4];
+    UINT mode, i, j, width, height;
+    HRESULT hr;
+
+    for (i=0; i<sizeof(bits); i+=4)
+    {
+        bits[i] = 0x12;
+        bits[i+1] = 0x34;
+        bits[i+2] = 0x56;
+        bits[i+3] = 0xff;
+    }
+
+    hr = CoCreateInstance(&CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICImagingFactory, (void**)&factory);
+    ok(hr == S_OK, "CoCreateInstance failed, hr=%x\n", hr);
+    if (FAILED(hr)) return;
+
+    CreateTestBitmap(&testdata, &src_obj);
+
+    for (mode=WICBitmapInterpolationModeNearestNeighbor; mode<=WICBitmapInterpolationModeFant; mode++)
+    {
+        for (i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++)
+        {
+            hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+            ok(hr == S_OK, "CreateBitmapScaler failed, hr=%x\n", hr);
+
+            hr = IWICBitmapScaler_Initialize(scaler, &src_obj->IWICBitmapSource_iface,
+                sizes[i].width, sizes[i].height, mode);
+            ok(hr == S_OK, "mode %u: Initialize failed, hr=%x\n", mode, hr);
+
+            hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+            ok(hr == S_OK, "GetSize failed, hr=%x\n", hr);
+            ok(width == sizes[i].width && height == sizes[i].height, "mode %u: got size %ux%u\n", mode, width, height);
+
+            hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+            ok(hr == S_OK, "GetPixelFormat failed, hr=%x\n", hr);
+            ok(IsEqualGUID(&format, &GUID_WICPixelFormat32bppBGRA), "mode %u: unexpected pixel format\n", mode);
+
+            memset(buffer, 0, sizeof(buffer));
+            hr = IWICBitmapScaler_CopyPixels(scaler, NULL, width * 4, sizeof(buffer), buffer);
+            ok(hr == S_OK, "mode %u: CopyPixels failed, hr=%x\n", mode, hr);
+
+            /* scaling an image of a single color gives the same color */
+            for (j=0; j<width * height * 4; j++)
+                if (buffer[j] != bits[j % 4])
+                    break;
+            ok(j == width * height * 4, "mode %u, %ux%u: unexpected value at byte %u\n",
+               mode, width, height, j);
+
+            IWICBitmapScaler_Release(scaler);
+        }
+    }
+
+    DeleteTestBitmap(src_obj);
+    IWICImagingFactory_Release(factory);
+}
+
+static void check_scaled_pixels(IWICImagingFactory *factory, IWICBitmapSource *source,
+    UINT width, UINT height, WICBitmapInterpolationMode mode, const WICRect *rc, const BYTE *expect, int max_diff)
+{
+    IWICBitmapScaler *scaler;
+    BYTE buffer[16];
+    UINT i;
+    HRESULT hr;
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "CreateBitmapScaler failed, hr=%x\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, source, width, height, mode);
+    ok(hr == S_OK, "mode %u: Initialize failed, hr=%x\n", mode, hr);
+
+    memset(buffer, 0xcc, sizeof(buffer));
+    hr = IWICBitmapScaler_CopyPixels(scaler, rc, rc->Width, sizeof(buffer), buffer);
+    ok(hr == S_OK, "mode %u: CopyPixels failed, hr=%x\n", mode, hr);
+
+    for (i=0; i<rc->Width * rc->Height; i++)
+        ok(abs(buffer[i] - expect[i]) <= max_diff, "mode %u, rect %d,%d %dx%d: got %u at %u, expected %u\n",
+           mode, rc->X, rc->Y, rc->Width, rc->Height, buffer[i], i, expect[i]);
+
+    IWICBitmapScaler_Release(scaler);
+}
+
+static void test_scaler_filters(void)
+{
+    static const BYTE ramp[4] = {0, 64, 128, 192};
+    static const BYTE rows[16] = {  0,  10,  20,  30,  40,  50,  60,  70,
+                                  100, 110, 120, 130, 140, 150, 160, 170};
+    static const BYTE flat[16] = {77, 77, 77, 77, 77, 77, 77, 77,
+                                  77, 77, 77, 77, 77, 77, 77, 77};
+    static const struct bitmap_data ramp_data = {
+        &GUID_WICPixelFormat8bppGray, 8, ramp, 4, 1, 96.0, 96.0};
+    static const struct bitmap_data rows_data = {
+        &GUID_WICPixelFormat8bppGray, 8, rows, 8, 2, 96.0, 96.0};
+    static const struct bitmap_data flat_data = {
+        &GUID_WICPixelFormat8bppGray, 8, flat, 8, 2, 96.0, 96.0};
+    /* pixel centers map to 0, 0.25, 0.75, ... 2.75, 3 (clamped) */
+    static const BYTE linear[8] = {0, 16, 48, 80, 112, 144, 176, 192};
+    /* the edge pixels are repeated outside of the image, the exact values
+     * depend on the kernel */
+    static const BYTE cubic[8] = {0, 12, 47, 80, 112, 146, 181, 192};
+    /* averages of columns 0-2, 2-5 and 5-7 of both rows, up to rounding */
+    static const BYTE fant[3] = {60, 85, 110};
+    static const WICRect full8 = {0, 0, 8, 1}, right3 = {5, 0, 3, 1}, middle3 = {3, 0, 3, 1};
+    static const WICRect full3 = {0, 0, 3, 1}, right2 = {1, 0, 2, 1};
+    IWICImagingFactory *factory;
+    BitmapTestSrc *ramp_src, *rows_src, *flat_src;
+    HRESULT hr;
+
+    hr = CoCreateInstance(&CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICImagingFactory, (void**)&factory);
+    ok(hr == S_OK, "CoCreateInstance failed, hr=%x\n", hr);
+    if (FAILED(hr)) return;
+
+    CreateTestBitmap(&ramp_data, &ramp_src);
+    CreateTestBitmap(&rows_data, &rows_src);
+    CreateTestBitmap(&flat_data, &flat_src);
+
+    check_scaled_pixels(factory, &ramp_src->IWICBitmapSource_iface, 8, 1,
+        WICBitmapInterpolationModeLinear, &full8, linear, 0);
+    check_scaled_pixels(factory, &ramp_src->IWICBitmapSource_iface, 8, 1,
+        WICBitmapInterpolationModeLinear, &middle3, linear + 3, 0);
+    check_scaled_pixels(factory, &ramp_src->IWICBitmapSource_iface, 8, 1,
+        WICBitmapInterpolationModeCubic, &full8, cubic, 8);
+    check_scaled_pixels(factory, &ramp_src->IWICBitmapSource_iface, 8, 1,
+        WICBitmapInterpolationModeCubic, &right3, cubic + 5, 8);
+    check_scaled_pixels(factory, &rows_src->IWICBitmapSource_iface, 3, 1,
+        WICBitmapInterpolationModeFant, &full3, fant, 2);
+    check_scaled_pixels(factory, &rows_src->IWICBitmapSource_iface, 3, 1,
+        WICBitmapInterpolationModeFant, &right2, fant + 1, 2);
+
+    /* every filter has to preserve a uniform image exactly */
+    check_scaled_pixels(factory, &flat_src->IWICBitmapSource_iface, 3, 1,
+        WICBitmapInterpolationModeLinear, &full3, flat, 0);
+    check_scaled_pixels(factory, &flat_src->IWICBitmapSource_iface, 3, 1,
+        WICBitmapInterpolationModeCubic, &full3, flat, 0);
+    check_scaled_pixels(factory, &flat_src->IWICBitmapSource_iface, 3, 1,
+        WICBitmapInterpolationModeFant, &full3, flat, 0);
+    check_scaled_pixels(factory, &flat_src->IWICBitmapSource_iface, 16, 4,
+        WICBitmapInterpolationModeCubic, &full8, flat, 0);
+
+    DeleteTestBitmap(ramp_src);
+    DeleteTestBitmap(rows_src);
+    DeleteTestBitmap(flat_src);
+    IWICImagingFactory_Release(factory);
+}
+
 typedef struct property_opt_test_data
 {
     LPCOLESTR name;
@@ -738,6 +894,8 @@ START_TEST(converter)
 
     test_invalid_conversion();
     test_default_converter();
+    test_scaler();
+    test_scaler_filters();
 
     test_encoder(&testdata_32bppBGR, &CLSID_WICBmpEncoder,
                  &testdata_32bppBGR, &CLSID_WICBmpDecoder, "BMP encoder 32bppBGR");
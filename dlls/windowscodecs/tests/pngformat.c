@@ -24,6 +24,7 @@
 
 #include "windef.h"
 #include "wincodec.h"
+#include "wincodecsdk.h"
 #include "wine/test.h"
 
 /* 1x1 pixel PNG image */
@@ -579,6 +580,72 @@ static void test_png_palette(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+/* 3x4 8bpp gray PNG image, pixels are 16 * row + column, with a tEXt chunk after the image data */
+static const char png_gray_rows[] = {
+  0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+  0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04,
+  0x08, 0x00, 0x00, 0x00, 0x00, 0x6e, 0x46, 0xda, 0xdb, 0x00, 0x00, 0x00,
+  0x18, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0x60, 0x64, 0x62,
+  0x10, 0x10, 0x14, 0x62, 0x50, 0x50, 0x54, 0x62, 0x30, 0x30, 0x34, 0x02,
+  0x00, 0x05, 0xa8, 0x01, 0x2d, 0xa5, 0x91, 0x3b, 0xd0, 0x00, 0x00, 0x00,
+  0x0a, 0x74, 0x45, 0x58, 0x74, 0x54, 0x69, 0x74, 0x6c, 0x65, 0x00, 0x52,
+  0x6f, 0x77, 0x73, 0x01, 0xa1, 0xd8, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x49,
+  0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+};
+
+static void check_png_rows(IWICBitmapFrameDecode *frame, INT y, INT height)
+{
+    WICRect rc = {0, y, 3, height};
+    BYTE buffer[12];
+    HRESULT hr;
+    INT i;
+
+    memset(buffer, 0xcc, sizeof(buffer));
+    hr = IWICBitmapFrameDecode_CopyPixels(frame, &rc, 3, sizeof(buffer), buffer);
+    ok(hr == S_OK, "rows %d-%d: CopyPixels error %#x\n", y, y + height - 1, hr);
+
+    for (i = 0; i < 3 * height; i++)
+        ok(buffer[i] == (y + i / 3) * 16 + i % 3, "rows %d-%d: got %u at %d\n",
+           y, y + height - 1, buffer[i], i);
+}
+
+static void test_png_rows(void)
+{
+    HRESULT hr;
+    IWICBitmapDecoder *decoder;
+    IWICBitmapFrameDecode *frame;
+    IWICMetadataBlockReader *block_reader;
+    IWICMetadataReader *reader;
+    UINT count;
+
+    decoder = create_decoder(png_gray_rows, sizeof(png_gray_rows));
+    ok(decoder != 0, "Failed to load PNG image data\n");
+    if (!decoder) return;
+
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+    ok(hr == S_OK, "GetFrame error %#x\n", hr);
+
+    check_png_rows(frame, 1, 1);
+
+    /* reading the metadata moves the stream between the decoded rows */
+    hr = IWICBitmapFrameDecode_QueryInterface(frame, &IID_IWICMetadataBlockReader, (void **)&block_reader);
+    ok(hr == S_OK, "QueryInterface error %#x\n", hr);
+    hr = IWICMetadataBlockReader_GetCount(block_reader, &count);
+    ok(hr == S_OK, "GetCount error %#x\n", hr);
+    ok(count == 1, "expected 1, got %u\n", count);
+    hr = IWICMetadataBlockReader_GetReaderByIndex(block_reader, 0, &reader);
+    ok(hr == S_OK, "GetReaderByIndex error %#x\n", hr);
+    IWICMetadataReader_Release(reader);
+    IWICMetadataBlockReader_Release(block_reader);
+
+    check_png_rows(frame, 2, 2);
+    check_png_rows(frame, 0, 2);
+    check_png_rows(frame, 0, 4);
+
+    IWICBitmapFrameDecode_Release(frame);
+    IWICBitmapDecoder_Release(decoder);
+}
+
 START_TEST(pngformat)
 {
     HRESULT hr;
@@ -591,6 +658,7 @@ START_TEST(pngformat)
 
     test_color_contexts();
     test_png_palette();
+    test_png_rows();
 
     IWICImagingFactory_Release(factory);
     CoUninitialize();
@@ -953,6 +953,12 @@ HRESULT CDECL wined3d_buffer_map(struct wined3d_buffer *buffer, UINT offset, UIN
      * appears to do this unconditionally. */
     if (buffer->flags & WINED3D_BUFFER_DISCARD)
         flags &= ~WINED3D_MAP_DISCARD;
+    /* Queued draws read the system memory copy when they are executed, and
+     * GL buffer objects can't be used while mapped. Only NOOVERWRITE maps of
+     * buffers without a mapped GL buffer object don't need to wait. */
+    if (!(flags & WINED3D_MAP_NOOVERWRITE)
+            || (buffer->buffer_object && !(buffer->flags & WINED3D_BUFFER_DOUBLEBUFFER)))
+        wined3d_resource_wait_idle(&buffer->resource);
     count = ++buffer->resource.map_count;
 
     if (buffer->buffer_object)
@@ -1118,6 +1118,8 @@ BOOL context_set_current(struct wined3d_context *ctx)
 
 void context_release(struct wined3d_context *context)
 {
+    struct wined3d_cs *cs = context->swapchain->device->cs;
+
     TRACE("Releasing context %p, level %u.\n", context, context->level);
 
     if (WARN_ON(d3d))
@@ -1128,6 +1130,11 @@ void context_release(struct wined3d_context *context)
             WARN("Context %p is not the current context.\n", context);
     }
 
+    /* Order the GL work done on this thread before later command stream
+     * work. Packets are fenced once the whole batch has been executed. */
+    if (context->level == 1 && context->valid && cs && cs->queue)
+        wined3d_cs_release_gl(cs, context);
+
     if (!--context->level && context->restore_ctx)
     {
         TRACE("Restoring GL context %p on device context %p.\n", context->restore_ctx, context->restore_dc);
@@ -1135,6 +1142,9 @@ void context_release(struct wined3d_context *context)
         context->restore_ctx = NULL;
         context->restore_dc = NULL;
     }
+
+    if (cs && cs->queue)
+        LeaveCriticalSection(&cs->lock);
 }
 
 /* This is used when a context for render target A is active, but a separate context is
@@ -1534,6 +1544,9 @@ struct wined3d_context *context_create(struct wined3d_swapchain *swapchain,
         goto out;
     }
 
+    /* Paired with the context_release() calls below. */
+    if (device->cs && device->cs->queue)
+        EnterCriticalSection(&device->cs->lock);
     context_enter(ret);
 
     if (!context_set_pixel_format(gl_info, hdc, pixel_format))
@@ -2322,7 +2335,7 @@ BOOL context_apply_clear_state(struct wined3d_context *context, const struct win
     DWORD rt_mask = 0, *cur_mask;
     UINT i;
 
-    if (isStateDirty(context, STATE_FRAMEBUFFER) || fb != &device->fb
+    if (isStateDirty(context, STATE_FRAMEBUFFER) || fb != &device->cs->fb
             || rt_count != context->gl_info->limits.buffers)
     {
         if (!context_validate_rt_config(rt_count, rts, dsv))
@@ -2408,7 +2421,7 @@ BOOL context_apply_clear_state(struct wined3d_context *context, const struct win
     if (gl_info->supported[ARB_FRAMEBUFFER_SRGB])
     {
         if (!(context->d3d_info->wined3d_creation_flags & WINED3D_SRGB_READ_WRITE_CONTROL)
-                || device->state.render_states[WINED3D_RS_SRGBWRITEENABLE])
+                || device->cs->state.render_states[WINED3D_RS_SRGBWRITEENABLE])
             gl_info->gl_ops.gl.p_glEnable(GL_FRAMEBUFFER_SRGB);
         else
             gl_info->gl_ops.gl.p_glDisable(GL_FRAMEBUFFER_SRGB);
@@ -2425,7 +2438,7 @@ BOOL context_apply_clear_state(struct wined3d_context *context, const struct win
 
 static DWORD find_draw_buffers_mask(const struct wined3d_context *context, const struct wined3d_device *device)
 {
-    const struct wined3d_state *state = &device->state;
+    const struct wined3d_state *state = &device->cs->state;
     struct wined3d_rendertarget_view **rts = state->fb->render_targets;
     struct wined3d_shader *ps = state->shader[WINED3D_SHADER_TYPE_PIXEL];
     DWORD rt_mask, rt_mask_bits;
@@ -3129,7 +3142,7 @@ static void context_bind_shader_resources(struct wined3d_context *context, const
 /* Context activation is done by the caller. */
 BOOL context_apply_draw_state(struct wined3d_context *context, struct wined3d_device *device)
 {
-    const struct wined3d_state *state = &device->state;
+    const struct wined3d_state *state = &device->cs->state;
     const struct StateEntry *state_table = context->state_table;
     const struct wined3d_fb_state *fb = state->fb;
     unsigned int i;
@@ -3275,6 +3288,10 @@ struct wined3d_context *context_acquire(const struct wined3d_device *device, str
 
     TRACE("device %p, target %p.\n", device, target);
 
+    /* Only one thread at a time uses GL, see wined3d_cs_run(). */
+    if (device->cs && device->cs->queue)
+        EnterCriticalSection(&device->cs->lock);
+
     if (current_context && current_context->destroyed)
         current_context = NULL;
 
@@ -3333,5 +3350,8 @@ struct wined3d_context *context_acquire(const struct wined3d_device *device, str
         context_set_gl_context(context);
     }
 
+    if (context->level == 1 && device->cs && device->cs->queue)
+        wined3d_cs_wait_gl_fence(device->cs, context);
+
     return context;
 }
@@ -21,8 +21,11 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 #define WINED3D_INITIAL_CS_SIZE 4096
+#define WINED3D_CS_QUEUE_SIZE   0x100000
+#define WINED3D_CS_BATCH_SIZE   32
 
 enum wined3d_cs_op
 {
@@ -51,7 +54,30 @@ enum wined3d_cs_op
     WINED3D_CS_OP_SET_CLIP_PLANE,
     WINED3D_CS_OP_SET_COLOR_KEY,
     WINED3D_CS_OP_SET_MATERIAL,
+    WINED3D_CS_OP_SET_LIGHT,
+    WINED3D_CS_OP_SET_CONSTANTS,
     WINED3D_CS_OP_RESET_STATE,
+    WINED3D_CS_OP_QUERY_ISSUE,
+    WINED3D_CS_OP_NOP,
+};
+
+/* Packets are 16 byte aligned, so that the tail of the queue always has room
+ * for at least a packet header followed by an opcode. */
+struct wined3d_cs_packet
+{
+    size_t size;
+    BYTE data[8];
+};
+
+struct wined3d_cs_queue
+{
+    ULONG head, tail;
+    BYTE data[WINED3D_CS_QUEUE_SIZE];
+};
+
+struct wined3d_cs_stats
+{
+    unsigned int op_count[WINED3D_CS_OP_NOP];
 };
 
 struct wined3d_cs_present
@@ -59,21 +85,21 @@ struct wined3d_cs_present
     enum wined3d_cs_op opcode;
     HWND dst_window_override;
     struct wined3d_swapchain *swapchain;
-    const RECT *src_rect;
-    const RECT *dst_rect;
-    const RGNDATA *dirty_region;
+    BOOL has_src_rect, has_dst_rect;
+    RECT src_rect;
+    RECT dst_rect;
     DWORD flags;
 };
 
 struct wined3d_cs_clear
 {
     enum wined3d_cs_op opcode;
-    DWORD rect_count;
-    const RECT *rects;
     DWORD flags;
-    const struct wined3d_color *color;
+    struct wined3d_color color;
     float depth;
     DWORD stencil;
+    DWORD rect_count;
+    RECT rects[1];
 };
 
 struct wined3d_cs_draw
@@ -84,6 +110,9 @@ struct wined3d_cs_draw
     UINT start_instance;
     UINT instance_count;
     BOOL indexed;
+    GLenum primitive_type;
+    INT base_vertex_idx;
+    INT load_base_vertex_idx;
 };
 
 struct wined3d_cs_set_predication
@@ -96,13 +125,13 @@ struct wined3d_cs_set_predication
 struct wined3d_cs_set_viewport
 {
     enum wined3d_cs_op opcode;
-    const struct wined3d_viewport *viewport;
+    struct wined3d_viewport viewport;
 };
 
 struct wined3d_cs_set_scissor_rect
 {
     enum wined3d_cs_op opcode;
-    const RECT *rect;
+    RECT rect;
 };
 
 struct wined3d_cs_set_rendertarget_view
@@ -230,20 +259,35 @@ struct wined3d_cs_set_transform
 {
     enum wined3d_cs_op opcode;
     enum wined3d_transform_state state;
-    const struct wined3d_matrix *matrix;
+    struct wined3d_matrix matrix;
 };
 
 struct wined3d_cs_set_clip_plane
 {
     enum wined3d_cs_op opcode;
     UINT plane_idx;
-    const struct wined3d_vec4 *plane;
+    struct wined3d_vec4 plane;
 };
 
 struct wined3d_cs_set_material
 {
     enum wined3d_cs_op opcode;
-    const struct wined3d_material *material;
+    struct wined3d_material material;
+};
+
+struct wined3d_cs_set_light
+{
+    enum wined3d_cs_op opcode;
+    struct wined3d_light_info light;
+};
+
+struct wined3d_cs_set_constants
+{
+    enum wined3d_cs_op opcode;
+    DWORD type;
+    unsigned int start_idx;
+    unsigned int count;
+    BYTE constants[1];
 };
 
 struct wined3d_cs_reset_state
@@ -251,6 +295,77 @@ struct wined3d_cs_reset_state
     enum wined3d_cs_op opcode;
 };
 
+struct wined3d_cs_query_issue
+{
+    enum wined3d_cs_op opcode;
+    struct wined3d_query *query;
+    DWORD flags;
+};
+
+/* Resources used by a packet may only be accessed outside of the command
+ * stream once that packet has been executed, see wined3d_resource_wait_idle(). */
+static void wined3d_cs_reference_resource(struct wined3d_cs *cs, struct wined3d_resource *resource)
+{
+    resource_set_access_fence(resource, cs->queue->head);
+}
+
+static void wined3d_cs_reference_fb(struct wined3d_cs *cs, const struct wined3d_fb_state *fb)
+{
+    unsigned int i;
+
+    /* GDI devices don't have a framebuffer. */
+    if (!fb->render_targets)
+        return;
+
+    for (i = 0; i < cs->device->adapter->gl_info.limits.buffers; ++i)
+    {
+        if (fb->render_targets[i])
+            wined3d_cs_reference_resource(cs, fb->render_targets[i]->resource);
+    }
+    if (fb->depth_stencil)
+        wined3d_cs_reference_resource(cs, fb->depth_stencil->resource);
+}
+
+static void wined3d_cs_reference_state(struct wined3d_cs *cs, const struct wined3d_state *state)
+{
+    unsigned int i, j;
+
+    wined3d_cs_reference_fb(cs, state->fb);
+
+    for (i = 0; i < ARRAY_SIZE(state->streams); ++i)
+    {
+        if (state->streams[i].buffer)
+            wined3d_cs_reference_resource(cs, &state->streams[i].buffer->resource);
+    }
+    for (i = 0; i < ARRAY_SIZE(state->stream_output); ++i)
+    {
+        if (state->stream_output[i].buffer)
+            wined3d_cs_reference_resource(cs, &state->stream_output[i].buffer->resource);
+    }
+    if (state->index_buffer)
+        wined3d_cs_reference_resource(cs, &state->index_buffer->resource);
+
+    for (i = 0; i < ARRAY_SIZE(state->textures); ++i)
+    {
+        if (state->textures[i])
+            wined3d_cs_reference_resource(cs, &state->textures[i]->resource);
+    }
+
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+    {
+        for (j = 0; j < MAX_CONSTANT_BUFFERS; ++j)
+        {
+            if (state->cb[i][j])
+                wined3d_cs_reference_resource(cs, &state->cb[i][j]->resource);
+        }
+        for (j = 0; j < MAX_SHADER_RESOURCE_VIEWS; ++j)
+        {
+            if (state->shader_resource_view[i][j])
+                wined3d_cs_reference_resource(cs, state->shader_resource_view[i][j]->resource);
+        }
+    }
+}
+
 static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_present *op = data;
@@ -259,8 +374,10 @@ static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
     swapchain = op->swapchain;
     wined3d_swapchain_set_window(swapchain, op->dst_window_override);
 
-    swapchain->swapchain_ops->swapchain_present(swapchain,
-            op->src_rect, op->dst_rect, op->dirty_region, op->flags);
+    /* The dirty region is ignored by the present implementations, and isn't
+     * recorded since it may not outlive the call in multithreaded mode. */
+    swapchain->swapchain_ops->swapchain_present(swapchain, op->has_src_rect ? &op->src_rect : NULL,
+            op->has_dst_rect ? &op->dst_rect : NULL, NULL, op->flags);
 }
 
 void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *swapchain,
@@ -273,12 +390,23 @@ void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *sw
     op->opcode = WINED3D_CS_OP_PRESENT;
     op->dst_window_override = dst_window_override;
     op->swapchain = swapchain;
-    op->src_rect = src_rect;
-    op->dst_rect = dst_rect;
-    op->dirty_region = dirty_region;
+    if ((op->has_src_rect = !!src_rect))
+        op->src_rect = *src_rect;
+    if ((op->has_dst_rect = !!dst_rect))
+        op->dst_rect = *dst_rect;
     op->flags = flags;
 
     cs->ops->submit(cs);
+
+    if (cs->queue)
+    {
+        unsigned int i;
+
+        wined3d_cs_reference_resource(cs, &swapchain->front_buffer->resource);
+        for (i = 0; i < swapchain->desc.backbuffer_count; ++i)
+            wined3d_cs_reference_resource(cs, &swapchain->back_buffers[i]->resource);
+        wined3d_cs_reference_fb(cs, &cs->device->fb);
+    }
 }
 
 static void wined3d_cs_exec_clear(struct wined3d_cs *cs, const void *data)
@@ -288,10 +416,10 @@ static void wined3d_cs_exec_clear(struct wined3d_cs *cs, const void *data)
     RECT draw_rect;
 
     device = cs->device;
-    wined3d_get_draw_rect(&device->state, &draw_rect);
+    wined3d_get_draw_rect(&cs->state, &draw_rect);
     device_clear_render_targets(device, device->adapter->gl_info.limits.buffers,
-            &device->fb, op->rect_count, op->rects, &draw_rect, op->flags,
-            op->color, op->depth, op->stencil);
+            &cs->fb, op->rect_count, op->rect_count ? op->rects : NULL, &draw_rect, op->flags,
+            &op->color, op->depth, op->stencil);
 }
 
 void wined3d_cs_emit_clear(struct wined3d_cs *cs, DWORD rect_count, const RECT *rects,
@@ -299,21 +427,42 @@ void wined3d_cs_emit_clear(struct wined3d_cs *cs, DWORD rect_count, const RECT *
 {
     struct wined3d_cs_clear *op;
 
-    op = cs->ops->require_space(cs, sizeof(*op));
+    if (!rects)
+        rect_count = 0;
+
+    op = cs->ops->require_space(cs, FIELD_OFFSET(struct wined3d_cs_clear, rects[rect_count]));
     op->opcode = WINED3D_CS_OP_CLEAR;
-    op->rect_count = rect_count;
-    op->rects = rects;
     op->flags = flags;
-    op->color = color;
+    op->color = *color;
     op->depth = depth;
     op->stencil = stencil;
+    op->rect_count = rect_count;
+    if (rect_count)
+        memcpy(op->rects, rects, rect_count * sizeof(*rects));
 
     cs->ops->submit(cs);
+
+    if (cs->queue)
+        wined3d_cs_reference_fb(cs, &cs->device->fb);
 }
 
 static void wined3d_cs_exec_draw(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_draw *op = data;
+    struct wined3d_state *state = &cs->state;
+
+    if (op->primitive_type != state->gl_primitive_type)
+    {
+        if (op->primitive_type == GL_POINTS || state->gl_primitive_type == GL_POINTS)
+            device_invalidate_state(cs->device, STATE_POINT_ENABLE);
+        state->gl_primitive_type = op->primitive_type;
+    }
+    state->base_vertex_index = op->base_vertex_idx;
+    if (state->load_base_vertex_index != op->load_base_vertex_idx)
+    {
+        state->load_base_vertex_index = op->load_base_vertex_idx;
+        device_invalidate_state(cs->device, STATE_BASEVERTEXINDEX);
+    }
 
     draw_primitive(cs->device, op->start_idx, op->index_count,
             op->start_instance, op->instance_count, op->indexed);
@@ -322,6 +471,7 @@ static void wined3d_cs_exec_draw(struct wined3d_cs *cs, const void *data)
 void wined3d_cs_emit_draw(struct wined3d_cs *cs, UINT start_idx, UINT index_count,
         UINT start_instance, UINT instance_count, BOOL indexed)
 {
+    const struct wined3d_state *state = &cs->device->state;
     struct wined3d_cs_draw *op;
 
     op = cs->ops->require_space(cs, sizeof(*op));
@@ -331,8 +481,14 @@ void wined3d_cs_emit_draw(struct wined3d_cs *cs, UINT start_idx, UINT index_coun
     op->start_instance = start_instance;
     op->instance_count = instance_count;
     op->indexed = indexed;
+    op->primitive_type = state->gl_primitive_type;
+    op->base_vertex_idx = state->base_vertex_index;
+    op->load_base_vertex_idx = state->load_base_vertex_index;
 
     cs->ops->submit(cs);
+
+    if (cs->queue)
+        wined3d_cs_reference_state(cs, state);
 }
 
 static void wined3d_cs_exec_set_predication(struct wined3d_cs *cs, const void *data)
@@ -359,7 +515,7 @@ static void wined3d_cs_exec_set_viewport(struct wined3d_cs *cs, const void *data
 {
     const struct wined3d_cs_set_viewport *op = data;
 
-    cs->state.viewport = *op->viewport;
+    cs->state.viewport = op->viewport;
     device_invalidate_state(cs->device, STATE_VIEWPORT);
 }
 
@@ -369,7 +525,7 @@ void wined3d_cs_emit_set_viewport(struct wined3d_cs *cs, const struct wined3d_vi
 
     op = cs->ops->require_space(cs, sizeof(*op));
     op->opcode = WINED3D_CS_OP_SET_VIEWPORT;
-    op->viewport = viewport;
+    op->viewport = *viewport;
 
     cs->ops->submit(cs);
 }
@@ -378,7 +534,7 @@ static void wined3d_cs_exec_set_scissor_rect(struct wined3d_cs *cs, const void *
 {
     const struct wined3d_cs_set_scissor_rect *op = data;
 
-    cs->state.scissor_rect = *op->rect;
+    cs->state.scissor_rect = op->rect;
     device_invalidate_state(cs->device, STATE_SCISSORRECT);
 }
 
@@ -388,7 +544,7 @@ void wined3d_cs_emit_set_scissor_rect(struct wined3d_cs *cs, const RECT *rect)
 
     op = cs->ops->require_space(cs, sizeof(*op));
     op->opcode = WINED3D_CS_OP_SET_SCISSOR_RECT;
-    op->rect = rect;
+    op->rect = *rect;
 
     cs->ops->submit(cs);
 }
@@ -858,7 +1014,7 @@ static void wined3d_cs_exec_set_transform(struct wined3d_cs *cs, const void *dat
 {
     const struct wined3d_cs_set_transform *op = data;
 
-    cs->state.transforms[op->state] = *op->matrix;
+    cs->state.transforms[op->state] = op->matrix;
     if (op->state < WINED3D_TS_WORLD_MATRIX(cs->device->adapter->d3d_info.limits.ffp_vertex_blend_matrices))
         device_invalidate_state(cs->device, STATE_TRANSFORM(op->state));
 }
@@ -871,7 +1027,7 @@ void wined3d_cs_emit_set_transform(struct wined3d_cs *cs, enum wined3d_transform
     op = cs->ops->require_space(cs, sizeof(*op));
     op->opcode = WINED3D_CS_OP_SET_TRANSFORM;
     op->state = state;
-    op->matrix = matrix;
+    op->matrix = *matrix;
 
     cs->ops->submit(cs);
 }
@@ -880,7 +1036,7 @@ static void wined3d_cs_exec_set_clip_plane(struct wined3d_cs *cs, const void *da
 {
     const struct wined3d_cs_set_clip_plane *op = data;
 
-    cs->state.clip_planes[op->plane_idx] = *op->plane;
+    cs->state.clip_planes[op->plane_idx] = op->plane;
     device_invalidate_state(cs->device, STATE_CLIPPLANE(op->plane_idx));
 }
 
@@ -891,7 +1047,7 @@ void wined3d_cs_emit_set_clip_plane(struct wined3d_cs *cs, UINT plane_idx, const
     op = cs->ops->require_space(cs, sizeof(*op));
     op->opcode = WINED3D_CS_OP_SET_CLIP_PLANE;
     op->plane_idx = plane_idx;
-    op->plane = plane;
+    op->plane = *plane;
 
     cs->ops->submit(cs);
 }
@@ -983,7 +1139,7 @@ static void wined3d_cs_exec_set_material(struct wined3d_cs *cs, const void *data
 {
     const struct wined3d_cs_set_material *op = data;
 
-    cs->state.material = *op->material;
+    cs->state.material = op->material;
     device_invalidate_state(cs->device, STATE_MATERIAL);
 }
 
@@ -993,7 +1149,161 @@ void wined3d_cs_emit_set_material(struct wined3d_cs *cs, const struct wined3d_ma
 
     op = cs->ops->require_space(cs, sizeof(*op));
     op->opcode = WINED3D_CS_OP_SET_MATERIAL;
-    op->material = material;
+    op->material = *material;
+
+    cs->ops->submit(cs);
+}
+
+static void wined3d_cs_exec_set_light(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_set_light *op = data;
+    struct wined3d_light_info *light_info = NULL;
+    unsigned int light_idx, hash_idx;
+    BOOL type_changed;
+    struct list *e;
+    LONG prev_idx;
+
+    light_idx = op->light.OriginalIndex;
+    hash_idx = LIGHTMAP_HASHFUNC(light_idx);
+
+    LIST_FOR_EACH(e, &cs->state.light_map[hash_idx])
+    {
+        light_info = LIST_ENTRY(e, struct wined3d_light_info, entry);
+        if (light_info->OriginalIndex == light_idx)
+            break;
+        light_info = NULL;
+    }
+
+    if (!light_info)
+    {
+        if (!(light_info = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*light_info))))
+        {
+            ERR("Failed to allocate light info.\n");
+            return;
+        }
+
+        list_add_head(&cs->state.light_map[hash_idx], &light_info->entry);
+        light_info->glIndex = -1;
+        light_info->OriginalIndex = light_idx;
+    }
+
+    prev_idx = light_info->glIndex;
+    type_changed = light_info->OriginalParms.type != op->light.OriginalParms.type;
+
+    light_info->OriginalParms = op->light.OriginalParms;
+    light_info->glIndex = op->light.glIndex;
+    light_info->enabled = op->light.enabled;
+    light_info->position = op->light.position;
+    light_info->direction = op->light.direction;
+    light_info->exponent = op->light.exponent;
+    light_info->cutoff = op->light.cutoff;
+
+    if (prev_idx != light_info->glIndex)
+    {
+        if (prev_idx != -1)
+        {
+            cs->state.lights[prev_idx] = NULL;
+            device_invalidate_state(cs->device, STATE_ACTIVELIGHT(prev_idx));
+        }
+        if (light_info->glIndex != -1)
+            cs->state.lights[light_info->glIndex] = light_info;
+        device_invalidate_state(cs->device, STATE_LIGHT_TYPE);
+    }
+    else if (type_changed && light_info->glIndex != -1)
+    {
+        device_invalidate_state(cs->device, STATE_LIGHT_TYPE);
+    }
+
+    if (light_info->glIndex != -1)
+        device_invalidate_state(cs->device, STATE_ACTIVELIGHT(light_info->glIndex));
+}
+
+void wined3d_cs_emit_set_light(struct wined3d_cs *cs, const struct wined3d_light_info *light)
+{
+    struct wined3d_cs_set_light *op;
+
+    op = cs->ops->require_space(cs, sizeof(*op));
+    op->opcode = WINED3D_CS_OP_SET_LIGHT;
+    op->light = *light;
+
+    cs->ops->submit(cs);
+}
+
+static size_t wined3d_cs_constant_size(DWORD type)
+{
+    switch (type)
+    {
+        case WINED3D_SHADER_CONST_VS_F:
+        case WINED3D_SHADER_CONST_PS_F:
+            return sizeof(float) * 4;
+
+        case WINED3D_SHADER_CONST_VS_I:
+        case WINED3D_SHADER_CONST_PS_I:
+            return sizeof(int) * 4;
+
+        case WINED3D_SHADER_CONST_VS_B:
+        case WINED3D_SHADER_CONST_PS_B:
+            return sizeof(BOOL);
+
+        default:
+            ERR("Unhandled constant type %#x.\n", type);
+            return 0;
+    }
+}
+
+static void wined3d_cs_exec_set_constants(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_set_constants *op = data;
+    struct wined3d_device *device = cs->device;
+    struct wined3d_state *state = &cs->state;
+    size_t size = op->count * wined3d_cs_constant_size(op->type);
+
+    switch (op->type)
+    {
+        case WINED3D_SHADER_CONST_VS_F:
+            memcpy(&state->vs_consts_f[op->start_idx * 4], op->constants, size);
+            device->shader_backend->shader_update_float_vertex_constants(device, op->start_idx, op->count);
+            break;
+
+        case WINED3D_SHADER_CONST_PS_F:
+            memcpy(&state->ps_consts_f[op->start_idx * 4], op->constants, size);
+            device->shader_backend->shader_update_float_pixel_constants(device, op->start_idx, op->count);
+            break;
+
+        case WINED3D_SHADER_CONST_VS_I:
+            memcpy(&state->vs_consts_i[op->start_idx * 4], op->constants, size);
+            device_invalidate_shader_constants(device, op->type);
+            break;
+
+        case WINED3D_SHADER_CONST_PS_I:
+            memcpy(&state->ps_consts_i[op->start_idx * 4], op->constants, size);
+            device_invalidate_shader_constants(device, op->type);
+            break;
+
+        case WINED3D_SHADER_CONST_VS_B:
+            memcpy(&state->vs_consts_b[op->start_idx], op->constants, size);
+            device_invalidate_shader_constants(device, op->type);
+            break;
+
+        case WINED3D_SHADER_CONST_PS_B:
+            memcpy(&state->ps_consts_b[op->start_idx], op->constants, size);
+            device_invalidate_shader_constants(device, op->type);
+            break;
+    }
+}
+
+void wined3d_cs_emit_set_constants(struct wined3d_cs *cs, DWORD type,
+        unsigned int start_idx, unsigned int count, const void *constants)
+{
+    struct wined3d_cs_set_constants *op;
+    size_t size = count * wined3d_cs_constant_size(type);
+
+    op = cs->ops->require_space(cs, FIELD_OFFSET(struct wined3d_cs_set_constants, constants[size]));
+    op->opcode = WINED3D_CS_OP_SET_CONSTANTS;
+    op->type = type;
+    op->start_idx = start_idx;
+    op->count = count;
+    memcpy(op->constants, constants, size);
 
     cs->ops->submit(cs);
 }
@@ -1020,6 +1330,28 @@ void wined3d_cs_emit_reset_state(struct wined3d_cs *cs)
     cs->ops->submit(cs);
 }
 
+static void wined3d_cs_exec_query_issue(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_query_issue *op = data;
+
+    op->query->query_ops->query_issue(op->query, op->flags);
+}
+
+void wined3d_cs_emit_query_issue(struct wined3d_cs *cs, struct wined3d_query *query, DWORD flags)
+{
+    struct wined3d_cs_query_issue *op;
+
+    op = cs->ops->require_space(cs, sizeof(*op));
+    op->opcode = WINED3D_CS_OP_QUERY_ISSUE;
+    op->query = query;
+    op->flags = flags;
+
+    cs->ops->submit(cs);
+
+    if (cs->queue)
+        query->issue_fence = cs->queue->head;
+}
+
 static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void *data) =
 {
     /* WINED3D_CS_OP_PRESENT                    */ wined3d_cs_exec_present,
@@ -1047,9 +1379,21 @@ static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void
     /* WINED3D_CS_OP_SET_CLIP_PLANE             */ wined3d_cs_exec_set_clip_plane,
     /* WINED3D_CS_OP_SET_COLOR_KEY              */ wined3d_cs_exec_set_color_key,
     /* WINED3D_CS_OP_SET_MATERIAL               */ wined3d_cs_exec_set_material,
+    /* WINED3D_CS_OP_SET_LIGHT                  */ wined3d_cs_exec_set_light,
+    /* WINED3D_CS_OP_SET_CONSTANTS              */ wined3d_cs_exec_set_constants,
     /* WINED3D_CS_OP_RESET_STATE                */ wined3d_cs_exec_reset_state,
+    /* WINED3D_CS_OP_QUERY_ISSUE                */ wined3d_cs_exec_query_issue,
 };
 
+static void wined3d_cs_execute(struct wined3d_cs *cs, const void *data)
+{
+    enum wined3d_cs_op opcode = *(const enum wined3d_cs_op *)data;
+
+    if (cs->stats)
+        ++cs->stats->op_count[opcode];
+    wined3d_cs_op_handlers[opcode](cs, data);
+}
+
 static void *wined3d_cs_st_require_space(struct wined3d_cs *cs, size_t size)
 {
     if (size > cs->data_size)
@@ -1069,17 +1413,339 @@ static void *wined3d_cs_st_require_space(struct wined3d_cs *cs, size_t size)
 
 static void wined3d_cs_st_submit(struct wined3d_cs *cs)
 {
-    enum wined3d_cs_op opcode = *(const enum wined3d_cs_op *)cs->data;
+    wined3d_cs_execute(cs, cs->data);
+}
 
-    wined3d_cs_op_handlers[opcode](cs, cs->data);
+static void wined3d_cs_st_finish(struct wined3d_cs *cs)
+{
 }
 
 static const struct wined3d_cs_ops wined3d_cs_st_ops =
 {
     wined3d_cs_st_require_space,
     wined3d_cs_st_submit,
+    wined3d_cs_st_finish,
+};
+
+/* Multithreaded command stream. Commands are written to a single producer,
+ * single consumer ring buffer and executed by a dedicated thread.
+ *
+ * The command stream thread doesn't take the wined3d mutex, so it runs
+ * concurrently with wined3d calls from the application. Rendering only uses
+ * the command stream's copy of the state. Resources remember the position in
+ * the queue of the last packet that used them, and
+ * wined3d_resource_wait_idle() has to be called before accessing a resource
+ * outside of the command stream.
+ *
+ * GL is only used by one thread at a time. The command stream thread holds
+ * cs->lock while it executes a batch of packets, and other threads hold it
+ * from context_acquire() to context_release(). Waiting for a packet executes
+ * the outstanding packets on the waiting thread under the same lock.
+ *
+ * GL commands are ordered between the command stream thread's context and
+ * the application's contexts with a sync object that is issued when a thread
+ * has done GL work the other thread depends on, and waited for by the next
+ * thread that acquires a context. */
+
+/* Returns whether the packet ending at "fence" is still in the queue. The
+ * counters wrap around, so compare offsets from the tail. */
+static BOOL wined3d_cs_queue_is_pending(const struct wined3d_cs_queue *queue, ULONG fence)
+{
+    ULONG tail = *(volatile const ULONG *)&queue->tail;
+
+    return fence - tail - 1 < *(volatile const ULONG *)&queue->head - tail;
+}
+
+/* Executes the packet at the tail of the queue. The caller has to hold
+ * cs->lock. */
+static void wined3d_cs_mt_execute_packet(struct wined3d_cs *cs)
+{
+    struct wined3d_cs_queue *queue = cs->queue;
+    const struct wined3d_cs_packet *packet;
+    ULONG tail = queue->tail;
+
+    packet = (const struct wined3d_cs_packet *)&queue->data[tail & (WINED3D_CS_QUEUE_SIZE - 1)];
+    if (*(const enum wined3d_cs_op *)packet->data != WINED3D_CS_OP_NOP)
+    {
+        cs->executing = TRUE;
+        wined3d_cs_execute(cs, packet->data);
+        cs->executing = FALSE;
+    }
+
+    InterlockedExchange((LONG *)&queue->tail, tail + packet->size);
+}
+
+/* Executes packets on the current thread until the packet ending at "fence"
+ * has been executed. The caller has to hold cs->lock, which excludes the
+ * command stream thread. */
+static void wined3d_cs_mt_execute_until(struct wined3d_cs *cs, ULONG fence)
+{
+    /* Called from a packet, e.g. while destroying an object. Everything
+     * before that packet has already been executed. */
+    if (cs->executing)
+        return;
+
+    while (wined3d_cs_queue_is_pending(cs->queue, fence))
+        wined3d_cs_mt_execute_packet(cs);
+}
+
+/* Makes the GL work this thread deferred fencing for visible to the command
+ * stream thread, before handing it more packets. */
+static void wined3d_cs_mt_flush_gl(struct wined3d_cs *cs)
+{
+    struct wined3d_context *context;
+
+    EnterCriticalSection(&cs->lock);
+    if (cs->gl_unfenced_tid == GetCurrentThreadId())
+    {
+        if ((context = context_get_current()) && context->valid && !context->destroyed)
+            wined3d_cs_issue_gl_fence(cs, context);
+        cs->gl_unfenced_tid = 0;
+    }
+    LeaveCriticalSection(&cs->lock);
+}
+
+static void wined3d_cs_mt_wait(struct wined3d_cs *cs, ULONG fence)
+{
+    struct wined3d_context *context;
+    ULONG tail;
+
+    if (!wined3d_cs_queue_is_pending(cs->queue, fence))
+        return;
+
+    EnterCriticalSection(&cs->lock);
+    tail = cs->queue->tail;
+    wined3d_cs_mt_execute_until(cs, fence);
+    if (tail != cs->queue->tail && (context = context_get_current()) && context->valid && !context->destroyed)
+        wined3d_cs_release_gl(cs, context);
+    LeaveCriticalSection(&cs->lock);
+}
+
+static void wined3d_cs_mt_finish(struct wined3d_cs *cs)
+{
+    wined3d_cs_mt_wait(cs, cs->queue->head);
+}
+
+static void *wined3d_cs_mt_require_space(struct wined3d_cs *cs, size_t size)
+{
+    struct wined3d_cs_queue *queue = cs->queue;
+    struct wined3d_cs_packet *packet;
+    size_t packet_size, remaining;
+
+    packet_size = (FIELD_OFFSET(struct wined3d_cs_packet, data[size]) + 15) & ~15;
+    if (packet_size > WINED3D_CS_QUEUE_SIZE / 4)
+    {
+        /* Too large for the queue, execute it on the current thread once
+         * everything submitted before it has been executed. */
+        wined3d_cs_mt_finish(cs);
+        cs->direct = TRUE;
+        return wined3d_cs_st_require_space(cs, size);
+    }
+
+    remaining = WINED3D_CS_QUEUE_SIZE - (queue->head & (WINED3D_CS_QUEUE_SIZE - 1));
+    if (remaining < packet_size)
+    {
+        /* Pad the end of the queue, packets never wrap around. */
+        packet = wined3d_cs_mt_require_space(cs, remaining - FIELD_OFFSET(struct wined3d_cs_packet, data));
+        *(enum wined3d_cs_op *)packet = WINED3D_CS_OP_NOP;
+        cs->ops->submit(cs);
+    }
+
+    /* If the queue is full, make room by executing packets on this thread. */
+    if (WINED3D_CS_QUEUE_SIZE - (queue->head - queue->tail) < packet_size)
+        wined3d_cs_mt_wait(cs, queue->head + packet_size - WINED3D_CS_QUEUE_SIZE);
+
+    packet = (struct wined3d_cs_packet *)&queue->data[queue->head & (WINED3D_CS_QUEUE_SIZE - 1)];
+    packet->size = packet_size;
+    return packet->data;
+}
+
+static void wined3d_cs_mt_submit(struct wined3d_cs *cs)
+{
+    struct wined3d_cs_queue *queue = cs->queue;
+    struct wined3d_cs_packet *packet;
+
+    if (cs->direct)
+    {
+        cs->direct = FALSE;
+        EnterCriticalSection(&cs->lock);
+        wined3d_cs_execute(cs, cs->data);
+        LeaveCriticalSection(&cs->lock);
+        return;
+    }
+
+    cs->producer_tid = GetCurrentThreadId();
+    if (cs->gl_unfenced_tid)
+        wined3d_cs_mt_flush_gl(cs);
+
+    packet = (struct wined3d_cs_packet *)&queue->data[queue->head & (WINED3D_CS_QUEUE_SIZE - 1)];
+    InterlockedExchange((LONG *)&queue->head, queue->head + packet->size);
+
+    if (cs->synchronous)
+        wined3d_cs_mt_finish(cs);
+    if (InterlockedCompareExchange(&cs->waiting_for_work, FALSE, TRUE))
+        SetEvent(cs->work_event);
+}
+
+static const struct wined3d_cs_ops wined3d_cs_mt_ops =
+{
+    wined3d_cs_mt_require_space,
+    wined3d_cs_mt_submit,
+    wined3d_cs_mt_finish,
 };
 
+static DWORD WINAPI wined3d_cs_run(void *ctx)
+{
+    struct wined3d_cs *cs = ctx;
+    struct wined3d_cs_queue *queue = cs->queue;
+    struct wined3d_context *context;
+    unsigned int count;
+
+    TRACE("Started.\n");
+
+    for (;;)
+    {
+        if (*(volatile ULONG *)&queue->head == queue->tail)
+        {
+            /* The queue is drained before the thread is stopped. */
+            if (*(volatile LONG *)&cs->stopping)
+                break;
+
+            InterlockedExchange(&cs->waiting_for_work, TRUE);
+            if (*(volatile ULONG *)&queue->head == queue->tail && !*(volatile LONG *)&cs->stopping)
+                WaitForSingleObject(cs->work_event, INFINITE);
+            InterlockedExchange(&cs->waiting_for_work, FALSE);
+            continue;
+        }
+
+        /* The application thread may have executed the packets while we
+         * were waiting for the lock. */
+        EnterCriticalSection(&cs->lock);
+        for (count = 0; count < WINED3D_CS_BATCH_SIZE && queue->tail != *(volatile ULONG *)&queue->head; ++count)
+            wined3d_cs_mt_execute_packet(cs);
+        if (count && (context = context_get_current()) && context->valid && !context->destroyed)
+            wined3d_cs_issue_gl_fence(cs, context);
+        LeaveCriticalSection(&cs->lock);
+    }
+
+    /* Release our context, so that it gets destroyed if the device is gone. */
+    context_set_current(NULL);
+
+    TRACE("Stopped.\n");
+    return 0;
+}
+
+static BOOL wined3d_cs_mt_init(struct wined3d_cs *cs)
+{
+    if (!(cs->queue = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*cs->queue))))
+        return FALSE;
+
+    InitializeCriticalSection(&cs->lock);
+    cs->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": wined3d_cs.lock");
+
+    if (!(cs->work_event = CreateEventW(NULL, FALSE, FALSE, NULL)))
+        goto fail;
+    if (!(cs->thread = CreateThread(NULL, 0, wined3d_cs_run, cs, 0, &cs->thread_id)))
+        goto fail;
+
+    cs->ops = &wined3d_cs_mt_ops;
+    return TRUE;
+
+fail:
+    ERR("Failed to create the command stream thread, falling back to single-threaded mode.\n");
+    if (cs->work_event)
+        CloseHandle(cs->work_event);
+    cs->lock.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&cs->lock);
+    HeapFree(GetProcessHeap(), 0, cs->queue);
+    cs->queue = NULL;
+    return FALSE;
+}
+
+static void wined3d_cs_mt_cleanup(struct wined3d_cs *cs)
+{
+    /* The thread doesn't need the wined3d mutex, so the caller can keep
+     * holding it while waiting. */
+    wined3d_cs_mt_finish(cs);
+    InterlockedExchange(&cs->stopping, TRUE);
+    SetEvent(cs->work_event);
+    WaitForSingleObject(cs->thread, INFINITE);
+
+    CloseHandle(cs->thread);
+    CloseHandle(cs->work_event);
+    cs->lock.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&cs->lock);
+    HeapFree(GetProcessHeap(), 0, cs->queue);
+}
+
+void wined3d_cs_finish(struct wined3d_cs *cs)
+{
+    /* The command stream doesn't exist yet or anymore while the device is
+     * being created or destroyed. */
+    if (cs)
+        cs->ops->finish(cs);
+}
+
+/* Waits until the packet ending at "fence" has been executed. */
+void wined3d_cs_wait(struct wined3d_cs *cs, ULONG fence)
+{
+    if (cs && cs->queue)
+        wined3d_cs_mt_wait(cs, fence);
+}
+
+BOOL wined3d_cs_is_executed(const struct wined3d_cs *cs, ULONG fence)
+{
+    return !cs || !cs->queue || !wined3d_cs_queue_is_pending(cs->queue, fence);
+}
+
+/* Called with cs->lock held when a thread other than the command stream
+ * thread is done with GL for now. Only packets submitted after this point
+ * can depend on the GL work, so the fence is deferred to the next submit if
+ * that comes from the same thread, which avoids a flush for every map or
+ * blit. */
+void wined3d_cs_release_gl(struct wined3d_cs *cs, struct wined3d_context *context)
+{
+    DWORD tid = GetCurrentThreadId();
+
+    if (cs->executing || tid == cs->thread_id)
+        return;
+
+    if (tid == cs->producer_tid && !(cs->device->create_parms.flags & WINED3DCREATE_MULTITHREADED))
+        cs->gl_unfenced_tid = tid;
+    else
+        wined3d_cs_issue_gl_fence(cs, context);
+}
+
+/* Makes GL commands issued by the current thread so far visible to the
+ * other threads using the command stream. Called with cs->lock held and
+ * "context" current. */
+void wined3d_cs_issue_gl_fence(struct wined3d_cs *cs, struct wined3d_context *context)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+
+    /* The new fence has to cover the work of the thread that issued the
+     * previous one as well. */
+    wined3d_cs_wait_gl_fence(cs, context);
+    if (cs->gl_fence)
+        GL_EXTCALL(glDeleteSync(cs->gl_fence));
+    cs->gl_fence = GL_EXTCALL(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    cs->gl_fence_tid = GetCurrentThreadId();
+    /* Other contexts can only wait for a sync object once it's flushed. */
+    gl_info->gl_ops.gl.p_glFlush();
+    checkGLcall("issue command stream fence");
+}
+
+void wined3d_cs_wait_gl_fence(struct wined3d_cs *cs, struct wined3d_context *context)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+
+    if (!cs->gl_fence || cs->gl_fence_tid == GetCurrentThreadId())
+        return;
+
+    GL_EXTCALL(glWaitSync(cs->gl_fence, 0, GL_TIMEOUT_IGNORED));
+    checkGLcall("glWaitSync");
+}
+
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
 {
     const struct wined3d_gl_info *gl_info = &device->adapter->gl_info;
@@ -1113,11 +1779,34 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
         return NULL;
     }
 
+    if (TRACE_ON(d3d_perf))
+        cs->stats = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*cs->stats));
+
+    /* Without sync objects there's no way to order GL commands between the
+     * command stream thread's and the application's contexts. */
+    if (wined3d_settings.cs_multithreaded && gl_info->supported[ARB_SYNC] && wined3d_cs_mt_init(cs))
+        TRACE("Using the multithreaded command stream.\n");
+
     return cs;
 }
 
 void wined3d_cs_destroy(struct wined3d_cs *cs)
 {
+    unsigned int i;
+
+    if (cs->queue)
+        wined3d_cs_mt_cleanup(cs);
+
+    if (cs->stats)
+    {
+        for (i = 0; i < ARRAY_SIZE(cs->stats->op_count); ++i)
+        {
+            if (cs->stats->op_count[i])
+                TRACE_(d3d_perf)("Executed %u ops of type %u.\n", cs->stats->op_count[i], i);
+        }
+        HeapFree(GetProcessHeap(), 0, cs->stats);
+    }
+
     state_cleanup(&cs->state);
     HeapFree(GetProcessHeap(), 0, cs->fb.render_targets);
     HeapFree(GetProcessHeap(), 0, cs->data);
@@ -403,7 +403,7 @@ void device_clear_render_targets(struct wined3d_device *device, UINT rt_count, c
             }
         }
 
-        if (!gl_info->supported[ARB_FRAMEBUFFER_SRGB] && needs_srgb_write(context, &device->state, fb))
+        if (!gl_info->supported[ARB_FRAMEBUFFER_SRGB] && needs_srgb_write(context, &device->cs->state, fb))
         {
             if (rt_count > 1)
                 WARN("Clearing multiple sRGB render targets with no GL_ARB_framebuffer_sRGB "
@@ -527,6 +527,7 @@ ULONG CDECL wined3d_device_decref(struct wined3d_device *device)
         UINT i;
 
         wined3d_cs_destroy(device->cs);
+        device->cs = NULL;
 
         if (device->recording && wined3d_stateblock_decref(device->recording))
             FIXME("Something's still holding the recording stateblock.\n");
@@ -1140,6 +1141,8 @@ HRESULT CDECL wined3d_device_uninit_3d(struct wined3d_device *device)
     if (device->cursor_texture)
         wined3d_texture_decref(device->cursor_texture);
 
+    wined3d_cs_finish(device->cs);
+    state_unbind_resources(&device->cs->state);
     state_unbind_resources(&device->state);
 
     /* Unload resources */
@@ -1221,6 +1224,11 @@ HRESULT CDECL wined3d_device_uninit_3d(struct wined3d_device *device)
     device->swapchains = NULL;
     device->swapchain_count = 0;
 
+    /* The command stream's GL fence went away together with the contexts. */
+    wined3d_cs_finish(device->cs);
+    device->cs->gl_fence = NULL;
+    device->cs->gl_unfenced_tid = 0;
+
     HeapFree(GetProcessHeap(), 0, device->fb.render_targets);
     device->fb.render_targets = NULL;
 
@@ -1610,14 +1618,6 @@ HRESULT CDECL wined3d_device_set_light(struct wined3d_device *device,
     TRACE("... Range(%f), Falloff(%f), Theta(%f), Phi(%f)\n",
             light->range, light->falloff, light->theta, light->phi);
 
-    /* Update the live definitions if the light is currently assigned a glIndex. */
-    if (object->glIndex != -1 && !device->recording)
-    {
-        if (object->OriginalParms.type != light->type)
-            device_invalidate_state(device, STATE_LIGHT_TYPE);
-        device_invalidate_state(device, STATE_ACTIVELIGHT(object->glIndex));
-    }
-
     /* Save away the information. */
     object->OriginalParms = *light;
 
@@ -1697,6 +1697,9 @@ HRESULT CDECL wined3d_device_set_light(struct wined3d_device *device,
             FIXME("Unrecognized light type %#x.\n", light->type);
     }
 
+    if (!device->recording)
+        wined3d_cs_emit_set_light(device->cs, object);
+
     return WINED3D_OK;
 }
 
@@ -1769,12 +1772,6 @@ HRESULT CDECL wined3d_device_set_light_enable(struct wined3d_device *device, UIN
     {
         if (light_info->glIndex != -1)
         {
-            if (!device->recording)
-            {
-                device_invalidate_state(device, STATE_LIGHT_TYPE);
-                device_invalidate_state(device, STATE_ACTIVELIGHT(light_info->glIndex));
-            }
-
             device->update_state->lights[light_info->glIndex] = NULL;
             light_info->glIndex = -1;
         }
@@ -1814,18 +1811,13 @@ HRESULT CDECL wined3d_device_set_light_enable(struct wined3d_device *device, UIN
                  *
                  * TODO: Test how this affects rendering. */
                 WARN("Too many concurrently active lights\n");
-                return WINED3D_OK;
-            }
-
-            /* i == light_info->glIndex */
-            if (!device->recording)
-            {
-                device_invalidate_state(device, STATE_LIGHT_TYPE);
-                device_invalidate_state(device, STATE_ACTIVELIGHT(i));
             }
         }
     }
 
+    if (!device->recording)
+        wined3d_cs_emit_set_light(device->cs, light_info);
+
     return WINED3D_OK;
 }
 
@@ -2373,7 +2365,7 @@ struct wined3d_sampler * CDECL wined3d_device_get_vs_sampler(const struct wined3
     return device->state.sampler[WINED3D_SHADER_TYPE_VERTEX][idx];
 }
 
-static void device_invalidate_shader_constants(const struct wined3d_device *device, DWORD mask)
+void device_invalidate_shader_constants(const struct wined3d_device *device, DWORD mask)
 {
     UINT i;
 
@@ -2406,7 +2398,7 @@ HRESULT CDECL wined3d_device_set_vs_consts_b(struct wined3d_device *device,
     }
     else
     {
-        device_invalidate_shader_constants(device, WINED3D_SHADER_CONST_VS_B);
+        wined3d_cs_emit_set_constants(device->cs, WINED3D_SHADER_CONST_VS_B, start_register, count, constants);
     }
 
     return WINED3D_OK;
@@ -2453,7 +2445,7 @@ HRESULT CDECL wined3d_device_set_vs_consts_i(struct wined3d_device *device,
     }
     else
     {
-        device_invalidate_shader_constants(device, WINED3D_SHADER_CONST_VS_I);
+        wined3d_cs_emit_set_constants(device->cs, WINED3D_SHADER_CONST_VS_I, start_register, count, constants);
     }
 
     return WINED3D_OK;
@@ -2504,7 +2496,8 @@ HRESULT CDECL wined3d_device_set_vs_consts_f(struct wined3d_device *device,
         memset(device->recording->changed.vertexShaderConstantsF + start_register, 1,
                 sizeof(*device->recording->changed.vertexShaderConstantsF) * vector4f_count);
     else
-        device->shader_backend->shader_update_float_vertex_constants(device, start_register, vector4f_count);
+        wined3d_cs_emit_set_constants(device->cs, WINED3D_SHADER_CONST_VS_F,
+                start_register, vector4f_count, constants);
 
 
     return WINED3D_OK;
@@ -2640,7 +2633,7 @@ HRESULT CDECL wined3d_device_set_ps_consts_b(struct wined3d_device *device,
     }
     else
     {
-        device_invalidate_shader_constants(device, WINED3D_SHADER_CONST_PS_B);
+        wined3d_cs_emit_set_constants(device->cs, WINED3D_SHADER_CONST_PS_B, start_register, count, constants);
     }
 
     return WINED3D_OK;
@@ -2687,7 +2680,7 @@ HRESULT CDECL wined3d_device_set_ps_consts_i(struct wined3d_device *device,
     }
     else
     {
-        device_invalidate_shader_constants(device, WINED3D_SHADER_CONST_PS_I);
+        wined3d_cs_emit_set_constants(device->cs, WINED3D_SHADER_CONST_PS_I, start_register, count, constants);
     }
 
     return WINED3D_OK;
@@ -2739,7 +2732,8 @@ HRESULT CDECL wined3d_device_set_ps_consts_f(struct wined3d_device *device,
         memset(device->recording->changed.pixelShaderConstantsF + start_register, 1,
                 sizeof(*device->recording->changed.pixelShaderConstantsF) * vector4f_count);
     else
-        device->shader_backend->shader_update_float_pixel_constants(device, start_register, vector4f_count);
+        wined3d_cs_emit_set_constants(device->cs, WINED3D_SHADER_CONST_PS_F,
+                start_register, vector4f_count, constants);
 
     return WINED3D_OK;
 }
@@ -3134,6 +3128,8 @@ HRESULT CDECL wined3d_device_process_vertices(struct wined3d_device *device,
     if (declaration)
         FIXME("Output vertex declaration not implemented yet.\n");
 
+    wined3d_cs_finish(device->cs);
+
     /* Need any context to write to the vbo. */
     context = context_acquire(device, NULL);
     gl_info = context->gl_info;
@@ -3474,17 +3470,12 @@ struct wined3d_query * CDECL wined3d_device_get_predication(struct wined3d_devic
 void CDECL wined3d_device_set_primitive_type(struct wined3d_device *device,
         enum wined3d_primitive_type primitive_type)
 {
-    GLenum gl_primitive_type, prev;
-
     TRACE("device %p, primitive_type %s\n", device, debug_d3dprimitivetype(primitive_type));
 
-    gl_primitive_type = gl_primitive_type_from_d3d(primitive_type);
-    prev = device->update_state->gl_primitive_type;
-    device->update_state->gl_primitive_type = gl_primitive_type;
+    /* The command stream picks the primitive type up with the next draw. */
+    device->update_state->gl_primitive_type = gl_primitive_type_from_d3d(primitive_type);
     if (device->recording)
         device->recording->changed.primitive_type = TRUE;
-    else if (gl_primitive_type != prev && (gl_primitive_type == GL_POINTS || prev == GL_POINTS))
-        device_invalidate_state(device, STATE_POINT_ENABLE);
 }
 
 void CDECL wined3d_device_get_primitive_type(const struct wined3d_device *device,
@@ -3507,11 +3498,7 @@ HRESULT CDECL wined3d_device_draw_primitive(struct wined3d_device *device, UINT
         return WINED3DERR_INVALIDCALL;
     }
 
-    if (device->state.load_base_vertex_index)
-    {
-        device->state.load_base_vertex_index = 0;
-        device_invalidate_state(device, STATE_BASEVERTEXINDEX);
-    }
+    device->state.load_base_vertex_index = 0;
 
     wined3d_cs_emit_draw(device->cs, start_vertex, vertex_count, 0, 0, FALSE);
 
@@ -3549,12 +3536,8 @@ HRESULT CDECL wined3d_device_draw_indexed_primitive(struct wined3d_device *devic
         return WINED3DERR_INVALIDCALL;
     }
 
-    if (!gl_info->supported[ARB_DRAW_ELEMENTS_BASE_VERTEX] &&
-        device->state.load_base_vertex_index != device->state.base_vertex_index)
-    {
+    if (!gl_info->supported[ARB_DRAW_ELEMENTS_BASE_VERTEX])
         device->state.load_base_vertex_index = device->state.base_vertex_index;
-        device_invalidate_state(device, STATE_BASEVERTEXINDEX);
-    }
 
     wined3d_cs_emit_draw(device->cs, start_idx, index_count, 0, 0, TRUE);
 
@@ -3676,6 +3659,9 @@ HRESULT CDECL wined3d_device_update_texture(struct wined3d_device *device,
         ++src_skip_levels;
     }
 
+    wined3d_resource_wait_idle(&src_texture->resource);
+    wined3d_resource_wait_idle(&dst_texture->resource);
+
     /* Make sure that the destination texture is loaded. */
     context = context_acquire(device, NULL);
     wined3d_texture_load(dst_texture, context, FALSE);
@@ -4056,6 +4042,8 @@ void CDECL wined3d_device_update_sub_resource(struct wined3d_device *device, str
     TRACE("device %p, resource %p, sub_resource_idx %u, box %s, data %p, row_pitch %u, depth_pitch %u.\n",
             device, resource, sub_resource_idx, debug_box(box), data, row_pitch, depth_pitch);
 
+    wined3d_resource_wait_idle(resource);
+
     if (resource->type == WINED3D_RTYPE_BUFFER)
     {
         struct wined3d_buffer *buffer = buffer_from_resource(resource);
@@ -4163,6 +4151,7 @@ HRESULT CDECL wined3d_device_clear_rendertarget_view(struct wined3d_device *devi
         rect = &r;
     }
 
+    wined3d_resource_wait_idle(resource);
     resource = wined3d_texture_get_sub_resource(wined3d_texture_from_resource(resource), view->sub_resource_idx);
 
     return surface_color_fill(surface_from_resource(resource), rect, color);
@@ -4328,6 +4317,9 @@ HRESULT CDECL wined3d_device_set_cursor_properties(struct wined3d_device *device
 
     cursor_image = surface_from_resource(sub_resource);
 
+    /* Presents still in the queue use the current cursor texture. */
+    wined3d_cs_finish(device->cs);
+
     if (device->cursor_texture)
     {
         wined3d_texture_decref(device->cursor_texture);
@@ -4484,6 +4476,8 @@ void CDECL wined3d_device_evict_managed_resources(struct wined3d_device *device)
 
     TRACE("device %p.\n", device);
 
+    wined3d_cs_finish(device->cs);
+
     LIST_FOR_EACH_ENTRY_SAFE(resource, cursor, &device->resources, struct wined3d_resource, resource_list_entry)
     {
         TRACE("Checking resource %p for eviction.\n", resource);
@@ -4506,6 +4500,8 @@ static void delete_opengl_contexts(struct wined3d_device *device, struct wined3d
     struct wined3d_context *context;
     struct wined3d_shader *shader;
 
+    wined3d_cs_finish(device->cs);
+
     context = context_acquire(device, NULL);
     gl_info = context->gl_info;
 
@@ -4538,6 +4534,9 @@ static void delete_opengl_contexts(struct wined3d_device *device, struct wined3d
     {
         swapchain_destroy_contexts(device->contexts[0]->swapchain);
     }
+    /* The command stream's GL fence went away together with the contexts. */
+    device->cs->gl_fence = NULL;
+    device->cs->gl_unfenced_tid = 0;
 
     HeapFree(GetProcessHeap(), 0, swapchain->context);
     swapchain->context = NULL;
@@ -4628,6 +4627,8 @@ HRESULT CDECL wined3d_device_reset(struct wined3d_device *device,
             wined3d_texture_decref(device->cursor_texture);
             device->cursor_texture = NULL;
         }
+        wined3d_cs_finish(device->cs);
+        state_unbind_resources(&device->cs->state);
         state_unbind_resources(&device->state);
     }
 
@@ -24,69 +24,163 @@
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
 
 static void* txc_dxtn_handle;
-static void (*pfetch_2d_texel_rgba_dxt1)(int srcRowStride, const BYTE *pixData, int i, int j, DWORD *texel);
-static void (*pfetch_2d_texel_rgba_dxt3)(int srcRowStride, const BYTE *pixData, int i, int j, DWORD *texel);
-static void (*pfetch_2d_texel_rgba_dxt5)(int srcRowStride, const BYTE *pixData, int i, int j, DWORD *texel);
 static void (*ptx_compress_dxtn)(int comps, int width, int height, const BYTE *srcPixData,
                                  GLenum destformat, BYTE *dest, int dstRowStride);
 
-static inline BOOL dxt1_to_x8r8g8b8(const BYTE *src, BYTE *dst, DWORD pitch_in,
-        DWORD pitch_out, unsigned int w, unsigned int h, BOOL alpha)
+/* Built-in S3TC block codec. Decoding always goes through it, since it works
+ * on whole 4x4 blocks and is much faster than fetching single texels from
+ * libtxc_dxtn. The encoder is only used when libtxc_dxtn is not available. */
+
+static inline DWORD dxtn_rgb565_to_argb(WORD c)
 {
-    unsigned int x, y;
-    DWORD color;
+    DWORD r = (c >> 11) & 0x1f, g = (c >> 5) & 0x3f, b = c & 0x1f;
 
-    TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    return 0xff000000 | (r << 16) | (g << 8) | b;
+}
 
-    for (y = 0; y < h; ++y)
+static inline DWORD dxtn_mix_argb(DWORD c0, DWORD c1, unsigned int w0, unsigned int w1, unsigned int div)
+{
+    DWORD r = (((c0 >> 16) & 0xff) * w0 + ((c1 >> 16) & 0xff) * w1) / div;
+    DWORD g = (((c0 >> 8) & 0xff) * w0 + ((c1 >> 8) & 0xff) * w1) / div;
+    DWORD b = ((c0 & 0xff) * w0 + (c1 & 0xff) * w1) / div;
+
+    return 0xff000000 | (r << 16) | (g << 8) | b;
+}
+
+static void dxtn_color_palette(WORD c0, WORD c1, BOOL four_colors, DWORD *palette)
+{
+    palette[0] = dxtn_rgb565_to_argb(c0);
+    palette[1] = dxtn_rgb565_to_argb(c1);
+    if (four_colors)
     {
-        DWORD *dst_line = (DWORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
-        {
-            /* pfetch_2d_texel_rgba_dxt1 doesn't correctly handle pitch */
-            pfetch_2d_texel_rgba_dxt1(0, src + (y / 4) * pitch_in + (x / 4) * 8,
-                                      x & 3, y & 3, &color);
-            if (alpha)
-            {
-                dst_line[x] = (color & 0xff00ff00) | ((color & 0xff) << 16) |
-                              ((color & 0xff0000) >> 16);
-            }
-            else
-            {
-                dst_line[x] = 0xff000000 | ((color & 0xff) << 16) |
-                              (color & 0xff00) | ((color & 0xff0000) >> 16);
-            }
-        }
+        palette[2] = dxtn_mix_argb(palette[0], palette[1], 2, 1, 3);
+        palette[3] = dxtn_mix_argb(palette[0], palette[1], 1, 2, 3);
     }
+    else
+    {
+        palette[2] = dxtn_mix_argb(palette[0], palette[1], 1, 1, 2);
+        palette[3] = 0;
+    }
+}
 
-    return TRUE;
+static void dxtn_alpha_palette(BYTE a0, BYTE a1, BYTE *palette)
+{
+    unsigned int i;
+
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for (i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+    }
+    else
+    {
+        for (i = 2; i < 6; ++i)
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+        palette[6] = 0x00;
+        palette[7] = 0xff;
+    }
 }
 
-static inline BOOL dxt1_to_x4r4g4b4(const BYTE *src, BYTE *dst, DWORD pitch_in,
-        DWORD pitch_out, unsigned int w, unsigned int h, BOOL alpha)
+/* Decodes a 4x4 block to A8R8G8B8 texels, in row major order. */
+static void dxtn_decode_block(const BYTE *block, unsigned int dxt, DWORD *texels)
 {
-    unsigned int x, y;
-    DWORD color;
+    const BYTE *color = dxt == 1 ? block : block + 8;
+    WORD c0 = color[0] | (color[1] << 8);
+    WORD c1 = color[2] | (color[3] << 8);
+    DWORD indices = color[4] | (color[5] << 8) | (color[6] << 16) | ((DWORD)color[7] << 24);
+    DWORD palette[4];
+    unsigned int i;
+
+    /* The three color mode only exists for DXT1. */
+    dxtn_color_palette(c0, c1, dxt != 1 || c0 > c1, palette);
+    for (i = 0; i < 16; ++i, indices >>= 2)
+        texels[i] = palette[indices & 3];
+
+    if (dxt == 3)
+    {
+        for (i = 0; i < 16; ++i)
+            texels[i] = (texels[i] & 0x00ffffff) | ((((block[i / 2] >> ((i & 1) * 4)) & 0xf) * 0x11u) << 24);
+    }
+    else if (dxt == 5)
+    {
+        ULONGLONG alpha_indices = 0;
+        BYTE alpha[8];
+
+        dxtn_alpha_palette(block[0], block[1], alpha);
+        for (i = 7; i >= 2; --i)
+            alpha_indices = (alpha_indices << 8) | block[i];
+        for (i = 0; i < 16; ++i, alpha_indices >>= 3)
+            texels[i] = (texels[i] & 0x00ffffff) | ((DWORD)alpha[alpha_indices & 7] << 24);
+    }
+}
+
+static BOOL dxtn_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
+        enum wined3d_format_id format, unsigned int w, unsigned int h, unsigned int dxt)
+{
+    unsigned int block_size = dxt == 1 ? 8 : 16;
+    unsigned int x, y, i, j, bw, bh;
+    DWORD texels[16], c;
 
     TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
 
-    for (y = 0; y < h; ++y)
+    for (y = 0; y < h; y += 4)
     {
-        WORD *dst_line = (WORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        const BYTE *block = src + (y / 4) * pitch_in;
+
+        bh = min(4, h - y);
+        for (x = 0; x < w; x += 4, block += block_size)
         {
-            /* pfetch_2d_texel_rgba_dxt1 doesn't correctly handle pitch */
-            pfetch_2d_texel_rgba_dxt1(0, src + (y / 4) * pitch_in + (x / 4) * 16,
-                                      x & 3, y & 3, &color);
-            if (alpha)
-            {
-                dst_line[x] = ((color & 0xf0000000) >> 16) | ((color & 0xf00000) >> 20) |
-                              ((color & 0xf000) >> 8) | ((color & 0xf0) << 4);
-            }
-            else
+            dxtn_decode_block(block, dxt, texels);
+            bw = min(4, w - x);
+
+            for (j = 0; j < bh; ++j)
             {
-                dst_line[x] = 0xf000  | ((color & 0xf00000) >> 20) |
-                              ((color & 0xf000) >> 8) | ((color & 0xf0) << 4);
+                const DWORD *row = &texels[j * 4];
+                BYTE *dst_row = dst + (y + j) * pitch_out;
+
+                switch (format)
+                {
+                    case WINED3DFMT_B8G8R8A8_UNORM:
+                        memcpy((DWORD *)dst_row + x, row, bw * sizeof(*row));
+                        break;
+
+                    case WINED3DFMT_B8G8R8X8_UNORM:
+                        for (i = 0; i < bw; ++i)
+                            ((DWORD *)dst_row)[x + i] = row[i] | 0xff000000;
+                        break;
+
+                    case WINED3DFMT_B4G4R4A4_UNORM:
+                    case WINED3DFMT_B4G4R4X4_UNORM:
+                        for (i = 0; i < bw; ++i)
+                        {
+                            c = row[i];
+                            if (format == WINED3DFMT_B4G4R4X4_UNORM)
+                                c |= 0xff000000;
+                            ((WORD *)dst_row)[x + i] = ((c >> 16) & 0xf000) | ((c >> 12) & 0x0f00)
+                                    | ((c >> 8) & 0x00f0) | ((c >> 4) & 0x000f);
+                        }
+                        break;
+
+                    case WINED3DFMT_B5G5R5A1_UNORM:
+                    case WINED3DFMT_B5G5R5X1_UNORM:
+                        for (i = 0; i < bw; ++i)
+                        {
+                            c = row[i];
+                            if (format == WINED3DFMT_B5G5R5X1_UNORM)
+                                c |= 0xff000000;
+                            ((WORD *)dst_row)[x + i] = ((c >> 16) & 0x8000) | ((c >> 9) & 0x7c00)
+                                    | ((c >> 6) & 0x03e0) | ((c >> 3) & 0x001f);
+                        }
+                        break;
+
+                    default:
+                        return FALSE;
+                }
             }
         }
     }
@@ -94,127 +188,224 @@ static inline BOOL dxt1_to_x4r4g4b4(const BYTE *src, BYTE *dst, DWORD pitch_in,
     return TRUE;
 }
 
-static inline BOOL dxt1_to_x1r5g5b5(const BYTE *src, BYTE *dst, DWORD pitch_in,
-        DWORD pitch_out, unsigned int w, unsigned int h, BOOL alpha)
+static inline WORD dxtn_argb_to_rgb565(unsigned int r, unsigned int g, unsigned int b)
 {
-    unsigned int x, y;
-    DWORD color;
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
 
-    TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
+static inline unsigned int dxtn_color_distance(DWORD c0, DWORD c1)
+{
+    int r = (int)((c0 >> 16) & 0xff) - (int)((c1 >> 16) & 0xff);
+    int g = (int)((c0 >> 8) & 0xff) - (int)((c1 >> 8) & 0xff);
+    int b = (int)(c0 & 0xff) - (int)(c1 & 0xff);
 
-    for (y = 0; y < h; ++y)
+    return r * r + g * g + b * b;
+}
+
+/* Range fit: the endpoints are the corners of the (slightly inset) bounding
+ * box of the block's colors, each texel picks the nearest palette entry. */
+static void dxtn_encode_color_block(const DWORD *texels, BOOL punch_through, BYTE *block)
+{
+    unsigned int min_c[3] = {0xff, 0xff, 0xff}, max_c[3] = {0, 0, 0};
+    unsigned int i, j, k, count = 0, best, best_dist, dist, inset;
+    BOOL transparent = FALSE;
+    DWORD indices = 0, palette[4];
+    WORD c0, c1, tmp;
+
+    for (i = 0; i < 16; ++i)
     {
-        WORD *dst_line = (WORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        if (punch_through && texels[i] < 0x80000000)
         {
-            /* pfetch_2d_texel_rgba_dxt1 doesn't correctly handle pitch */
-            pfetch_2d_texel_rgba_dxt1(0, src + (y / 4) * pitch_in + (x / 4) * 16,
-                                      x & 3, y & 3, &color);
-            if (alpha)
-            {
-                dst_line[x] = ((color & 0x80000000) >> 16) | ((color & 0xf80000) >> 19) |
-                              ((color & 0xf800) >> 6) | ((color & 0xf8) << 7);
-            }
-            else
-            {
-                dst_line[x] = 0x8000 | ((color & 0xf80000) >> 19) |
-                              ((color & 0xf800) >> 6) | ((color & 0xf8) << 7);
-            }
+            transparent = TRUE;
+            continue;
+        }
+        for (k = 0; k < 3; ++k)
+        {
+            unsigned int v = (texels[i] >> (16 - k * 8)) & 0xff;
+            min_c[k] = min(min_c[k], v);
+            max_c[k] = max(max_c[k], v);
         }
+        ++count;
     }
 
-    return TRUE;
-}
+    if (!count)
+    {
+        /* Fully transparent block. */
+        memset(block, 0, 4);
+        memset(block + 4, 0xff, 4);
+        return;
+    }
 
-static inline BOOL dxt3_to_x8r8g8b8(const BYTE *src, BYTE *dst, DWORD pitch_in,
-        DWORD pitch_out, unsigned int w, unsigned int h, BOOL alpha)
-{
-    unsigned int x, y;
-    DWORD color;
+    for (k = 0; k < 3; ++k)
+    {
+        inset = (max_c[k] - min_c[k]) >> 4;
+        min_c[k] += inset;
+        max_c[k] -= inset;
+    }
+    c0 = dxtn_argb_to_rgb565(max_c[0], max_c[1], max_c[2]);
+    c1 = dxtn_argb_to_rgb565(min_c[0], min_c[1], min_c[2]);
 
-    TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
+    if (transparent)
+    {
+        /* The three color mode is selected by c0 <= c1. */
+        if (c0 > c1)
+        {
+            tmp = c0; c0 = c1; c1 = tmp;
+        }
+    }
+    else if (c0 < c1)
+    {
+        tmp = c0; c0 = c1; c1 = tmp;
+    }
+    dxtn_color_palette(c0, c1, c0 > c1, palette);
 
-    for (y = 0; y < h; ++y)
+    if (c0 != c1 || transparent)
     {
-        DWORD *dst_line = (DWORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        for (i = 0; i < 16; ++i)
         {
-            /* pfetch_2d_texel_rgba_dxt3 doesn't correctly handle pitch */
-            pfetch_2d_texel_rgba_dxt3(0, src + (y / 4) * pitch_in + (x / 4) * 16,
-                                      x & 3, y & 3, &color);
-            if (alpha)
+            if (transparent && texels[i] < 0x80000000)
             {
-                dst_line[x] = (color & 0xff00ff00) | ((color & 0xff) << 16) |
-                              ((color & 0xff0000) >> 16);
+                best = 3;
             }
             else
             {
-                dst_line[x] = 0xff000000 | ((color & 0xff) << 16) |
-                              (color & 0xff00) | ((color & 0xff0000) >> 16);
+                best = 0;
+                best_dist = ~0u;
+                for (j = 0; j < (c0 > c1 ? 4u : 3u); ++j)
+                {
+                    if ((dist = dxtn_color_distance(texels[i], palette[j])) < best_dist)
+                    {
+                        best = j;
+                        best_dist = dist;
+                    }
+                }
             }
+            indices |= best << (i * 2);
         }
     }
 
-    return TRUE;
+    block[0] = c0 & 0xff;
+    block[1] = c0 >> 8;
+    block[2] = c1 & 0xff;
+    block[3] = c1 >> 8;
+    block[4] = indices & 0xff;
+    block[5] = (indices >> 8) & 0xff;
+    block[6] = (indices >> 16) & 0xff;
+    block[7] = indices >> 24;
 }
 
-static inline BOOL dxt3_to_x4r4g4b4(const BYTE *src, BYTE *dst, DWORD pitch_in,
-        DWORD pitch_out, unsigned int w, unsigned int h, BOOL alpha)
+static void dxtn_encode_alpha_block(const DWORD *texels, BYTE *block)
 {
-    unsigned int x, y;
-    DWORD color;
+    unsigned int i, j, best, best_dist, dist;
+    BYTE a0 = 0, a1 = 0xff, a, palette[8];
+    ULONGLONG indices = 0;
 
-    TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
+    for (i = 0; i < 16; ++i)
+    {
+        a = texels[i] >> 24;
+        a0 = max(a0, a);
+        a1 = min(a1, a);
+    }
 
-    for (y = 0; y < h; ++y)
+    dxtn_alpha_palette(a0, a1, palette);
+    if (a0 != a1)
     {
-        WORD *dst_line = (WORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        for (i = 0; i < 16; ++i)
         {
-            /* pfetch_2d_texel_rgba_dxt3 doesn't correctly handle pitch */
-            pfetch_2d_texel_rgba_dxt3(0, src + (y / 4) * pitch_in + (x / 4) * 16,
-                                      x & 3, y & 3, &color);
-            if (alpha)
+            a = texels[i] >> 24;
+            best = 0;
+            best_dist = ~0u;
+            for (j = 0; j < 8; ++j)
             {
-                dst_line[x] = ((color & 0xf0000000) >> 16) | ((color & 0xf00000) >> 20) |
-                              ((color & 0xf000) >> 8) | ((color & 0xf0) << 4);
-            }
-            else
-            {
-                dst_line[x] = 0xf000  | ((color & 0xf00000) >> 20) |
-                              ((color & 0xf000) >> 8) | ((color & 0xf0) << 4);
+                dist = abs((int)a - (int)palette[j]);
+                if (dist < best_dist)
+                {
+                    best = j;
+                    best_dist = dist;
+                }
             }
+            indices |= (ULONGLONG)best << (i * 3);
         }
     }
 
-    return TRUE;
+    block[0] = a0;
+    block[1] = a1;
+    for (i = 2; i < 8; ++i, indices >>= 8)
+        block[i] = indices & 0xff;
 }
 
-static inline BOOL dxt5_to_x8r8g8b8(const BYTE *src, BYTE *dst, DWORD pitch_in,
-        DWORD pitch_out, unsigned int w, unsigned int h, BOOL alpha)
+static BOOL dxtn_encode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
+        enum wined3d_format_id format, unsigned int w, unsigned int h, GLenum destformat)
 {
-    unsigned int x, y;
-    DWORD color;
+    unsigned int x, y, i, j, block_size = 16;
+    DWORD texels[16], c;
+    BYTE *block;
 
     TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
 
-    for (y = 0; y < h; ++y)
+    if (destformat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || destformat == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)
+        block_size = 8;
+
+    for (y = 0; y < h; y += 4)
     {
-        DWORD *dst_line = (DWORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        block = dst + (y / 4) * pitch_out;
+        for (x = 0; x < w; x += 4, block += block_size)
         {
-            /* pfetch_2d_texel_rgba_dxt5 doesn't correctly handle pitch */
-            pfetch_2d_texel_rgba_dxt5(0, src + (y / 4) * pitch_in + (x / 4) * 16,
-                                      x & 3, y & 3, &color);
-            if (alpha)
+            /* Partial blocks at the edges replicate the last row or column. */
+            for (j = 0; j < 4; ++j)
             {
-                dst_line[x] = (color & 0xff00ff00) | ((color & 0xff) << 16) |
-                              ((color & 0xff0000) >> 16);
+                const BYTE *src_row = src + min(y + j, h - 1) * pitch_in;
+
+                for (i = 0; i < 4; ++i)
+                {
+                    unsigned int sx = min(x + i, w - 1);
+
+                    switch (format)
+                    {
+                        case WINED3DFMT_B8G8R8A8_UNORM:
+                            c = ((const DWORD *)src_row)[sx];
+                            break;
+                        case WINED3DFMT_B8G8R8X8_UNORM:
+                            c = ((const DWORD *)src_row)[sx] | 0xff000000;
+                            break;
+                        case WINED3DFMT_B5G5R5A1_UNORM:
+                        case WINED3DFMT_B5G5R5X1_UNORM:
+                        {
+                            WORD v = ((const WORD *)src_row)[sx];
+                            DWORD r = (v >> 10) & 0x1f, g = (v >> 5) & 0x1f, b = v & 0x1f;
+
+                            c = (((r << 3) | (r >> 2)) << 16) | (((g << 3) | (g >> 2)) << 8) | ((b << 3) | (b >> 2));
+                            if (format == WINED3DFMT_B5G5R5X1_UNORM || (v & 0x8000))
+                                c |= 0xff000000;
+                            break;
+                        }
+                        default:
+                            return FALSE;
+                    }
+                    texels[j * 4 + i] = c;
+                }
             }
-            else
+
+            switch (destformat)
             {
-                dst_line[x] = 0xff000000 | ((color & 0xff) << 16) |
-                              (color & 0xff00) | ((color & 0xff0000) >> 16);
+                case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                    dxtn_encode_color_block(texels, FALSE, block);
+                    break;
+                case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                    dxtn_encode_color_block(texels, TRUE, block);
+                    break;
+                case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+                    for (i = 0; i < 8; ++i)
+                        block[i] = ((texels[i * 2] >> 24) * 15 + 127) / 255
+                                | (((texels[i * 2 + 1] >> 24) * 15 + 127) / 255) << 4;
+                    dxtn_encode_color_block(texels, FALSE, block + 8);
+                    break;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                    dxtn_encode_alpha_block(texels, block);
+                    dxtn_encode_color_block(texels, FALSE, block + 8);
+                    break;
+                default:
+                    return FALSE;
             }
         }
     }
@@ -314,26 +505,31 @@ static inline BOOL x1r5g5b5_to_dxtn(const BYTE *src, BYTE *dst, DWORD pitch_in,
     return TRUE;
 }
 
-BOOL wined3d_dxt1_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
-        enum wined3d_format_id format, unsigned int w, unsigned int h)
+static BOOL encode_dxtn(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
+        enum wined3d_format_id format, unsigned int w, unsigned int h, GLenum destformat)
 {
+    BOOL alpha = format == WINED3DFMT_B8G8R8A8_UNORM || format == WINED3DFMT_B5G5R5A1_UNORM;
+
     if (!txc_dxtn_handle)
-        return FALSE;
+        return dxtn_encode(src, dst, pitch_in, pitch_out, format, w, h, destformat);
+
+    if (format == WINED3DFMT_B5G5R5A1_UNORM || format == WINED3DFMT_B5G5R5X1_UNORM)
+        return x1r5g5b5_to_dxtn(src, dst, pitch_in, pitch_out, w, h, destformat, alpha);
+    return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h, destformat, alpha);
+}
 
+BOOL wined3d_dxt1_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
+        enum wined3d_format_id format, unsigned int w, unsigned int h)
+{
     switch (format)
     {
         case WINED3DFMT_B8G8R8A8_UNORM:
-            return dxt1_to_x8r8g8b8(src, dst, pitch_in, pitch_out, w, h, TRUE);
         case WINED3DFMT_B8G8R8X8_UNORM:
-            return dxt1_to_x8r8g8b8(src, dst, pitch_in, pitch_out, w, h, FALSE);
         case WINED3DFMT_B4G4R4A4_UNORM:
-            return dxt1_to_x4r4g4b4(src, dst, pitch_in, pitch_out, w, h, TRUE);
         case WINED3DFMT_B4G4R4X4_UNORM:
-            return dxt1_to_x4r4g4b4(src, dst, pitch_in, pitch_out, w, h, FALSE);
         case WINED3DFMT_B5G5R5A1_UNORM:
-            return dxt1_to_x1r5g5b5(src, dst, pitch_in, pitch_out, w, h, TRUE);
         case WINED3DFMT_B5G5R5X1_UNORM:
-            return dxt1_to_x1r5g5b5(src, dst, pitch_in, pitch_out, w, h, FALSE);
+            return dxtn_decode(src, dst, pitch_in, pitch_out, format, w, h, 1);
         default:
             break;
     }
@@ -345,19 +541,13 @@ BOOL wined3d_dxt1_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch
 BOOL wined3d_dxt3_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
         enum wined3d_format_id format, unsigned int w, unsigned int h)
 {
-    if (!txc_dxtn_handle)
-        return FALSE;
-
     switch (format)
     {
         case WINED3DFMT_B8G8R8A8_UNORM:
-            return dxt3_to_x8r8g8b8(src, dst, pitch_in, pitch_out, w, h, TRUE);
         case WINED3DFMT_B8G8R8X8_UNORM:
-            return dxt3_to_x8r8g8b8(src, dst, pitch_in, pitch_out, w, h, FALSE);
         case WINED3DFMT_B4G4R4A4_UNORM:
-            return dxt3_to_x4r4g4b4(src, dst, pitch_in, pitch_out, w, h, TRUE);
         case WINED3DFMT_B4G4R4X4_UNORM:
-            return dxt3_to_x4r4g4b4(src, dst, pitch_in, pitch_out, w, h, FALSE);
+            return dxtn_decode(src, dst, pitch_in, pitch_out, format, w, h, 3);
         default:
             break;
     }
@@ -369,15 +559,11 @@ BOOL wined3d_dxt3_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch
 BOOL wined3d_dxt5_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
         enum wined3d_format_id format, unsigned int w, unsigned int h)
 {
-    if (!txc_dxtn_handle)
-        return FALSE;
-
     switch (format)
     {
         case WINED3DFMT_B8G8R8A8_UNORM:
-            return dxt5_to_x8r8g8b8(src, dst, pitch_in, pitch_out, w, h, TRUE);
         case WINED3DFMT_B8G8R8X8_UNORM:
-            return dxt5_to_x8r8g8b8(src, dst, pitch_in, pitch_out, w, h, FALSE);
+            return dxtn_decode(src, dst, pitch_in, pitch_out, format, w, h, 5);
         default:
             break;
     }
@@ -389,23 +575,16 @@ BOOL wined3d_dxt5_decode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch
 BOOL wined3d_dxt1_encode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
         enum wined3d_format_id format, unsigned int w, unsigned int h)
 {
-    if (!txc_dxtn_handle)
-        return FALSE;
-
     switch (format)
     {
         case WINED3DFMT_B8G8R8A8_UNORM:
-            return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, TRUE);
-        case WINED3DFMT_B8G8R8X8_UNORM:
-            return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGB_S3TC_DXT1_EXT, FALSE);
         case WINED3DFMT_B5G5R5A1_UNORM:
-            return x1r5g5b5_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, TRUE);
+            return encode_dxtn(src, dst, pitch_in, pitch_out, format, w, h,
+                               GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+        case WINED3DFMT_B8G8R8X8_UNORM:
         case WINED3DFMT_B5G5R5X1_UNORM:
-            return x1r5g5b5_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGB_S3TC_DXT1_EXT, FALSE);
+            return encode_dxtn(src, dst, pitch_in, pitch_out, format, w, h,
+                               GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
         default:
             break;
     }
@@ -417,17 +596,12 @@ BOOL wined3d_dxt1_encode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch
 BOOL wined3d_dxt3_encode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
         enum wined3d_format_id format, unsigned int w, unsigned int h)
 {
-    if (!txc_dxtn_handle)
-        return FALSE;
-
     switch (format)
     {
         case WINED3DFMT_B8G8R8A8_UNORM:
-            return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, TRUE);
         case WINED3DFMT_B8G8R8X8_UNORM:
-            return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, FALSE);
+            return encode_dxtn(src, dst, pitch_in, pitch_out, format, w, h,
+                               GL_COMPRESSED_RGBA_S3TC_DXT3_EXT);
         default:
             break;
     }
@@ -439,17 +613,12 @@ BOOL wined3d_dxt3_encode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch
 BOOL wined3d_dxt5_encode(const BYTE *src, BYTE *dst, DWORD pitch_in, DWORD pitch_out,
         enum wined3d_format_id format, unsigned int w, unsigned int h)
 {
-    if (!txc_dxtn_handle)
-        return FALSE;
-
     switch (format)
     {
         case WINED3DFMT_B8G8R8A8_UNORM:
-            return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, TRUE);
         case WINED3DFMT_B8G8R8X8_UNORM:
-            return x8r8g8b8_to_dxtn(src, dst, pitch_in, pitch_out, w, h,
-                                    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, FALSE);
+            return encode_dxtn(src, dst, pitch_in, pitch_out, format, w, h,
+                               GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
         default:
             break;
     }
@@ -482,20 +651,17 @@ BOOL wined3d_dxtn_init(void)
 
     if (!txc_dxtn_handle)
     {
-        FIXME("Wine cannot find the txc_dxtn library, DXTn software support unavailable.\n");
+        TRACE("Wine cannot find the txc_dxtn library, using the built-in DXTn encoder.\n");
         return FALSE;
     }
 
     #define LOAD_FUNCPTR(f) \
         if (!(p##f = wine_dlsym(txc_dxtn_handle, #f, NULL, 0))) \
         { \
-            ERR("Can't find symbol %s , DXTn software support unavailable.\n", #f); \
+            ERR("Can't find symbol %s , using the built-in DXTn encoder.\n", #f); \
             goto error; \
         }
 
-    LOAD_FUNCPTR(fetch_2d_texel_rgba_dxt1);
-    LOAD_FUNCPTR(fetch_2d_texel_rgba_dxt3);
-    LOAD_FUNCPTR(fetch_2d_texel_rgba_dxt5);
     LOAD_FUNCPTR(tx_compress_dxtn);
 
     #undef LOAD_FUNCPTR
@@ -509,7 +675,8 @@ error:
 
 BOOL wined3d_dxtn_supported(void)
 {
-    return (txc_dxtn_handle != NULL);
+    /* The built-in codec handles everything libtxc_dxtn would. */
+    return TRUE;
 }
 
 void wined3d_dxtn_free(void)
@@ -1623,11 +1623,11 @@ static void shader_generate_glsl_declarations(const struct wined3d_context *cont
         const struct wined3d_shader_reg_maps *reg_maps, const struct shader_glsl_ctx_priv *ctx_priv)
 {
     const struct wined3d_shader_version *version = &reg_maps->shader_version;
-    const struct wined3d_state *state = &shader->device->state;
+    const struct wined3d_state *state = &shader->device->cs->state;
     const struct vs_compile_args *vs_args = ctx_priv->cur_vs_args;
     const struct ps_compile_args *ps_args = ctx_priv->cur_ps_args;
     const struct wined3d_gl_info *gl_info = context->gl_info;
-    const struct wined3d_fb_state *fb = &shader->device->fb;
+    const struct wined3d_fb_state *fb = &shader->device->cs->fb;
     unsigned int i, extra_constants_needed = 0;
     const struct wined3d_shader_lconst *lconst;
     const char *prefix;
@@ -5590,16 +5590,154 @@ static GLuint shader_glsl_generate_geometry_shader(const struct wined3d_context
     return shader_id;
 }
 
+static void shader_glsl_cache_key_init(struct wined3d_shader_cache_key *key, DWORD type,
+        const struct wined3d_context *context)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    const struct wined3d_d3d_info *d3d_info = context->d3d_info;
+    DWORD flags[5];
+
+    wined3d_shader_cache_key_init(key, type);
+    wined3d_shader_cache_key_add_string(key, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VENDOR));
+    wined3d_shader_cache_key_add_string(key, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER));
+    wined3d_shader_cache_key_add_string(key, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION));
+    wined3d_shader_cache_key_add(key, &gl_info->glsl_version, sizeof(gl_info->glsl_version));
+    wined3d_shader_cache_key_add(key, &gl_info->quirks, sizeof(gl_info->quirks));
+    wined3d_shader_cache_key_add(key, &gl_info->reserved_glsl_constants, sizeof(gl_info->reserved_glsl_constants));
+    wined3d_shader_cache_key_add(key, gl_info->supported, sizeof(gl_info->supported));
+    wined3d_shader_cache_key_add(key, &gl_info->limits, sizeof(gl_info->limits));
+    wined3d_shader_cache_key_add(key, &d3d_info->limits, sizeof(d3d_info->limits));
+
+    flags[0] = d3d_info->emulated_flatshading;
+    flags[1] = d3d_info->ffp_generic_attributes;
+    flags[2] = d3d_info->vs_clipping;
+    flags[3] = d3d_info->shader_color_key;
+    flags[4] = d3d_info->wined3d_creation_flags;
+    wined3d_shader_cache_key_add(key, flags, sizeof(flags));
+}
+
+static void shader_glsl_cache_key_add_signature(struct wined3d_shader_cache_key *key,
+        const struct wined3d_shader_signature *signature)
+{
+    unsigned int i;
+
+    wined3d_shader_cache_key_add(key, &signature->element_count, sizeof(signature->element_count));
+    for (i = 0; i < signature->element_count; ++i)
+    {
+        const struct wined3d_shader_signature_element *e = &signature->elements[i];
+        DWORD data[5];
+
+        data[0] = e->semantic_idx;
+        data[1] = e->sysval_semantic;
+        data[2] = e->component_type;
+        data[3] = e->register_idx;
+        data[4] = e->mask;
+        wined3d_shader_cache_key_add_string(key, e->semantic_name);
+        wined3d_shader_cache_key_add(key, data, sizeof(data));
+    }
+}
+
+static void shader_glsl_cache_key_add_shader(struct wined3d_shader_cache_key *key,
+        const struct wined3d_shader *shader)
+{
+    DWORD data[2];
+
+    data[0] = shader->load_local_constsF;
+    data[1] = shader->device->wined3d->flags;
+    wined3d_shader_cache_key_add(key, shader->function, shader->functionLength);
+    wined3d_shader_cache_key_add(key, data, sizeof(data));
+    shader_glsl_cache_key_add_signature(key, &shader->input_signature);
+    shader_glsl_cache_key_add_signature(key, &shader->output_signature);
+}
+
+static BOOL shader_glsl_ps_cache_key(const struct wined3d_context *context, const struct wined3d_shader *shader,
+        const struct ps_compile_args *args, struct wined3d_shader_cache_key *key)
+{
+    const struct wined3d_shader_reg_maps *reg_maps = &shader->reg_maps;
+
+    if (!wined3d_shader_cache_enabled())
+        return FALSE;
+
+    /* When no uniform is left for the vpos correction, it's baked into the
+     * shader as an immediate that depends on the current render target. */
+    if ((reg_maps->vpos || reg_maps->usesdsy) && shader->limits->constant_float + 3 * MAX_TEXTURES + 1
+            >= context->gl_info->limits.glsl_ps_float_constants)
+        return FALSE;
+
+    shader_glsl_cache_key_init(key, WINED3D_SHADER_CACHE_GLSL_PS, context);
+    shader_glsl_cache_key_add_shader(key, shader);
+    wined3d_shader_cache_key_add(key, args, sizeof(*args));
+
+    return TRUE;
+}
+
+static BOOL shader_glsl_vs_cache_key(const struct wined3d_context *context, const struct wined3d_shader *shader,
+        const struct vs_compile_args *args, struct wined3d_shader_cache_key *key)
+{
+    DWORD data[6];
+
+    if (!wined3d_shader_cache_enabled())
+        return FALSE;
+
+    /* The bitfield padding in struct vs_compile_args isn't initialised. */
+    data[0] = args->fog_src;
+    data[1] = args->clip_enabled;
+    data[2] = args->point_size;
+    data[3] = args->per_vertex_point_size;
+    data[4] = args->flatshading;
+    data[5] = args->swizzle_map;
+
+    shader_glsl_cache_key_init(key, WINED3D_SHADER_CACHE_GLSL_VS, context);
+    shader_glsl_cache_key_add_shader(key, shader);
+    wined3d_shader_cache_key_add(key, data, sizeof(data));
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static GLuint shader_glsl_load_cached_shader(const struct wined3d_gl_info *gl_info, GLenum type,
+        const struct wined3d_shader_cache_key *key, void *extra, DWORD extra_size)
+{
+    struct wined3d_shader_cache_entry *entry;
+    GLuint shader_id;
+
+    if (!(entry = wined3d_shader_cache_load(key)))
+        return 0;
+
+    if (entry->extra_size != extra_size || !entry->data_size || entry->data[entry->data_size - 1])
+    {
+        WARN("Invalid cached shader.\n");
+        HeapFree(GetProcessHeap(), 0, entry);
+        return 0;
+    }
+
+    if (extra_size)
+        memcpy(extra, entry->extra, extra_size);
+    shader_id = GL_EXTCALL(glCreateShader(type));
+    shader_glsl_compile(gl_info, shader_id, (const char *)entry->data);
+    HeapFree(GetProcessHeap(), 0, entry);
+
+    return shader_id;
+}
+
+static void shader_glsl_store_cached_shader(const struct wined3d_shader_cache_key *key,
+        const void *extra, DWORD extra_size, const struct wined3d_string_buffer *buffer)
+{
+    wined3d_shader_cache_store(key, 0, extra, extra_size, buffer->buffer, strlen(buffer->buffer) + 1);
+}
+
 static GLuint find_glsl_pshader(const struct wined3d_context *context,
         struct wined3d_string_buffer *buffer, struct wined3d_string_buffer_list *string_buffers,
         struct wined3d_shader *shader,
         const struct ps_compile_args *args, const struct ps_np2fixup_info **np2fixup_info)
 {
     struct glsl_ps_compiled_shader *gl_shaders, *new_array;
+    struct wined3d_shader_cache_key key;
     struct glsl_shader_private *shader_data;
     struct ps_np2fixup_info *np2fixup;
     UINT i;
     DWORD new_size;
+    BOOL cache;
     GLuint ret;
 
     if (!shader->backend_data)
@@ -5659,8 +5797,15 @@ static GLuint find_glsl_pshader(const struct wined3d_context *context,
 
     pixelshader_update_resource_types(shader, args->tex_types);
 
-    string_buffer_clear(buffer);
-    ret = shader_glsl_generate_pshader(context, buffer, string_buffers, shader, args, np2fixup);
+    cache = shader_glsl_ps_cache_key(context, shader, args, &key);
+    if (!cache || !(ret = shader_glsl_load_cached_shader(context->gl_info,
+            GL_FRAGMENT_SHADER, &key, np2fixup, sizeof(*np2fixup))))
+    {
+        string_buffer_clear(buffer);
+        ret = shader_glsl_generate_pshader(context, buffer, string_buffers, shader, args, np2fixup);
+        if (cache)
+            shader_glsl_store_cached_shader(&key, np2fixup, sizeof(*np2fixup), buffer);
+    }
     gl_shaders[shader_data->num_gl_shaders++].id = ret;
 
     return ret;
@@ -5689,7 +5834,9 @@ static GLuint find_glsl_vshader(const struct wined3d_context *context,
     DWORD new_size;
     DWORD use_map = context->stream_info.use_map;
     struct glsl_vs_compiled_shader *gl_shaders, *new_array;
+    struct wined3d_shader_cache_key key;
     struct glsl_shader_private *shader_data;
+    BOOL cache;
     GLuint ret;
 
     if (!shader->backend_data)
@@ -5740,8 +5887,14 @@ static GLuint find_glsl_vshader(const struct wined3d_context *context,
 
     gl_shaders[shader_data->num_gl_shaders].args = *args;
 
-    string_buffer_clear(buffer);
-    ret = shader_glsl_generate_vshader(context, buffer, string_buffers, shader, args);
+    cache = shader_glsl_vs_cache_key(context, shader, args, &key);
+    if (!cache || !(ret = shader_glsl_load_cached_shader(context->gl_info, GL_VERTEX_SHADER, &key, NULL, 0)))
+    {
+        string_buffer_clear(buffer);
+        ret = shader_glsl_generate_vshader(context, buffer, string_buffers, shader, args);
+        if (cache)
+            shader_glsl_store_cached_shader(&key, NULL, 0, buffer);
+    }
     gl_shaders[shader_data->num_gl_shaders++].id = ret;
 
     return ret;
@@ -7074,6 +7227,104 @@ static void shader_glsl_init_uniform_block_bindings(const struct wined3d_gl_info
 }
 
 /* Context activation is done by the caller. */
+static BOOL shader_glsl_program_cache_key(const struct wined3d_context *context,
+        const GLuint *shader_ids, unsigned int shader_count, WORD attribs_map,
+        const struct wined3d_shader *gshader, struct wined3d_shader_cache_key *key)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    GLint source_size = 0, length;
+    char *source = NULL;
+    unsigned int i;
+
+    if (!wined3d_shader_cache_enabled() || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return FALSE;
+
+    shader_glsl_cache_key_init(key, WINED3D_SHADER_CACHE_GL_PROGRAM, context);
+    for (i = 0; i < shader_count; ++i)
+    {
+        wined3d_shader_cache_key_add(key, &i, sizeof(i));
+        if (!shader_ids[i])
+            continue;
+
+        GL_EXTCALL(glGetShaderiv(shader_ids[i], GL_SHADER_SOURCE_LENGTH, &length));
+        if (length > source_size)
+        {
+            HeapFree(GetProcessHeap(), 0, source);
+            if (!(source = HeapAlloc(GetProcessHeap(), 0, length)))
+                return FALSE;
+            source_size = length;
+        }
+        if (length)
+        {
+            GL_EXTCALL(glGetShaderSource(shader_ids[i], length, &length, source));
+            wined3d_shader_cache_key_add(key, source, length);
+        }
+    }
+    HeapFree(GetProcessHeap(), 0, source);
+    checkGLcall("glGetShaderSource");
+
+    wined3d_shader_cache_key_add(key, &attribs_map, sizeof(attribs_map));
+    if (gshader)
+    {
+        DWORD data[3];
+
+        data[0] = gshader->u.gs.input_type;
+        data[1] = gshader->u.gs.output_type;
+        data[2] = gshader->u.gs.vertices_out;
+        wined3d_shader_cache_key_add(key, data, sizeof(data));
+    }
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_load_program_binary(const struct wined3d_gl_info *gl_info, GLuint program_id,
+        const struct wined3d_shader_cache_key *key)
+{
+    struct wined3d_shader_cache_entry *entry;
+    GLint status;
+
+    if (!(entry = wined3d_shader_cache_load(key)))
+        return FALSE;
+
+    GL_EXTCALL(glProgramBinary(program_id, entry->format, entry->data, entry->data_size));
+    HeapFree(GetProcessHeap(), 0, entry);
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    checkGLcall("glProgramBinary");
+
+    /* Drivers may reject binaries, e.g. after an update that doesn't change
+     * the version string. Fall back to linking normally. */
+    if (!status)
+    {
+        WARN("Cached binary for program %u was rejected.\n", program_id);
+        return FALSE;
+    }
+
+    TRACE("Loaded program %u from the shader cache.\n", program_id);
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_program_binary(const struct wined3d_gl_info *gl_info, GLuint program_id,
+        const struct wined3d_shader_cache_key *key)
+{
+    GLint status, size;
+    GLenum format;
+    void *data;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    if (!status)
+        return;
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &size));
+    if (size <= 0 || !(data = HeapAlloc(GetProcessHeap(), 0, size)))
+        return;
+
+    GL_EXTCALL(glGetProgramBinary(program_id, size, &size, &format, data));
+    checkGLcall("glGetProgramBinary");
+    wined3d_shader_cache_store(key, format, NULL, 0, data, size);
+    HeapFree(GetProcessHeap(), 0, data);
+}
+
 static void set_glsl_shader_program(const struct wined3d_context *context, const struct wined3d_state *state,
         struct shader_glsl_priv *priv, struct glsl_context_data *ctx_data)
 {
@@ -7091,8 +7342,11 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     GLuint gs_id = 0;
     GLuint ps_id = 0;
     struct list *ps_list = NULL, *vs_list = NULL;
-    WORD attribs_map;
+    struct wined3d_shader_cache_key program_key;
+    WORD attribs_map, map;
     struct wined3d_string_buffer *tmp_name;
+    GLuint shader_ids[4];
+    BOOL cache_program;
 
     if (!(context->shader_update_mask & (1u << WINED3D_SHADER_TYPE_VERTEX)) && ctx_data->glsl_program)
     {
@@ -7227,9 +7481,9 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
      * in order to make the bindings work, and it has to be done prior
      * to linking the GLSL program. */
     tmp_name = string_buffer_get(&priv->string_buffers);
-    for (i = 0; attribs_map; attribs_map >>= 1, ++i)
+    for (i = 0, map = attribs_map; map; map >>= 1, ++i)
     {
-        if (!(attribs_map & 1))
+        if (!(map & 1))
             continue;
 
         string_buffer_sprintf(tmp_name, "vs_in%u", i);
@@ -7269,10 +7523,26 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Link the program, unless a binary for the same set of shader sources
+     * is available from the shader cache. */
+    shader_ids[0] = vs_id;
+    shader_ids[1] = reorder_shader_id;
+    shader_ids[2] = gs_id;
+    shader_ids[3] = ps_id;
+    cache_program = shader_glsl_program_cache_key(context, shader_ids,
+            sizeof(shader_ids) / sizeof(*shader_ids), attribs_map, gshader, &program_key);
+    if (!cache_program || !shader_glsl_load_program_binary(gl_info, program_id, &program_key))
+    {
+        if (cache_program)
+            GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+
+        if (cache_program)
+            shader_glsl_store_program_binary(gl_info, program_id, &program_key);
+    }
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? min(vshader->limits->constant_float, gl_info->limits.glsl_vs_float_constants) : 0);
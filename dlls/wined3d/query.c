@@ -241,6 +241,12 @@ ULONG CDECL wined3d_query_decref(struct wined3d_query *query)
 
     if (!refcount)
     {
+        struct wined3d_cs *cs = query->device->cs;
+
+        wined3d_cs_finish(cs);
+        if (query->type == WINED3D_QUERY_TYPE_OCCLUSION && query->state == QUERY_BUILDING)
+            --cs->synchronous;
+
         /* Queries are specific to the GL context that created them. Not
          * deleting the query will obviously leak it, but that's still better
          * than potentially deleting a different query with the same id in this
@@ -290,9 +296,35 @@ UINT CDECL wined3d_query_get_data_size(const struct wined3d_query *query)
 
 HRESULT CDECL wined3d_query_issue(struct wined3d_query *query, DWORD flags)
 {
+    struct wined3d_cs *cs = query->device->cs;
+    BOOL building;
+    HRESULT hr;
+
     TRACE("query %p, flags %#x.\n", query, flags);
 
-    return query->query_ops->query_issue(query, flags);
+    /* Event queries are ordered with the rendering commands. */
+    if (query->type == WINED3D_QUERY_TYPE_EVENT)
+    {
+        wined3d_cs_emit_query_issue(cs, query, flags);
+        return WINED3D_OK;
+    }
+
+    /* Other queries are issued on the application thread, after everything
+     * submitted before them. Occlusion queries have to count the samples of
+     * draws issued from the same context, so the command stream is
+     * synchronous while one is building. */
+    wined3d_cs_finish(cs);
+    building = query->state == QUERY_BUILDING;
+    hr = query->query_ops->query_issue(query, flags);
+    if (query->type == WINED3D_QUERY_TYPE_OCCLUSION && building != (query->state == QUERY_BUILDING))
+    {
+        if (building)
+            --cs->synchronous;
+        else
+            ++cs->synchronous;
+    }
+
+    return hr;
 }
 
 static void fill_query_data(void *out, unsigned int out_size, const void *result, unsigned int result_size)
@@ -393,6 +425,14 @@ static HRESULT wined3d_event_query_ops_get_data(struct wined3d_query *query,
         return S_OK;
     }
 
+    if (!wined3d_cs_is_executed(query->device->cs, query->issue_fence))
+    {
+        TRACE("Query hasn't been issued to GL yet.\n");
+        signaled = FALSE;
+        fill_query_data(data, size, &signaled, sizeof(signaled));
+        return S_OK;
+    }
+
     ret = wined3d_event_query_test(event_query, query->device);
     switch(ret)
     {
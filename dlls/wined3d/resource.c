@@ -242,6 +242,8 @@ void resource_cleanup(struct wined3d_resource *resource)
 
     TRACE("Cleaning up resource %p.\n", resource);
 
+    wined3d_cs_finish(resource->device->cs);
+
     if (resource->pool == WINED3D_POOL_DEFAULT && d3d->flags & WINED3D_VIDMEM_ACCOUNTING)
     {
         TRACE("Decrementing device memory pool by %u.\n", resource->size);
@@ -253,6 +255,31 @@ void resource_cleanup(struct wined3d_resource *resource)
     device_resource_released(resource->device, resource);
 }
 
+/* Sub-resources are tracked through their container. */
+static struct wined3d_resource *resource_get_fence_resource(struct wined3d_resource *resource)
+{
+    struct wined3d_texture *container = NULL;
+
+    if (resource->type == WINED3D_RTYPE_SURFACE)
+        container = surface_from_resource(resource)->container;
+    else if (resource->type == WINED3D_RTYPE_VOLUME)
+        container = volume_from_resource(resource)->container;
+
+    return container ? &container->resource : resource;
+}
+
+void resource_set_access_fence(struct wined3d_resource *resource, ULONG fence)
+{
+    resource_get_fence_resource(resource)->access_fence = fence;
+}
+
+/* Waits for the command stream to finish all queued work that accesses the
+ * resource, without draining unrelated work. */
+void wined3d_resource_wait_idle(struct wined3d_resource *resource)
+{
+    wined3d_cs_wait(resource->device->cs, resource_get_fence_resource(resource)->access_fence);
+}
+
 void resource_unload(struct wined3d_resource *resource)
 {
     if (resource->map_count)
@@ -0,0 +1,341 @@
+/*
+ * Persistent on-disk cache for generated shaders and linked programs.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* Every cache entry is stored in its own file, named after the 64-bit hash
+ * of its key and carrying the ".wsc" extension. The file starts with a
+ * struct wined3d_shader_cache_header, followed by "extra_size" bytes of
+ * backend specific data and "data_size" bytes of payload. For GLSL entries
+ * the payload is the plain-text shader source, so entries can be inspected
+ * with standard tools. The cache can be pruned by hand by deleting any of
+ * its files; wined3d itself evicts the least recently used entries whenever
+ * the total size exceeds the configured limit. */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <stdio.h>
+
+#include "wined3d_private.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
+
+#define WINED3D_SHADER_CACHE_MAGIC      0x31435357 /* "WSC1" */
+#define WINED3D_SHADER_CACHE_MAX_ENTRY  (16 * 1024 * 1024)
+
+struct wined3d_shader_cache_header
+{
+    DWORD magic;
+    DWORD type;
+    ULONGLONG hash;
+    DWORD check;
+    DWORD format;
+    DWORD extra_size;
+    DWORD data_size;
+};
+
+struct wined3d_shader_cache_file
+{
+    FILETIME time;
+    ULONGLONG size;
+    char name[MAX_PATH];
+};
+
+static CRITICAL_SECTION wined3d_shader_cache_cs;
+static CRITICAL_SECTION_DEBUG wined3d_shader_cache_cs_debug =
+{
+    0, 0, &wined3d_shader_cache_cs,
+    {&wined3d_shader_cache_cs_debug.ProcessLocksList,
+    &wined3d_shader_cache_cs_debug.ProcessLocksList},
+    0, 0, {(DWORD_PTR)(__FILE__ ": wined3d_shader_cache_cs")}
+};
+static CRITICAL_SECTION wined3d_shader_cache_cs = {&wined3d_shader_cache_cs_debug, -1, 0, 0, 0, 0};
+
+static char *shader_cache_dir;
+static ULONGLONG shader_cache_total, shader_cache_limit;
+
+static int shader_cache_file_compare(const void *a, const void *b)
+{
+    const struct wined3d_shader_cache_file *f1 = a, *f2 = b;
+
+    return CompareFileTime(&f1->time, &f2->time);
+}
+
+/* Rescan the cache directory and evict the oldest entries until "reserve"
+ * more bytes fit in three quarters of the size limit. Called with
+ * wined3d_shader_cache_cs held. */
+static void shader_cache_prune(ULONGLONG reserve)
+{
+    struct wined3d_shader_cache_file *files = NULL, *new_files;
+    unsigned int count = 0, size = 0, i;
+    char path[2 * MAX_PATH];
+    WIN32_FIND_DATAA data;
+    ULONGLONG total = 0;
+    HANDLE find;
+
+    snprintf(path, sizeof(path), "%s\\*.wsc", shader_cache_dir);
+    if ((find = FindFirstFileA(path, &data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                continue;
+
+            if (count == size)
+            {
+                size = max(64, size * 2);
+                if (files)
+                    new_files = HeapReAlloc(GetProcessHeap(), 0, files, size * sizeof(*files));
+                else
+                    new_files = HeapAlloc(GetProcessHeap(), 0, size * sizeof(*files));
+                if (!new_files)
+                {
+                    ERR("Failed to allocate shader cache file list.\n");
+                    break;
+                }
+                files = new_files;
+            }
+
+            files[count].time = data.ftLastWriteTime;
+            files[count].size = ((ULONGLONG)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+            lstrcpynA(files[count].name, data.cFileName, sizeof(files[count].name));
+            total += files[count].size;
+            ++count;
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+
+    if (total + reserve > shader_cache_limit)
+    {
+        ULONGLONG target = shader_cache_limit / 4 * 3;
+
+        qsort(files, count, sizeof(*files), shader_cache_file_compare);
+        for (i = 0; i < count && total + reserve > target; ++i)
+        {
+            snprintf(path, sizeof(path), "%s\\%s", shader_cache_dir, files[i].name);
+            if (DeleteFileA(path))
+                total -= files[i].size;
+        }
+        TRACE_(d3d_perf)("Evicted %u shader cache entries, %s bytes left.\n",
+                i, wine_dbgstr_longlong(total));
+    }
+
+    shader_cache_total = total;
+    HeapFree(GetProcessHeap(), 0, files);
+}
+
+void wined3d_shader_cache_init(void)
+{
+    if (!wined3d_settings.shader_cache_path)
+        return;
+
+    /* Leave room for the entry file names. */
+    if (strlen(wined3d_settings.shader_cache_path) >= MAX_PATH - 32)
+    {
+        ERR("Shader cache path %s is too long.\n", debugstr_a(wined3d_settings.shader_cache_path));
+        return;
+    }
+
+    if (!CreateDirectoryA(wined3d_settings.shader_cache_path, NULL)
+            && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        ERR("Failed to create shader cache directory %s, error %u.\n",
+                debugstr_a(wined3d_settings.shader_cache_path), GetLastError());
+        return;
+    }
+
+    shader_cache_dir = wined3d_settings.shader_cache_path;
+    shader_cache_limit = (ULONGLONG)wined3d_settings.shader_cache_size * 1024 * 1024;
+
+    EnterCriticalSection(&wined3d_shader_cache_cs);
+    shader_cache_prune(0);
+    LeaveCriticalSection(&wined3d_shader_cache_cs);
+
+    TRACE("Using shader cache %s, %s of %s bytes in use.\n", debugstr_a(shader_cache_dir),
+            wine_dbgstr_longlong(shader_cache_total), wine_dbgstr_longlong(shader_cache_limit));
+}
+
+BOOL wined3d_shader_cache_enabled(void)
+{
+    return shader_cache_dir && shader_cache_limit;
+}
+
+void wined3d_shader_cache_key_init(struct wined3d_shader_cache_key *key, DWORD type)
+{
+    key->type = type;
+    key->hash = 0xcbf29ce484222325ull;
+    key->check = 5381;
+    wined3d_shader_cache_key_add(key, &type, sizeof(type));
+    wined3d_shader_cache_key_add_string(key, PACKAGE_VERSION);
+}
+
+/* 64-bit FNV-1a for the file name, and an independent 32-bit hash that is
+ * stored in the entry to reject collisions. */
+void wined3d_shader_cache_key_add(struct wined3d_shader_cache_key *key, const void *data, SIZE_T size)
+{
+    const BYTE *ptr = data, *end = ptr + size;
+    ULONGLONG hash = key->hash;
+    DWORD check = key->check;
+
+    while (ptr < end)
+    {
+        hash = (hash ^ *ptr) * 0x100000001b3ull;
+        check = (check * 33) ^ *ptr++;
+    }
+
+    key->hash = hash;
+    key->check = check;
+}
+
+void wined3d_shader_cache_key_add_string(struct wined3d_shader_cache_key *key, const char *str)
+{
+    if (!str)
+        str = "";
+    wined3d_shader_cache_key_add(key, str, strlen(str) + 1);
+}
+
+static void shader_cache_get_path(const struct wined3d_shader_cache_key *key,
+        char *path, size_t size, const char *ext)
+{
+    snprintf(path, size, "%s\\%08x%08x.%s", shader_cache_dir,
+            (DWORD)(key->hash >> 32), (DWORD)key->hash, ext);
+}
+
+struct wined3d_shader_cache_entry *wined3d_shader_cache_load(const struct wined3d_shader_cache_key *key)
+{
+    struct wined3d_shader_cache_header *header;
+    struct wined3d_shader_cache_entry *entry;
+    DWORD file_size, read;
+    char path[MAX_PATH];
+    FILETIME now;
+    HANDLE file;
+    BOOL valid;
+
+    if (!wined3d_shader_cache_enabled())
+        return NULL;
+
+    shader_cache_get_path(key, path, sizeof(path), "wsc");
+    file = CreateFileA(path, GENERIC_READ | FILE_WRITE_ATTRIBUTES,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    file_size = GetFileSize(file, NULL);
+    if (file_size == INVALID_FILE_SIZE || file_size < sizeof(*header)
+            || file_size > WINED3D_SHADER_CACHE_MAX_ENTRY)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    if (!(entry = HeapAlloc(GetProcessHeap(), 0, sizeof(*entry) + file_size)))
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+    header = (struct wined3d_shader_cache_header *)(entry + 1);
+
+    valid = ReadFile(file, header, file_size, &read, NULL) && read == file_size
+            && header->magic == WINED3D_SHADER_CACHE_MAGIC
+            && header->type == key->type
+            && header->hash == key->hash
+            && header->check == key->check
+            && header->extra_size <= file_size - sizeof(*header)
+            && header->data_size == file_size - sizeof(*header) - header->extra_size;
+
+    if (valid)
+    {
+        /* The last write time doubles as the LRU timestamp for pruning. */
+        GetSystemTimeAsFileTime(&now);
+        SetFileTime(file, NULL, NULL, &now);
+    }
+    CloseHandle(file);
+
+    if (!valid)
+    {
+        WARN("Discarding invalid shader cache entry %s.\n", debugstr_a(path));
+        DeleteFileA(path);
+        HeapFree(GetProcessHeap(), 0, entry);
+        return NULL;
+    }
+
+    entry->format = header->format;
+    entry->extra_size = header->extra_size;
+    entry->data_size = header->data_size;
+    entry->extra = (const BYTE *)(header + 1);
+    entry->data = entry->extra + header->extra_size;
+
+    TRACE_(d3d_perf)("Shader cache hit for %s.\n", debugstr_a(path));
+    return entry;
+}
+
+void wined3d_shader_cache_store(const struct wined3d_shader_cache_key *key, DWORD format,
+        const void *extra, DWORD extra_size, const void *data, DWORD data_size)
+{
+    struct wined3d_shader_cache_header header;
+    char path[MAX_PATH], tmp_path[MAX_PATH + 32];
+    DWORD written, size;
+    HANDLE file;
+    BOOL ret;
+
+    if (!wined3d_shader_cache_enabled())
+        return;
+
+    size = sizeof(header) + extra_size + data_size;
+    if (size > WINED3D_SHADER_CACHE_MAX_ENTRY || size > shader_cache_limit / 4)
+        return;
+
+    header.magic = WINED3D_SHADER_CACHE_MAGIC;
+    header.type = key->type;
+    header.hash = key->hash;
+    header.check = key->check;
+    header.format = format;
+    header.extra_size = extra_size;
+    header.data_size = data_size;
+
+    /* Write to a temporary file first, so that other processes sharing the
+     * cache never see partially written entries. */
+    shader_cache_get_path(key, path, sizeof(path), "wsc");
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%x-%x.tmp", path,
+            GetCurrentProcessId(), GetCurrentThreadId());
+    file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %u.\n", debugstr_a(tmp_path), GetLastError());
+        return;
+    }
+
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header)
+            && (!extra_size || (WriteFile(file, extra, extra_size, &written, NULL) && written == extra_size))
+            && WriteFile(file, data, data_size, &written, NULL) && written == data_size;
+    CloseHandle(file);
+
+    if (!ret || !MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write shader cache entry %s, error %u.\n", debugstr_a(path), GetLastError());
+        DeleteFileA(tmp_path);
+        return;
+    }
+
+    EnterCriticalSection(&wined3d_shader_cache_cs);
+    if (shader_cache_total + size > shader_cache_limit)
+        shader_cache_prune(0);
+    else
+        shader_cache_total += size;
+    LeaveCriticalSection(&wined3d_shader_cache_cs);
+}
@@ -464,12 +464,14 @@ void state_unbind_resources(struct wined3d_state *state)
     struct wined3d_texture *texture;
     struct wined3d_buffer *buffer;
     struct wined3d_shader *shader;
+    BOOL no_ref = state->flags & WINED3D_STATE_NO_REF;
     unsigned int i, j;
 
     if ((decl = state->vertex_declaration))
     {
         state->vertex_declaration = NULL;
-        wined3d_vertex_declaration_decref(decl);
+        if (!no_ref)
+            wined3d_vertex_declaration_decref(decl);
     }
 
     for (i = 0; i < MAX_COMBINED_SAMPLERS; ++i)
@@ -477,7 +479,10 @@ void state_unbind_resources(struct wined3d_state *state)
         if ((texture = state->textures[i]))
         {
             state->textures[i] = NULL;
-            wined3d_texture_decref(texture);
+            if (no_ref)
+                InterlockedDecrement(&texture->resource.bind_count);
+            else
+                wined3d_texture_decref(texture);
         }
     }
 
@@ -486,7 +491,10 @@ void state_unbind_resources(struct wined3d_state *state)
         if ((buffer = state->stream_output[i].buffer))
         {
             state->stream_output[i].buffer = NULL;
-            wined3d_buffer_decref(buffer);
+            if (no_ref)
+                InterlockedDecrement(&buffer->resource.bind_count);
+            else
+                wined3d_buffer_decref(buffer);
         }
     }
 
@@ -495,14 +503,20 @@ void state_unbind_resources(struct wined3d_state *state)
         if ((buffer = state->streams[i].buffer))
         {
             state->streams[i].buffer = NULL;
-            wined3d_buffer_decref(buffer);
+            if (no_ref)
+                InterlockedDecrement(&buffer->resource.bind_count);
+            else
+                wined3d_buffer_decref(buffer);
         }
     }
 
     if ((buffer = state->index_buffer))
     {
         state->index_buffer = NULL;
-        wined3d_buffer_decref(buffer);
+        if (no_ref)
+            InterlockedDecrement(&buffer->resource.bind_count);
+        else
+            wined3d_buffer_decref(buffer);
     }
 
     for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
@@ -510,7 +524,8 @@ void state_unbind_resources(struct wined3d_state *state)
         if ((shader = state->shader[i]))
         {
             state->shader[i] = NULL;
-            wined3d_shader_decref(shader);
+            if (!no_ref)
+                wined3d_shader_decref(shader);
         }
 
         for (j = 0; j < MAX_CONSTANT_BUFFERS; ++j)
@@ -518,7 +533,10 @@ void state_unbind_resources(struct wined3d_state *state)
             if ((buffer = state->cb[i][j]))
             {
                 state->cb[i][j] = NULL;
-                wined3d_buffer_decref(buffer);
+                if (no_ref)
+                    InterlockedDecrement(&buffer->resource.bind_count);
+                else
+                    wined3d_buffer_decref(buffer);
             }
         }
 
@@ -527,7 +545,8 @@ void state_unbind_resources(struct wined3d_state *state)
             if ((sampler = state->sampler[i][j]))
             {
                 state->sampler[i][j] = NULL;
-                wined3d_sampler_decref(sampler);
+                if (!no_ref)
+                    wined3d_sampler_decref(sampler);
             }
         }
 
@@ -536,7 +555,8 @@ void state_unbind_resources(struct wined3d_state *state)
             if ((srv = state->shader_resource_view[i][j]))
             {
                 state->shader_resource_view[i][j] = NULL;
-                wined3d_shader_resource_view_decref(srv);
+                if (!no_ref)
+                    wined3d_shader_resource_view_decref(srv);
             }
         }
     }
@@ -1041,15 +1061,9 @@ void CDECL wined3d_stateblock_apply(const struct wined3d_stateblock *stateblock)
 
     if (stateblock->changed.primitive_type)
     {
-        GLenum gl_primitive_type, prev;
-
         if (device->recording)
             device->recording->changed.primitive_type = TRUE;
-        gl_primitive_type = stateblock->state.gl_primitive_type;
-        prev = device->update_state->gl_primitive_type;
-        device->update_state->gl_primitive_type = gl_primitive_type;
-        if (gl_primitive_type != prev && (gl_primitive_type == GL_POINTS || prev == GL_POINTS))
-            device_invalidate_state(device, STATE_POINT_ENABLE);
+        device->update_state->gl_primitive_type = stateblock->state.gl_primitive_type;
     }
 
     if (stateblock->changed.indices)
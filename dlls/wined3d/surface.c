@@ -1989,24 +1989,6 @@ static void convert_r32_float_r16_float(const BYTE *src, BYTE *dst,
 static void convert_r5g6b5_x8r8g8b8(const BYTE *src, BYTE *dst,
         DWORD pitch_in, DWORD pitch_out, unsigned int w, unsigned int h)
 {
-    static const unsigned char convert_5to8[] =
-    {
-        0x00, 0x08, 0x10, 0x19, 0x21, 0x29, 0x31, 0x3a,
-        0x42, 0x4a, 0x52, 0x5a, 0x63, 0x6b, 0x73, 0x7b,
-        0x84, 0x8c, 0x94, 0x9c, 0xa5, 0xad, 0xb5, 0xbd,
-        0xc5, 0xce, 0xd6, 0xde, 0xe6, 0xef, 0xf7, 0xff,
-    };
-    static const unsigned char convert_6to8[] =
-    {
-        0x00, 0x04, 0x08, 0x0c, 0x10, 0x14, 0x18, 0x1c,
-        0x20, 0x24, 0x28, 0x2d, 0x31, 0x35, 0x39, 0x3d,
-        0x41, 0x45, 0x49, 0x4d, 0x51, 0x55, 0x59, 0x5d,
-        0x61, 0x65, 0x69, 0x6d, 0x71, 0x75, 0x79, 0x7d,
-        0x82, 0x86, 0x8a, 0x8e, 0x92, 0x96, 0x9a, 0x9e,
-        0xa2, 0xa6, 0xaa, 0xae, 0xb2, 0xb6, 0xba, 0xbe,
-        0xc2, 0xc6, 0xca, 0xce, 0xd2, 0xd7, 0xdb, 0xdf,
-        0xe3, 0xe7, 0xeb, 0xef, 0xf3, 0xf7, 0xfb, 0xff,
-    };
     unsigned int x, y;
 
     TRACE("Converting %ux%u pixels, pitches %u %u.\n", w, h, pitch_in, pitch_out);
@@ -2017,11 +1999,14 @@ static void convert_r5g6b5_x8r8g8b8(const BYTE *src, BYTE *dst,
         DWORD *dst_line = (DWORD *)(dst + y * pitch_out);
         for (x = 0; x < w; ++x)
         {
-            WORD pixel = src_line[x];
+            DWORD pixel = src_line[x];
+
+            /* These are exact for round(c * 255 / 31) and round(c * 255 / 63),
+             * and unlike table lookups allow the loop to be vectorised. */
             dst_line[x] = 0xff000000u
-                    | convert_5to8[(pixel & 0xf800u) >> 11] << 16
-                    | convert_6to8[(pixel & 0x07e0u) >> 5] << 8
-                    | convert_5to8[(pixel & 0x001fu)];
+                    | ((((pixel >> 11) & 0x1f) * 527 + 23) >> 6) << 16
+                    | ((((pixel >> 5) & 0x3f) * 259 + 33) >> 6) << 8
+                    | (((pixel & 0x1f) * 527 + 23) >> 6);
         }
     }
 }
@@ -2052,10 +2037,33 @@ static inline BYTE cliptobyte(int x)
     return (BYTE)((x < 0) ? 0 : ((x > 255) ? 255 : x));
 }
 
+/* YUV to RGB conversion formulas from http://en.wikipedia.org/wiki/YUV:
+ *     C = Y - 16; D = U - 128; E = V - 128;
+ *     R = cliptobyte((298 * C + 409 * E + 128) >> 8);
+ *     G = cliptobyte((298 * C - 100 * D - 208 * E + 128) >> 8);
+ *     B = cliptobyte((298 * C + 516 * D + 128) >> 8);
+ * Two adjacent YUY2 pixels are stored as four bytes: Y0 U Y1 V .
+ * U and V are shared between the pixels, so the conversions below handle
+ * pixel pairs and compute the chroma terms once per pair. */
+static inline DWORD yuv_to_x8r8g8b8(int c2, int r2, int g2, int b2)
+{
+    return 0xff000000
+            | cliptobyte((c2 + r2) >> 8) << 16
+            | cliptobyte((c2 + g2) >> 8) << 8
+            | cliptobyte((c2 + b2) >> 8);
+}
+
+static inline WORD yuv_to_r5g6b5(int c2, int r2, int g2, int b2)
+{
+    return (cliptobyte((c2 + r2) >> 8) >> 3) << 11
+            | (cliptobyte((c2 + g2) >> 8) >> 2) << 5
+            | (cliptobyte((c2 + b2) >> 8) >> 3);
+}
+
 static void convert_yuy2_x8r8g8b8(const BYTE *src, BYTE *dst,
         DWORD pitch_in, DWORD pitch_out, unsigned int w, unsigned int h)
 {
-    int c2, d, e, r2 = 0, g2 = 0, b2 = 0;
+    int d, e, r2, g2, b2;
     unsigned int x, y;
 
     TRACE("Converting %ux%u pixels, pitches %u %u.\n", w, h, pitch_in, pitch_out);
@@ -2064,32 +2072,18 @@ static void convert_yuy2_x8r8g8b8(const BYTE *src, BYTE *dst,
     {
         const BYTE *src_line = src + y * pitch_in;
         DWORD *dst_line = (DWORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+
+        for (x = 0; x < w; x += 2, src_line += 4)
         {
-            /* YUV to RGB conversion formulas from http://en.wikipedia.org/wiki/YUV:
-             *     C = Y - 16; D = U - 128; E = V - 128;
-             *     R = cliptobyte((298 * C + 409 * E + 128) >> 8);
-             *     G = cliptobyte((298 * C - 100 * D - 208 * E + 128) >> 8);
-             *     B = cliptobyte((298 * C + 516 * D + 128) >> 8);
-             * Two adjacent YUY2 pixels are stored as four bytes: Y0 U Y1 V .
-             * U and V are shared between the pixels. */
-            if (!(x & 1)) /* For every even pixel, read new U and V. */
-            {
-                d = (int) src_line[1] - 128;
-                e = (int) src_line[3] - 128;
-                r2 = 409 * e + 128;
-                g2 = - 100 * d - 208 * e + 128;
-                b2 = 516 * d + 128;
-            }
-            c2 = 298 * ((int) src_line[0] - 16);
-            dst_line[x] = 0xff000000
-                | cliptobyte((c2 + r2) >> 8) << 16    /* red   */
-                | cliptobyte((c2 + g2) >> 8) << 8     /* green */
-                | cliptobyte((c2 + b2) >> 8);         /* blue  */
-                /* Scale RGB values to 0..255 range,
-                 * then clip them if still not in range (may be negative),
-                 * then shift them within DWORD if necessary. */
-            src_line += 2;
+            d = (int)src_line[1] - 128;
+            e = (int)src_line[3] - 128;
+            r2 = 409 * e + 128;
+            g2 = -100 * d - 208 * e + 128;
+            b2 = 516 * d + 128;
+
+            dst_line[x] = yuv_to_x8r8g8b8(298 * ((int)src_line[0] - 16), r2, g2, b2);
+            if (x + 1 < w)
+                dst_line[x + 1] = yuv_to_x8r8g8b8(298 * ((int)src_line[2] - 16), r2, g2, b2);
         }
     }
 }
@@ -2097,8 +2091,8 @@ static void convert_yuy2_x8r8g8b8(const BYTE *src, BYTE *dst,
 static void convert_yuy2_r5g6b5(const BYTE *src, BYTE *dst,
         DWORD pitch_in, DWORD pitch_out, unsigned int w, unsigned int h)
 {
+    int d, e, r2, g2, b2;
     unsigned int x, y;
-    int c2, d, e, r2 = 0, g2 = 0, b2 = 0;
 
     TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
 
@@ -2106,31 +2100,18 @@ static void convert_yuy2_r5g6b5(const BYTE *src, BYTE *dst,
     {
         const BYTE *src_line = src + y * pitch_in;
         WORD *dst_line = (WORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+
+        for (x = 0; x < w; x += 2, src_line += 4)
         {
-            /* YUV to RGB conversion formulas from http://en.wikipedia.org/wiki/YUV:
-             *     C = Y - 16; D = U - 128; E = V - 128;
-             *     R = cliptobyte((298 * C + 409 * E + 128) >> 8);
-             *     G = cliptobyte((298 * C - 100 * D - 208 * E + 128) >> 8);
-             *     B = cliptobyte((298 * C + 516 * D + 128) >> 8);
-             * Two adjacent YUY2 pixels are stored as four bytes: Y0 U Y1 V .
-             * U and V are shared between the pixels. */
-            if (!(x & 1)) /* For every even pixel, read new U and V. */
-            {
-                d = (int) src_line[1] - 128;
-                e = (int) src_line[3] - 128;
-                r2 = 409 * e + 128;
-                g2 = - 100 * d - 208 * e + 128;
-                b2 = 516 * d + 128;
-            }
-            c2 = 298 * ((int) src_line[0] - 16);
-            dst_line[x] = (cliptobyte((c2 + r2) >> 8) >> 3) << 11   /* red   */
-                | (cliptobyte((c2 + g2) >> 8) >> 2) << 5            /* green */
-                | (cliptobyte((c2 + b2) >> 8) >> 3);                /* blue  */
-                /* Scale RGB values to 0..255 range,
-                 * then clip them if still not in range (may be negative),
-                 * then shift them within DWORD if necessary. */
-            src_line += 2;
+            d = (int)src_line[1] - 128;
+            e = (int)src_line[3] - 128;
+            r2 = 409 * e + 128;
+            g2 = -100 * d - 208 * e + 128;
+            b2 = 516 * d + 128;
+
+            dst_line[x] = yuv_to_r5g6b5(298 * ((int)src_line[0] - 16), r2, g2, b2);
+            if (x + 1 < w)
+                dst_line[x + 1] = yuv_to_r5g6b5(298 * ((int)src_line[2] - 16), r2, g2, b2);
         }
     }
 }
@@ -2478,6 +2459,7 @@ HRESULT wined3d_surface_map(struct wined3d_surface *surface, struct wined3d_map_
             return WINED3DERR_INVALIDCALL;
     }
 
+    wined3d_resource_wait_idle(&surface->resource);
     ++surface->resource.map_count;
 
     if (!(surface->resource.access_flags & WINED3D_RESOURCE_ACCESS_CPU))
@@ -4624,12 +4606,24 @@ static HRESULT surface_cpu_blt(struct wined3d_surface *dst_surface, const RECT *
                     }
                     else
                     {
+/* Doubling the width is the common case for old games running at 320x240 or
+ * 320x200, give it a loop without the fixed point position. */
 #define STRETCH_ROW(type) \
 do { \
     const type *s = (const type *)sbuf; \
     type *d = (type *)dbuf; \
-    for (x = sx = 0; x < dstwidth; ++x, sx += xinc) \
-        d[x] = s[sx >> 16]; \
+    if (xinc == 0x8000) \
+    { \
+        for (x = 0; x < dstwidth - 1; x += 2) \
+            d[x] = d[x + 1] = s[x >> 1]; \
+        if (x < dstwidth) \
+            d[x] = s[x >> 1]; \
+    } \
+    else \
+    { \
+        for (x = sx = 0; x < dstwidth; ++x, sx += xinc) \
+            d[x] = s[sx >> 16]; \
+    } \
 } while(0)
 
                         switch(bpp)
@@ -4647,15 +4641,12 @@ do { \
                             {
                                 const BYTE *s;
                                 BYTE *d = dbuf;
-                                for (x = sx = 0; x < dstwidth; x++, sx+= xinc)
+                                for (x = sx = 0; x < dstwidth; ++x, sx += xinc)
                                 {
-                                    DWORD pixel;
-
                                     s = sbuf + 3 * (sx >> 16);
-                                    pixel = s[0] | (s[1] << 8) | (s[2] << 16);
-                                    d[0] = (pixel      ) & 0xff;
-                                    d[1] = (pixel >>  8) & 0xff;
-                                    d[2] = (pixel >> 16) & 0xff;
+                                    d[0] = s[0];
+                                    d[1] = s[1];
+                                    d[2] = s[2];
                                     d += 3;
                                 }
                                 break;
@@ -4677,6 +4668,8 @@ do { \
             LONG dstyinc = dst_map.row_pitch, dstxinc = bpp;
             DWORD keylow = 0xffffffff, keyhigh = 0, keymask = 0xffffffff;
             DWORD destkeylow = 0x0, destkeyhigh = 0xffffffff, destkeymask = 0xffffffff;
+            BOOL dst_key = !!(flags & (WINEDDBLT_KEYDEST | WINEDDBLT_KEYDESTOVERRIDE));
+
             if (flags & (WINEDDBLT_KEYSRC | WINEDDBLT_KEYDEST | WINEDDBLT_KEYSRCOVERRIDE | WINEDDBLT_KEYDESTOVERRIDE))
             {
                 /* The color keying flags are checked for correctness in ddraw */
@@ -4823,51 +4816,129 @@ do { \
     } \
 } while(0)
 
-            switch (bpp)
+#define COPY_COLORKEY(type) \
+do { \
+    const type *s = (const type *)sbase; \
+    type *d = (type *)dbuf; \
+    for (y = 0; y < dstheight; ++y) \
+    { \
+        for (x = 0; x < dstwidth; ++x) \
+        { \
+            if ((DWORD)((s[x] & keymask) - keylow) > keyrange) \
+                d[x] = s[x]; \
+        } \
+        s = (const type *)((const BYTE *)s + src_map.row_pitch); \
+        d = (type *)((BYTE *)d + dst_map.row_pitch); \
+    } \
+} while(0)
+
+#define STRETCH_COLORKEY(type) \
+do { \
+    const type *s; \
+    type *d = (type *)dbuf; \
+    for (y = sy = 0; y < dstheight; ++y, sy += yinc) \
+    { \
+        s = (const type *)(sbase + (sy >> 16) * src_map.row_pitch); \
+        for (x = sx = 0; x < dstwidth; ++x, sx += xinc) \
+        { \
+            type tmp = s[sx >> 16]; \
+            if ((DWORD)((tmp & keymask) - keylow) > keyrange) \
+                d[x] = tmp; \
+        } \
+        d = (type *)((BYTE *)d + dst_map.row_pitch); \
+    } \
+} while(0)
+
+            /* Source color keyed blits without mirroring or a destination
+             * key are by far the most common case. Give them loops with a
+             * single unsigned range check, and without the fixed point
+             * stepping if they aren't stretched either. */
+            if (dstxinc == bpp && dstyinc == dst_map.row_pitch
+                    && !dst_key && keylow <= keyhigh && (bpp == 1 || bpp == 2 || bpp == 4))
             {
-                case 1:
-                    COPY_COLORKEY_FX(BYTE);
-                    break;
-                case 2:
-                    COPY_COLORKEY_FX(WORD);
-                    break;
-                case 4:
-                    COPY_COLORKEY_FX(DWORD);
-                    break;
-                case 3:
+                DWORD keyrange = keyhigh - keylow;
+
+                if (xinc == 1 << 16 && yinc == 1 << 16)
                 {
-                    const BYTE *s;
-                    BYTE *d = dbuf, *dx;
-                    for (y = sy = 0; y < dstheight; ++y, sy += yinc)
+                    switch (bpp)
                     {
-                        sbuf = sbase + (sy >> 16) * src_map.row_pitch;
-                        dx = d;
-                        for (x = sx = 0; x < dstwidth; ++x, sx+= xinc)
+                        case 1:
+                            COPY_COLORKEY(BYTE);
+                            break;
+                        case 2:
+                            COPY_COLORKEY(WORD);
+                            break;
+                        case 4:
+                            COPY_COLORKEY(DWORD);
+                            break;
+                    }
+                }
+                else
+                {
+                    switch (bpp)
+                    {
+                        case 1:
+                            STRETCH_COLORKEY(BYTE);
+                            break;
+                        case 2:
+                            STRETCH_COLORKEY(WORD);
+                            break;
+                        case 4:
+                            STRETCH_COLORKEY(DWORD);
+                            break;
+                    }
+                }
+            }
+            else
+            {
+                switch (bpp)
+                {
+                    case 1:
+                        COPY_COLORKEY_FX(BYTE);
+                        break;
+                    case 2:
+                        COPY_COLORKEY_FX(WORD);
+                        break;
+                    case 4:
+                        COPY_COLORKEY_FX(DWORD);
+                        break;
+                    case 3:
+                    {
+                        const BYTE *s;
+                        BYTE *d = dbuf, *dx;
+                        for (y = sy = 0; y < dstheight; ++y, sy += yinc)
                         {
-                            DWORD pixel, dpixel = 0;
-                            s = sbuf + 3 * (sx>>16);
-                            pixel = s[0] | (s[1] << 8) | (s[2] << 16);
-                            dpixel = dx[0] | (dx[1] << 8 ) | (dx[2] << 16);
-                            if (((pixel & keymask) < keylow || (pixel & keymask) > keyhigh)
-                                    && ((dpixel & keymask) >= destkeylow || (dpixel & keymask) <= keyhigh))
+                            sbuf = sbase + (sy >> 16) * src_map.row_pitch;
+                            dx = d;
+                            for (x = sx = 0; x < dstwidth; ++x, sx+= xinc)
                             {
-                                dx[0] = (pixel      ) & 0xff;
-                                dx[1] = (pixel >>  8) & 0xff;
-                                dx[2] = (pixel >> 16) & 0xff;
+                                DWORD pixel, dpixel = 0;
+                                s = sbuf + 3 * (sx>>16);
+                                pixel = s[0] | (s[1] << 8) | (s[2] << 16);
+                                dpixel = dx[0] | (dx[1] << 8 ) | (dx[2] << 16);
+                                if (((pixel & keymask) < keylow || (pixel & keymask) > keyhigh)
+                                        && ((dpixel & keymask) >= destkeylow || (dpixel & keymask) <= keyhigh))
+                                {
+                                    dx[0] = (pixel      ) & 0xff;
+                                    dx[1] = (pixel >>  8) & 0xff;
+                                    dx[2] = (pixel >> 16) & 0xff;
+                                }
+                                dx += dstxinc;
                             }
-                            dx += dstxinc;
+                            d += dstyinc;
                         }
-                        d += dstyinc;
+                        break;
                     }
-                    break;
-                }
-                default:
-                    FIXME("%s color-keyed blit not implemented for bpp %u!\n",
-                          (flags & WINEDDBLT_KEYSRC) ? "Source" : "Destination", bpp * 8);
-                    hr = WINED3DERR_NOTAVAILABLE;
-                    goto error;
+                    default:
+                        FIXME("%s color-keyed blit not implemented for bpp %u!\n",
+                              (flags & WINEDDBLT_KEYSRC) ? "Source" : "Destination", bpp * 8);
+                        hr = WINED3DERR_NOTAVAILABLE;
+                        goto error;
 #undef COPY_COLORKEY_FX
+                }
             }
+#undef STRETCH_COLORKEY
+#undef COPY_COLORKEY
         }
     }
 
@@ -4989,6 +5060,10 @@ HRESULT wined3d_surface_blt(struct wined3d_surface *dst_surface, const RECT *dst
         return WINEDDERR_SURFACEBUSY;
     }
 
+    wined3d_resource_wait_idle(&dst_surface->resource);
+    if (src_surface)
+        wined3d_resource_wait_idle(&src_surface->resource);
+
     if (dst_rect->left >= dst_rect->right || dst_rect->top >= dst_rect->bottom
             || dst_rect->left > dst_surface->resource.width || dst_rect->left < 0
             || dst_rect->top > dst_surface->resource.height || dst_rect->top < 0
@@ -489,6 +489,8 @@ void wined3d_texture_load(struct wined3d_texture *texture,
 void CDECL wined3d_texture_preload(struct wined3d_texture *texture)
 {
     struct wined3d_context *context;
+
+    wined3d_resource_wait_idle(&texture->resource);
     context = context_acquire(texture->resource.device, NULL);
     wined3d_texture_load(texture, context, texture->flags & WINED3D_TEXTURE_IS_SRGB);
     context_release(context);
@@ -538,6 +540,7 @@ DWORD CDECL wined3d_texture_set_lod(struct wined3d_texture *texture, DWORD lod)
 
     if (texture->lod != lod)
     {
+        wined3d_resource_wait_idle(&texture->resource);
         texture->lod = lod;
 
         texture->texture_rgb.base_level = ~0u;
@@ -629,6 +632,8 @@ HRESULT CDECL wined3d_texture_update_desc(struct wined3d_texture *texture, UINT
         return WINED3DERR_INVALIDCALL;
     }
 
+    wined3d_resource_wait_idle(&texture->resource);
+
     if (texture->resource.type == WINED3D_RTYPE_TEXTURE_3D)
     {
         WARN("Not supported on 3D textures.\n");
@@ -747,6 +752,7 @@ HRESULT CDECL wined3d_texture_add_dirty_region(struct wined3d_texture *texture,
         return WINED3DERR_INVALIDCALL;
     }
 
+    wined3d_resource_wait_idle(&texture->resource);
     texture->texture_ops->texture_sub_resource_add_dirty_region(sub_resource, dirty_region);
 
     return WINED3D_OK;
@@ -1602,6 +1608,8 @@ HRESULT CDECL wined3d_texture_get_dc(struct wined3d_texture *texture, unsigned i
     if (surface->resource.map_count)
         return WINED3DERR_INVALIDCALL;
 
+    wined3d_resource_wait_idle(&texture->resource);
+
     if (device->d3d_initialized)
         context = context_acquire(device, NULL);
 
@@ -519,6 +519,8 @@ HRESULT wined3d_volume_map(struct wined3d_volume *volume,
         return WINED3DERR_INVALIDCALL;
     }
 
+    wined3d_resource_wait_idle(&volume->resource);
+
     flags = wined3d_resource_sanitize_map_flags(&volume->resource, flags);
 
     if (volume->resource.map_binding == WINED3D_LOCATION_BUFFER)
@@ -290,10 +290,13 @@ struct wined3d_settings
     int allow_multisampling;
     BOOL strict_draw_ordering;
     BOOL always_offscreen;
+    BOOL cs_multithreaded;
     unsigned int max_sm_vs;
     unsigned int max_sm_gs;
     unsigned int max_sm_ps;
     BOOL no_3d;
+    char *shader_cache_path;
+    unsigned int shader_cache_size;
 };
 
 extern struct wined3d_settings wined3d_settings DECLSPEC_HIDDEN;
@@ -2231,6 +2234,7 @@ void device_resource_released(struct wined3d_device *device, struct wined3d_reso
 void device_switch_onscreen_ds(struct wined3d_device *device, struct wined3d_context *context,
         struct wined3d_surface *depth_stencil) DECLSPEC_HIDDEN;
 void device_invalidate_state(const struct wined3d_device *device, DWORD state) DECLSPEC_HIDDEN;
+void device_invalidate_shader_constants(const struct wined3d_device *device, DWORD mask) DECLSPEC_HIDDEN;
 
 static inline BOOL isStateDirty(const struct wined3d_context *context, DWORD state)
 {
@@ -2257,6 +2261,7 @@ struct wined3d_resource
     LONG ref;
     LONG bind_count;
     LONG map_count;
+    ULONG access_fence;
     struct wined3d_device *device;
     enum wined3d_resource_type type;
     enum wined3d_gl_resource_type gl_type;
@@ -2299,6 +2304,7 @@ HRESULT resource_init(struct wined3d_resource *resource, struct wined3d_device *
         DWORD usage, enum wined3d_pool pool, UINT width, UINT height, UINT depth, UINT size,
         void *parent, const struct wined3d_parent_ops *parent_ops,
         const struct wined3d_resource_ops *resource_ops) DECLSPEC_HIDDEN;
+void resource_set_access_fence(struct wined3d_resource *resource, ULONG fence) DECLSPEC_HIDDEN;
 void resource_unload(struct wined3d_resource *resource) DECLSPEC_HIDDEN;
 BOOL wined3d_resource_allocate_sysmem(struct wined3d_resource *resource) DECLSPEC_HIDDEN;
 void wined3d_resource_free_sysmem(struct wined3d_resource *resource) DECLSPEC_HIDDEN;
@@ -2307,6 +2313,7 @@ GLenum wined3d_resource_gl_legacy_map_flags(DWORD d3d_flags) DECLSPEC_HIDDEN;
 BOOL wined3d_resource_is_offscreen(struct wined3d_resource *resource) DECLSPEC_HIDDEN;
 DWORD wined3d_resource_sanitize_map_flags(const struct wined3d_resource *resource, DWORD flags) DECLSPEC_HIDDEN;
 void wined3d_resource_update_draw_binding(struct wined3d_resource *resource) DECLSPEC_HIDDEN;
+void wined3d_resource_wait_idle(struct wined3d_resource *resource) DECLSPEC_HIDDEN;
 
 /* Tests show that the start address of resources is 32 byte aligned */
 #define RESOURCE_ALIGNMENT 16
@@ -2705,6 +2712,7 @@ struct wined3d_cs_ops
 {
     void *(*require_space)(struct wined3d_cs *cs, size_t size);
     void (*submit)(struct wined3d_cs *cs);
+    void (*finish)(struct wined3d_cs *cs);
 };
 
 struct wined3d_cs
@@ -2716,10 +2724,36 @@ struct wined3d_cs
 
     size_t data_size;
     void *data;
+    struct wined3d_cs_stats *stats;
+
+    /* Multithreaded command stream. */
+    struct wined3d_cs_queue *queue;
+    BOOL direct;
+    BOOL executing;
+    unsigned int synchronous;
+    HANDLE thread;
+    DWORD thread_id;
+    HANDLE work_event;
+    LONG waiting_for_work;
+    LONG stopping;
+    CRITICAL_SECTION lock;
+    DWORD producer_tid;
+
+    /* Last GL fence issued after command stream work, and the issuing thread. */
+    GLsync gl_fence;
+    DWORD gl_fence_tid;
+    /* Thread that did GL work it hasn't fenced yet. */
+    DWORD gl_unfenced_tid;
 };
 
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device) DECLSPEC_HIDDEN;
 void wined3d_cs_destroy(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
+void wined3d_cs_finish(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
+void wined3d_cs_wait(struct wined3d_cs *cs, ULONG fence) DECLSPEC_HIDDEN;
+BOOL wined3d_cs_is_executed(const struct wined3d_cs *cs, ULONG fence) DECLSPEC_HIDDEN;
+void wined3d_cs_issue_gl_fence(struct wined3d_cs *cs, struct wined3d_context *context) DECLSPEC_HIDDEN;
+void wined3d_cs_release_gl(struct wined3d_cs *cs, struct wined3d_context *context) DECLSPEC_HIDDEN;
+void wined3d_cs_wait_gl_fence(struct wined3d_cs *cs, struct wined3d_context *context) DECLSPEC_HIDDEN;
 
 void wined3d_cs_emit_clear(struct wined3d_cs *cs, DWORD rect_count, const RECT *rects,
         DWORD flags, const struct wined3d_color *color, float depth, DWORD stencil) DECLSPEC_HIDDEN;
@@ -2728,6 +2762,7 @@ void wined3d_cs_emit_draw(struct wined3d_cs *cs, UINT start_idx, UINT index_coun
 void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *swapchain,
         const RECT *src_rect, const RECT *dst_rect, HWND dst_window_override,
         const RGNDATA *dirty_region, DWORD flags) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_query_issue(struct wined3d_cs *cs, struct wined3d_query *query, DWORD flags) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_reset_state(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_clip_plane(struct wined3d_cs *cs, UINT plane_idx,
         const struct wined3d_vec4 *plane) DECLSPEC_HIDDEN;
@@ -2735,10 +2770,13 @@ void wined3d_cs_emit_set_color_key(struct wined3d_cs *cs, struct wined3d_texture
         WORD flags, const struct wined3d_color_key *color_key) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_constant_buffer(struct wined3d_cs *cs, enum wined3d_shader_type type,
         UINT cb_idx, struct wined3d_buffer *buffer) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_set_constants(struct wined3d_cs *cs, DWORD type,
+        unsigned int start_idx, unsigned int count, const void *constants) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_depth_stencil_view(struct wined3d_cs *cs,
         struct wined3d_rendertarget_view *view) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_index_buffer(struct wined3d_cs *cs, struct wined3d_buffer *buffer,
         enum wined3d_format_id format_id) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_set_light(struct wined3d_cs *cs, const struct wined3d_light_info *light) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_material(struct wined3d_cs *cs, const struct wined3d_material *material) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_predication(struct wined3d_cs *cs,
         struct wined3d_query *predicate, BOOL value) DECLSPEC_HIDDEN;
@@ -2797,6 +2835,7 @@ struct wined3d_query
     enum wined3d_query_type type;
     DWORD data_size;
     void                     *extendedData;
+    ULONG issue_fence;
 };
 
 /* TODO: Add tests and support for FLOAT16_4 POSITIONT, D3DCOLOR position, other
@@ -3390,6 +3429,40 @@ static inline BOOL needs_srgb_write(const struct wined3d_context *context,
 BOOL wined3d_dxtn_init(void) DECLSPEC_HIDDEN;
 void wined3d_dxtn_free(void) DECLSPEC_HIDDEN;
 
+enum wined3d_shader_cache_type
+{
+    WINED3D_SHADER_CACHE_GLSL_VS,
+    WINED3D_SHADER_CACHE_GLSL_PS,
+    WINED3D_SHADER_CACHE_GL_PROGRAM,
+};
+
+struct wined3d_shader_cache_key
+{
+    DWORD type;
+    DWORD check;
+    ULONGLONG hash;
+};
+
+struct wined3d_shader_cache_entry
+{
+    DWORD format;
+    DWORD extra_size;
+    DWORD data_size;
+    const BYTE *extra;
+    const BYTE *data;
+};
+
+void wined3d_shader_cache_init(void) DECLSPEC_HIDDEN;
+BOOL wined3d_shader_cache_enabled(void) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_key_init(struct wined3d_shader_cache_key *key, DWORD type) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_key_add(struct wined3d_shader_cache_key *key,
+        const void *data, SIZE_T size) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_key_add_string(struct wined3d_shader_cache_key *key, const char *str) DECLSPEC_HIDDEN;
+/* The returned entry is a single allocation, to be freed with HeapFree(). */
+struct wined3d_shader_cache_entry *wined3d_shader_cache_load(const struct wined3d_shader_cache_key *key) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_store(const struct wined3d_shader_cache_key *key, DWORD format,
+        const void *extra, DWORD extra_size, const void *data, DWORD data_size) DECLSPEC_HIDDEN;
+
 /* The WNDCLASS-Name for the fake window which we use to retrieve the GL capabilities */
 #define WINED3D_OPENGL_WINDOW_CLASS_NAME "WineD3D_OpenGL"
 
@@ -25,6 +25,12 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
+#ifdef HAVE_SYS_POLL_H
+#include <sys/poll.h>
+#endif
 
 #include <X11/Xlib.h>
 #include <X11/Xresource.h>
@@ -1570,8 +1576,13 @@ struct x11drv_window_surface
     void                 *bits;
 #ifdef HAVE_LIBXXSHM
     XShmSegmentInfo       shminfo;
+    BOOL                  double_buffer;  /* bits are separate from the shm image */
+    BOOL                  shm_pending;    /* waiting for the completion of the last upload */
+    unsigned long         shm_serial;     /* request serial of the last upload */
+    RECT                  exposed;        /* rows to upload even if the shm image already has them */
 #endif
     CRITICAL_SECTION      crit;
+    CRITICAL_SECTION      upload_crit;    /* serializes uploads, taken before crit */
     BITMAPINFO            info;   /* variable size, must be last */
 };
 
@@ -1808,6 +1819,76 @@ failed:
     XDestroyImage( image );
     return NULL;
 }
+
+/* append the rows [top,bottom) to the band list, merging with the last band once the list is full */
+static int add_damage_band( XRectangle *bands, int count, int max_bands, const RECT *rect,
+                            int top, int bottom )
+{
+    if (count == max_bands)
+    {
+        bands[count - 1].height = bottom - bands[count - 1].y;
+        return count;
+    }
+    bands[count].x = rect->left;
+    bands[count].y = top;
+    bands[count].width = rect->right - rect->left;
+    bands[count].height = bottom - top;
+    return count + 1;
+}
+
+static Bool is_shm_completion( Display *display, XEvent *event, XPointer arg )
+{
+    struct x11drv_window_surface *surface = (struct x11drv_window_surface *)arg;
+
+    return (event->type == XShmGetEventBase( display ) + ShmCompletion &&
+            ((XShmCompletionEvent *)event)->shmseg == surface->shminfo.shmseg);
+}
+
+/* wait until the X server is done reading the shm image; must be called with the upload lock held */
+static void wait_shm_completion( struct x11drv_window_surface *surface )
+{
+    struct pollfd pfd;
+    XEvent event;
+
+    if (!surface->shm_pending) return;
+
+    /* if the put failed (e.g. the window is gone) no event comes, but the error
+     * reply still marks the request as processed, so no round trip is needed */
+    pfd.fd = ConnectionNumber( gdi_display );
+    pfd.events = POLLIN;
+    while (!XCheckIfEvent( gdi_display, &event, is_shm_completion, (XPointer)surface ) &&
+           (long)(LastKnownRequestProcessed( gdi_display ) - surface->shm_serial) < 0)
+        poll( &pfd, 1, 10 );  /* another thread may read the event first, don't sleep long */
+    surface->shm_pending = FALSE;
+}
+
+/* copy the rows that changed since the last upload into the shm image, and
+ * return them as a list of bands together with the exposed rows; returns the
+ * number of bands */
+static int copy_damaged_rows( struct x11drv_window_surface *surface, const RECT *rect,
+                              const RECT *exposed, XRectangle *bands, int max_bands )
+{
+    int bpp = surface->image->bits_per_pixel / 8;
+    int stride = surface->image->bytes_per_line;
+    int x = rect->left * bpp, len = (rect->right - rect->left) * bpp;
+    unsigned char *src = (unsigned char *)surface->bits + rect->top * stride + x;
+    unsigned char *dst = (unsigned char *)surface->image->data + rect->top * stride + x;
+    int y, count = 0, start = -1;
+
+    for (y = rect->top; y < rect->bottom; y++, src += stride, dst += stride)
+    {
+        if ((y < exposed->top || y >= exposed->bottom) && !memcmp( src, dst, len ))
+        {
+            if (start != -1) count = add_damage_band( bands, count, max_bands, rect, start, y );
+            start = -1;
+            continue;
+        }
+        memcpy( dst, src, len );
+        if (start == -1) start = y;
+    }
+    if (start != -1) count = add_damage_band( bands, count, max_bands, rect, start, y );
+    return count;
+}
 #endif /* HAVE_LIBXXSHM */
 
 /***********************************************************************
@@ -1882,6 +1963,63 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
     window_surface->funcs->unlock( window_surface );
 }
 
+#ifdef HAVE_LIBXXSHM
+#define MAX_DAMAGE_BANDS 32
+
+/***********************************************************************
+ *           flush_double_buffer
+ *
+ * Flush a double-buffered surface. Only the rows that changed since the last
+ * upload are copied to the shm image, and the image is sent outside of the
+ * surface lock so that the application can keep painting meanwhile.
+ */
+static void flush_double_buffer( struct x11drv_window_surface *surface )
+{
+    XRectangle bands[MAX_DAMAGE_BANDS];
+    RECT rect, exposed;
+    int i, count = 0;
+
+    EnterCriticalSection( &surface->upload_crit );
+    /* the shm image can't be modified until the server is done reading it */
+    wait_shm_completion( surface );
+
+    surface->header.funcs->lock( &surface->header );
+    SetRect( &rect, 0, 0, surface->header.rect.right - surface->header.rect.left,
+             surface->header.rect.bottom - surface->header.rect.top );
+    if (IntersectRect( &rect, &rect, &surface->bounds ))
+    {
+        TRACE( "flushing %p bounds %s bits %p\n", surface, wine_dbgstr_rect( &surface->bounds ), surface->bits );
+
+        if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
+        /* the server has discarded the exposed contents, they have to be sent again */
+        if (!IntersectRect( &exposed, &rect, &surface->exposed )) SetRectEmpty( &exposed );
+        count = copy_damaged_rows( surface, &rect, &exposed, bands, MAX_DAMAGE_BANDS );
+    }
+    reset_bounds( &surface->bounds );
+    reset_bounds( &surface->exposed );
+    surface->header.funcs->unlock( &surface->header );
+
+    TRACE( "%p: uploading %u bands\n", surface, count );
+    XLockDisplay( gdi_display );
+    for (i = 0; i < count; i++)
+    {
+        if (i == count - 1) surface->shm_serial = NextRequest( gdi_display );
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
+                      bands[i].x, bands[i].y,
+                      surface->header.rect.left + bands[i].x,
+                      surface->header.rect.top + bands[i].y,
+                      bands[i].width, bands[i].height, i == count - 1 );
+    }
+    XUnlockDisplay( gdi_display );
+    if (count)
+    {
+        surface->shm_pending = TRUE;
+        XFlush( gdi_display );
+    }
+    LeaveCriticalSection( &surface->upload_crit );
+}
+#endif /* HAVE_LIBXXSHM */
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
@@ -1892,6 +2030,14 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
     unsigned char *dst = (unsigned char *)surface->image->data;
     struct bitblt_coords coords;
 
+#ifdef HAVE_LIBXXSHM
+    if (surface->double_buffer)
+    {
+        flush_double_buffer( surface );
+        return;
+    }
+#endif
+
     window_surface->funcs->lock( window_surface );
     coords.x = 0;
     coords.y = 0;
@@ -1958,6 +2104,7 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
 #ifdef HAVE_LIBXXSHM
         if (surface->shminfo.shmid != -1)
         {
+            wait_shm_completion( surface );
             XShmDetach( gdi_display, &surface->shminfo );
             shmdt( surface->shminfo.shmaddr );
         }
@@ -1969,6 +2116,8 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
     }
     surface->crit.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection( &surface->crit );
+    surface->upload_crit.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &surface->upload_crit );
     if (surface->region) DeleteObject( surface->region );
     HeapFree( GetProcessHeap(), 0, surface );
 }
@@ -2008,6 +2157,8 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
 
     InitializeCriticalSection( &surface->crit );
     surface->crit.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": surface");
+    InitializeCriticalSection( &surface->upload_crit );
+    surface->upload_crit.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": surface upload");
 
     surface->header.funcs = &x11drv_surface_funcs;
     surface->header.rect  = *rect;
@@ -2016,6 +2167,9 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     surface->is_argb = (use_alpha && vis->depth == 32 && surface->info.bmiHeader.biCompression == BI_RGB);
     set_color_key( surface, color_key );
     reset_bounds( &surface->bounds );
+#ifdef HAVE_LIBXXSHM
+    reset_bounds( &surface->exposed );
+#endif
 
 #ifdef HAVE_LIBXXSHM
     surface->image = create_shm_image( vis, width, height, &surface->shminfo );
@@ -2040,6 +2194,16 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
                                           surface->info.bmiHeader.biSizeImage )))
             goto failed;
     }
+#ifdef HAVE_LIBXXSHM
+    else if (surface->shminfo.shmid != -1 && double_buffered_surfaces && format->bits_per_pixel >= 16)
+    {
+        /* paint into separate bits so that the shm image is only touched when uploading */
+        if (!(surface->bits  = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                          surface->info.bmiHeader.biSizeImage )))
+            goto failed;
+        surface->double_buffer = TRUE;
+    }
+#endif
     else surface->bits = surface->image->data;
 
     TRACE( "created %p for %lx %s bits %p-%p image %p\n", surface, window, wine_dbgstr_rect(rect),
@@ -2082,6 +2246,9 @@ HRGN expose_surface( struct window_surface *window_surface, const RECT *rect )
 
     window_surface->funcs->lock( window_surface );
     add_bounds_rect( &surface->bounds, rect );
+#ifdef HAVE_LIBXXSHM
+    if (surface->double_buffer) add_bounds_rect( &surface->exposed, rect );
+#endif
     if (surface->region)
     {
         region = CreateRectRgnIndirect( rect );
@@ -26,6 +26,7 @@
  * clients and servers (www.winsite.com got a lot of those).
  */
 
+#define _GNU_SOURCE  /* for recvmmsg and sendmmsg */
 #include "config.h"
 #include "wine/port.h"
 
@@ -64,6 +65,9 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
@@ -500,11 +504,34 @@ struct ws2_async
     DWORD                               flags;
     DWORD                              *lpFlags;
     WSABUF                             *control;
+    struct ws2_async                   *batch_next;   /* next in the thread's batch list */
+    LONG                                batch_state;
+    unsigned int                        batch_type;   /* ASYNC_TYPE_READ or ASYNC_TYPE_WRITE */
+    BOOL                                batch_single; /* needs its own system call */
+    NTSTATUS                            batch_status; /* result when completed by another batch */
+    int                                 batch_result;
     unsigned int                        n_iovecs;
     unsigned int                        first_iovec;
     struct iovec                        iovec[1];
 };
 
+/* overlapped datagram operations are kept in a per-thread list, so that the callback
+ * of one of them can have the server wake up the operations queued after it, and then
+ * transfer their datagrams with a single system call. The list is only
+ * modified by the async callbacks, which all run on the owning thread with signals
+ * blocked, except for new entries that are pushed atomically. */
+enum ws2_batch_state
+{
+    BATCH_NONE,         /* not in a batch list */
+    BATCH_REGISTERING,  /* not queued in the server yet */
+    BATCH_QUEUED,       /* queued in the server, can be completed by an older operation */
+    BATCH_DONE,         /* completed by an older operation, waiting for its own callback */
+    BATCH_ORPHANED,     /* completed while registering, freed by the registering code */
+    BATCH_DEAD          /* failed to queue, freed by the next callback or on thread exit */
+};
+
+#define WS2_MAX_BATCH 32
+
 struct ws2_accept_async
 {
     struct ws2_async_io io;
@@ -527,6 +554,7 @@ struct ws2_transmitfile_async
     DWORD                 file_read;
     DWORD                 file_bytes;
     DWORD                 bytes_per_send;
+    BOOL                  try_sendfile;
     TRANSMIT_FILE_BUFFERS buffers;
     DWORD                 flags;
     LARGE_INTEGER         offset;
@@ -605,6 +633,9 @@ struct per_thread_data
     int se_len;
     int pe_len;
     char ntoa_buffer[16]; /* 4*3 digits + 3 '.' + 1 '\0' */
+    struct pollfd *fd_cache;
+    unsigned int fd_cache_size;
+    struct ws2_async *batch_list;   /* overlapped datagram operations, newest first */
 };
 
 /* internal: routing description information */
@@ -1083,6 +1114,14 @@ static inline void release_sock_fd( SOCKET s, int fd )
     wine_server_release_fd( SOCKET2HANDLE(s), fd );
 }
 
+/* operations that complete without the server don't queue a completion packet on
+ * success if the socket was set to FILE_SKIP_COMPLETION_PORT_ON_SUCCESS */
+static inline BOOL ws2_needs_completion( ULONG_PTR cvalue, NTSTATUS status, unsigned int options )
+{
+    if (!cvalue) return FALSE;
+    return status < 0 || !(options & FD_OPTION_SKIP_COMPLETION_ON_SUCCESS);
+}
+
 static void _enable_event( HANDLE s, unsigned int event,
                            unsigned int sstate, unsigned int cstate )
 {
@@ -1203,6 +1242,15 @@ static void free_per_thread_data(void)
     ptb->he_buffer = NULL;
     ptb->se_buffer = NULL;
     ptb->pe_buffer = NULL;
+    HeapFree( GetProcessHeap(), 0, ptb->fd_cache );
+
+    /* the other entries belong to operations that are still queued */
+    while (ptb->batch_list)
+    {
+        struct ws2_async *wsa = ptb->batch_list;
+        ptb->batch_list = wsa->batch_next;
+        if (wsa->batch_state == BATCH_DEAD) release_async_io( &wsa->io );
+    }
 
     HeapFree( GetProcessHeap(), 0, ptb );
     NtCurrentTeb()->WinSockData = NULL;
@@ -2230,6 +2278,176 @@ static void WINAPI ws2_async_apc( void *arg, IO_STATUS_BLOCK *iosb, ULONG reserv
     release_async_io( &wsa->io );
 }
 
+/***********************************************************************
+ *              ws2_batch_queue         (INTERNAL)
+ *
+ * Add an overlapped datagram operation to the batch list of the thread,
+ * before it is queued in the server. Returns FALSE if it isn't tracked.
+ */
+static BOOL ws2_batch_queue( struct ws2_async *wsa, int fd, unsigned int type )
+{
+    struct per_thread_data *ptb;
+    struct ws2_async *next;
+
+#ifndef HAVE_RECVMMSG
+    if (type == ASYNC_TYPE_READ) return FALSE;
+#endif
+#ifndef HAVE_SENDMMSG
+    if (type == ASYNC_TYPE_WRITE) return FALSE;
+#endif
+    if (_get_fd_type( fd ) != SOCK_DGRAM || !(ptb = get_per_thread_data())) return FALSE;
+
+    /* the other operations are still tracked so that batches keep the queue order */
+    wsa->batch_single = wsa->flags || wsa->control ||
+                        (type == ASYNC_TYPE_WRITE && wsa->addr && wsa->addr->sa_family == WS_AF_IPX);
+    wsa->batch_type   = type;
+    wsa->batch_state  = BATCH_REGISTERING;
+
+    /* a callback may interrupt us and unlink the head */
+    do
+    {
+        next = ptb->batch_list;
+        wsa->batch_next = next;
+    } while (InterlockedCompareExchangePointer( (void **)&ptb->batch_list, wsa, next ) != next);
+    return TRUE;
+}
+
+/***********************************************************************
+ *              ws2_batch_registered    (INTERNAL)
+ *
+ * Update the state of a batched operation after register_async.
+ */
+static void ws2_batch_registered( struct ws2_async *wsa, NTSTATUS status )
+{
+    if (status != STATUS_PENDING)
+    {
+        /* no callback will run for it, and it can't be unlinked here */
+        wsa->batch_state = BATCH_DEAD;
+        return;
+    }
+    /* its callback may already have run and completed it */
+    if (InterlockedCompareExchange( &wsa->batch_state, BATCH_QUEUED, BATCH_REGISTERING ) == BATCH_ORPHANED
+        && !wsa->completion_func)
+        release_async_io( &wsa->io );
+}
+
+/***********************************************************************
+ *              ws2_batch_complete      (INTERNAL)
+ *
+ * Update the batch list at the end of the callback of an operation.
+ * Returns FALSE if the operation is freed by its registering code.
+ */
+static BOOL ws2_batch_complete( struct ws2_async *wsa, NTSTATUS status )
+{
+    struct per_thread_data *ptb;
+    struct ws2_async **entry, *cur;
+    BOOL registering;
+
+    if (wsa->batch_state == BATCH_NONE) return TRUE;
+
+    registering = (wsa->batch_state == BATCH_REGISTERING);
+    if (status == STATUS_PENDING)
+    {
+        wsa->batch_state = BATCH_QUEUED;
+        return TRUE;
+    }
+
+    ptb = NtCurrentTeb()->WinSockData;
+    entry = &ptb->batch_list;
+    while ((cur = *entry))
+    {
+        if (cur == wsa || cur->batch_state == BATCH_DEAD)
+        {
+            *entry = cur->batch_next;
+            if (cur != wsa) release_async_io( &cur->io );
+        }
+        else entry = &cur->batch_next;
+    }
+    wsa->batch_state = registering ? BATCH_ORPHANED : BATCH_NONE;
+    return !registering;
+}
+
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+/***********************************************************************
+ *              ws2_batch_collect       (INTERNAL)
+ *
+ * Collect the operations that can be transferred together with wsa: wsa
+ * first, then the operations of the same queue registered after it, in
+ * order, up to the first one that needs its own system call.
+ */
+static unsigned int ws2_batch_collect( struct ws2_async *wsa, struct ws2_async **batch )
+{
+    struct per_thread_data *ptb = NtCurrentTeb()->WinSockData;
+    struct ws2_async *ring[WS2_MAX_BATCH - 1], *cur;
+    unsigned int i, count = 0, ret = 1;
+
+    batch[0] = wsa;
+    if (wsa->batch_single) return 1;
+
+    /* the list is newest first, keep the operations closest to wsa */
+    for (cur = ptb->batch_list; cur != wsa; cur = cur->batch_next)
+    {
+        if (cur->batch_state != BATCH_QUEUED) continue;
+        if (cur->hSocket != wsa->hSocket || cur->batch_type != wsa->batch_type) continue;
+        ring[count++ % (WS2_MAX_BATCH - 1)] = cur;
+    }
+
+    for (i = 0; i < min( count, WS2_MAX_BATCH - 1 ); i++)
+    {
+        cur = ring[(count - 1 - i) % (WS2_MAX_BATCH - 1)];
+        if (cur->batch_single) break;
+        batch[ret++] = cur;
+    }
+    return ret;
+}
+
+/***********************************************************************
+ *              ws2_batch_claim         (INTERNAL)
+ *
+ * Have the server wake up the other operations of a batch before their
+ * buffers are used, so that an operation cancelled in the meantime never
+ * gets any data. Returns the number of operations left in the batch.
+ */
+static unsigned int ws2_batch_claim( struct ws2_async **batch, unsigned int count )
+{
+    client_ptr_t iosb[WS2_MAX_BATCH - 1];
+    unsigned int i;
+
+    if (count <= 1) return count;
+    for (i = 1; i < count; i++)
+        iosb[i - 1] = wine_server_client_ptr( batch[i]->user_overlapped ? (void *)batch[i]->user_overlapped
+                                                                        : &batch[i]->local_iosb );
+
+    SERVER_START_REQ( wake_socket_async )
+    {
+        req->handle = wine_server_obj_handle( batch[0]->hSocket );
+        req->type   = batch[0]->batch_type;
+        wine_server_add_data( req, iosb, (count - 1) * sizeof(iosb[0]) );
+        count = wine_server_call( req ) ? 1 : reply->count + 1;
+    }
+    SERVER_END_REQ;
+    return count;
+}
+
+/***********************************************************************
+ *              ws2_batch_done          (INTERNAL)
+ *
+ * Store the results of claimed operations for their own callbacks. The
+ * claimed operations that got nothing do their own transfer instead.
+ */
+static void ws2_batch_done( struct ws2_async **batch, const struct mmsghdr *msgs, unsigned int count )
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+    {
+        batch[i]->batch_status = STATUS_SUCCESS;
+        batch[i]->batch_result = msgs[i].msg_len;
+        batch[i]->batch_state  = BATCH_DONE;
+    }
+}
+#endif
+
 /***********************************************************************
  *              WS2_recv                (INTERNAL)
  *
@@ -2313,6 +2531,59 @@ static int WS2_recv( int fd, struct ws2_async *wsa, int flags )
     return n;
 }
 
+#ifdef HAVE_RECVMMSG
+/***********************************************************************
+ *              WS2_recv_batch          (INTERNAL)
+ *
+ * Receive the datagram of wsa, then the datagrams of the operations
+ * queued after it with a single recvmmsg() call if more are available.
+ */
+static int WS2_recv_batch( int fd, struct ws2_async *wsa )
+{
+    struct ws2_async *batch[WS2_MAX_BATCH];
+    struct mmsghdr msgs[WS2_MAX_BATCH];
+    union generic_unix_sockaddr addrs[WS2_MAX_BATCH];
+    unsigned int i, count = ws2_batch_collect( wsa, batch );
+    struct pollfd pfd;
+    int n, ret;
+
+    ret = WS2_recv( fd, wsa, convert_flags(wsa->flags) );
+    if (ret < 0 || count == 1) return ret;
+
+    /* don't wake up the other operations for nothing */
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll( &pfd, 1, 0 ) != 1 || !(pfd.revents & POLLIN)) return ret;
+    if ((count = ws2_batch_claim( batch, count )) == 1) return ret;
+
+    memset( msgs, 0, count * sizeof(msgs[0]) );
+    for (i = 1; i < count; i++)
+    {
+        if (batch[i]->addr)
+        {
+            msgs[i].msg_hdr.msg_name    = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        }
+        msgs[i].msg_hdr.msg_iov    = batch[i]->iovec + batch[i]->first_iovec;
+        msgs[i].msg_hdr.msg_iovlen = batch[i]->n_iovecs - batch[i]->first_iovec;
+    }
+
+    /* on failure, each claimed operation tries again in its own callback */
+    while ((n = recvmmsg( fd, msgs + 1, count - 1, 0, NULL )) == -1 && errno == EINTR);
+    if (n <= 0) return ret;
+
+    for (i = 1; i <= n; i++)
+    {
+        /* see WS2_recv for connected sockets */
+        if (batch[i]->addr && msgs[i].msg_hdr.msg_namelen)
+            ws_sockaddr_u2ws( &addrs[i].addr, batch[i]->addr, batch[i]->addrlen.ptr );
+    }
+    ws2_batch_done( batch + 1, msgs + 1, n );
+    return ret;
+}
+#endif
+
 /***********************************************************************
  *              WS2_async_recv          (INTERNAL)
  *
@@ -2323,14 +2594,25 @@ static NTSTATUS WS2_async_recv( void *user, IO_STATUS_BLOCK *iosb,
 {
     struct ws2_async *wsa = user;
     int result = 0, fd;
+    BOOL release;
 
-    switch (status)
+    if (wsa->batch_state == BATCH_DONE)
+    {
+        status = wsa->batch_status;
+        result = wsa->batch_result;
+    }
+    else switch (status)
     {
     case STATUS_ALERTED:
         if ((status = wine_server_handle_to_fd( wsa->hSocket, FILE_READ_DATA, &fd, NULL ) ))
             break;
 
-        result = WS2_recv( fd, wsa, convert_flags(wsa->flags) );
+#ifdef HAVE_RECVMMSG
+        if (wsa->batch_state != BATCH_NONE)
+            result = WS2_recv_batch( fd, wsa );
+        else
+#endif
+            result = WS2_recv( fd, wsa, convert_flags(wsa->flags) );
         wine_server_release_fd( wsa->hSocket, fd );
         if (result >= 0)
         {
@@ -2352,6 +2634,7 @@ static NTSTATUS WS2_async_recv( void *user, IO_STATUS_BLOCK *iosb,
         }
         break;
     }
+    release = ws2_batch_complete( wsa, status );
     if (status != STATUS_PENDING)
     {
         iosb->u.Status = status;
@@ -2361,7 +2644,7 @@ static NTSTATUS WS2_async_recv( void *user, IO_STATUS_BLOCK *iosb,
             *apc = ws2_async_apc;
             *arg = wsa;
         }
-        else
+        else if (release)
             release_async_io( &wsa->io );
     }
     return status;
@@ -2543,6 +2826,55 @@ static int WS2_send( int fd, struct ws2_async *wsa, int flags )
     return ret;
 }
 
+#ifdef HAVE_SENDMMSG
+/***********************************************************************
+ *              WS2_send_batch          (INTERNAL)
+ *
+ * Send the datagrams of wsa and of the operations queued after it
+ * with a single sendmmsg() call.
+ */
+static int WS2_send_batch( int fd, struct ws2_async *wsa )
+{
+    struct ws2_async *batch[WS2_MAX_BATCH];
+    struct mmsghdr msgs[WS2_MAX_BATCH];
+    union generic_unix_sockaddr addrs[WS2_MAX_BATCH];
+    unsigned int i, count = ws2_batch_collect( wsa, batch );
+    int n;
+
+    if (count == 1) return WS2_send( fd, wsa, convert_flags(wsa->flags) );
+
+    memset( msgs, 0, count * sizeof(msgs[0]) );
+    for (i = 0; i < count; i++)
+    {
+        if (batch[i]->addr)
+        {
+            msgs[i].msg_hdr.msg_name    = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = ws_sockaddr_ws2u( batch[i]->addr, batch[i]->addrlen.val, &addrs[i] );
+            if (!msgs[i].msg_hdr.msg_namelen)
+            {
+                /* leave the error to the callback of that operation */
+                if (!i) return WS2_send( fd, wsa, 0 );
+                count = i;
+                break;
+            }
+        }
+        msgs[i].msg_hdr.msg_iov    = batch[i]->iovec + batch[i]->first_iovec;
+        msgs[i].msg_hdr.msg_iovlen = batch[i]->n_iovecs - batch[i]->first_iovec;
+    }
+
+    if ((count = ws2_batch_claim( batch, count )) == 1) return WS2_send( fd, wsa, 0 );
+
+    /* on failure, each claimed operation tries again in its own callback */
+    while ((n = sendmmsg( fd, msgs, count, 0 )) == -1 && errno == EINTR);
+    if (n == -1) return errno == EAGAIN ? -1 : WS2_send( fd, wsa, 0 );
+
+    /* datagrams are sent whole */
+    for (i = 0; i < n; i++) batch[i]->first_iovec = batch[i]->n_iovecs;
+    ws2_batch_done( batch + 1, msgs + 1, n - 1 );
+    return msgs[0].msg_len;
+}
+#endif
+
 /***********************************************************************
  *              WS2_async_send          (INTERNAL)
  *
@@ -2553,8 +2885,14 @@ static NTSTATUS WS2_async_send( void *user, IO_STATUS_BLOCK *iosb,
 {
     struct ws2_async *wsa = user;
     int result = 0, fd;
+    BOOL release;
 
-    switch (status)
+    if (wsa->batch_state == BATCH_DONE)
+    {
+        status = wsa->batch_status;
+        iosb->Information += wsa->batch_result;
+    }
+    else switch (status)
     {
     case STATUS_ALERTED:
         if ( wsa->n_iovecs <= wsa->first_iovec )
@@ -2567,7 +2905,12 @@ static NTSTATUS WS2_async_send( void *user, IO_STATUS_BLOCK *iosb,
             break;
 
         /* check to see if the data is ready (non-blocking) */
-        result = WS2_send( fd, wsa, convert_flags(wsa->flags) );
+#ifdef HAVE_SENDMMSG
+        if (wsa->batch_state != BATCH_NONE)
+            result = WS2_send_batch( fd, wsa );
+        else
+#endif
+            result = WS2_send( fd, wsa, convert_flags(wsa->flags) );
         wine_server_release_fd( wsa->hSocket, fd );
 
         if (result >= 0)
@@ -2589,6 +2932,7 @@ static NTSTATUS WS2_async_send( void *user, IO_STATUS_BLOCK *iosb,
         }
         break;
     }
+    release = ws2_batch_complete( wsa, status );
     if (status != STATUS_PENDING)
     {
         iosb->u.Status = status;
@@ -2597,7 +2941,7 @@ static NTSTATUS WS2_async_send( void *user, IO_STATUS_BLOCK *iosb,
             *apc = ws2_async_apc;
             *arg = wsa;
         }
-        else
+        else if (release)
             release_async_io( &wsa->io );
     }
     return status;
@@ -2808,6 +3152,7 @@ static BOOL WINAPI WS2_AcceptEx(SOCKET listener, SOCKET acceptor, PVOID dest, DW
         wsa->read->addr        = NULL;
         wsa->read->addrlen.ptr = NULL;
         wsa->read->control     = NULL;
+        wsa->read->batch_state = BATCH_NONE;
         wsa->read->n_iovecs    = 1;
         wsa->read->first_iovec = 0;
         wsa->read->completion_func = NULL;
@@ -2885,6 +3230,62 @@ static NTSTATUS WS2_ReadFile(HANDLE hFile, PIO_STATUS_BLOCK io_status, char* buf
     return status;
 }
 
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+/***********************************************************************
+ *     WS2_transmitfile_sendfile        (INTERNAL)
+ *
+ * Send the next part of the file directly from the file descriptor,
+ * without copying it through a user space buffer.
+ */
+static NTSTATUS WS2_transmitfile_sendfile( int fd, struct ws2_transmitfile_async *wsa )
+{
+    IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)wsa->write.user_overlapped;
+    size_t count = 0x7ffff000; /* largest transfer Linux performs in one call */
+    off_t offset;
+    ssize_t ret;
+    int file_fd;
+    NTSTATUS status;
+
+    status = wine_server_handle_to_fd( wsa->file, FILE_READ_DATA, &file_fd, NULL );
+    if (status) return status;
+
+    /* when the size of the transfer is limited ensure that we don't go past that limit */
+    if (wsa->file_bytes != 0)
+        count = min(count, wsa->file_bytes - wsa->file_read);
+
+    do
+    {
+        if (wsa->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+        {
+            offset = wsa->offset.QuadPart;
+            ret = sendfile( fd, file_fd, &offset, count );
+        }
+        else
+            ret = sendfile( fd, file_fd, NULL, count );
+    }
+    while (ret == -1 && errno == EINTR);
+    wine_server_release_fd( wsa->file, file_fd );
+
+    TRACE("sent %ld bytes\n", (long)ret);
+    if (ret == -1)
+    {
+        if (errno == EAGAIN) return STATUS_PENDING;
+        /* the file or socket type is not supported, use the generic path */
+        if (errno == EINVAL || errno == ENOSYS || errno == EOVERFLOW) return STATUS_NOT_SUPPORTED;
+        return wsaErrStatus();
+    }
+    if (!ret) return STATUS_END_OF_FILE;
+
+    if (wsa->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+        wsa->offset.QuadPart += ret;
+    wsa->file_read += ret;
+    if (iosb) iosb->Information += ret;
+    if (wsa->file_bytes != 0 && wsa->file_read >= wsa->file_bytes)
+        return STATUS_END_OF_FILE;
+    return STATUS_PENDING;
+}
+#endif
+
 /***********************************************************************
  *     WS2_transmitfile_getbuffer       (INTERNAL)
  *
@@ -2908,6 +3309,19 @@ static NTSTATUS WS2_transmitfile_getbuffer( int fd, struct ws2_transmitfile_asyn
     }
 
     /* process the main file */
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+    if (wsa->file && wsa->try_sendfile)
+    {
+        NTSTATUS status = WS2_transmitfile_sendfile( fd, wsa );
+
+        if (status == STATUS_END_OF_FILE)
+            wsa->file = NULL; /* continue on to the footer */
+        else if (status == STATUS_NOT_SUPPORTED)
+            wsa->try_sendfile = FALSE; /* fall back to reading the file */
+        else
+            return status;
+    }
+#endif
     if (wsa->file)
     {
         DWORD bytes_per_send = wsa->bytes_per_send;
@@ -2967,7 +3381,7 @@ static NTSTATUS WS2_transmitfile_base( int fd, struct ws2_transmitfile_async *ws
     NTSTATUS status;
 
     status = WS2_transmitfile_getbuffer( fd, wsa );
-    if (status == STATUS_PENDING)
+    if (status == STATUS_PENDING && wsa->write.first_iovec < wsa->write.n_iovecs)
     {
         IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)wsa->write.user_overlapped;
         int n;
@@ -3090,6 +3504,7 @@ static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE h, DWORD file_bytes, DWORD
     wsa->file_read             = 0;
     wsa->file_bytes            = file_bytes;
     wsa->bytes_per_send        = bytes_per_send;
+    wsa->try_sendfile          = TRUE;
     wsa->flags                 = flags;
     wsa->offset.QuadPart       = FILE_USE_FILE_POINTER_POSITION;
     wsa->write.hSocket         = SOCKET2HANDLE(s);
@@ -3584,6 +3999,7 @@ static BOOL WINAPI WS2_ConnectEx(SOCKET s, const struct WS_sockaddr* name, int n
             wsa->flags       = 0;
             wsa->lpFlags     = &wsa->flags;
             wsa->control     = NULL;
+            wsa->batch_state = BATCH_NONE;
             wsa->n_iovecs    = sendBuf ? 1 : 0;
             wsa->first_iovec = 0;
             wsa->completion_func = NULL;
@@ -5024,6 +5440,13 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
     else if (overlapped)
     {
         ULONG_PTR cvalue = (overlapped && ((ULONG_PTR)overlapped->hEvent & 1) == 0) ? (ULONG_PTR)overlapped : 0;
+        unsigned int options;
+
+        if (cvalue && !status && (fd = get_sock_fd( s, 0, &options )) != -1)
+        {
+            release_sock_fd( s, fd );
+            if (!ws2_needs_completion( cvalue, STATUS_SUCCESS, options )) cvalue = 0;
+        }
         overlapped->Internal = status;
         overlapped->InternalHigh = total;
         if (overlapped->hEvent) NtSetEvent( overlapped->hEvent, NULL );
@@ -5116,7 +5539,30 @@ int WINAPI WS_recvfrom(SOCKET s, char *buf, INT len, int flags,
         return n;
 }
 
-/* allocate a poll array for the corresponding fd sets */
+/* get the per-thread poll array, large enough for count entries */
+static struct pollfd *get_poll_fds( unsigned int count )
+{
+    struct per_thread_data *ptb = get_per_thread_data();
+    struct pollfd *fds;
+
+    if (count <= ptb->fd_cache_size) return ptb->fd_cache;
+
+    /* grow geometrically so that slowly growing sets don't reallocate on every call */
+    count = max( count, ptb->fd_cache_size * 2 );
+    if (ptb->fd_cache)
+        fds = HeapReAlloc( GetProcessHeap(), 0, ptb->fd_cache, count * sizeof(fds[0]) );
+    else
+        fds = HeapAlloc( GetProcessHeap(), 0, count * sizeof(fds[0]) );
+    if (!fds) return NULL;
+
+    ptb->fd_cache = fds;
+    ptb->fd_cache_size = count;
+    return fds;
+}
+
+/* fill the per-thread poll array for the corresponding fd sets */
+/* whether the sockets are bound is only checked once poll returned events for them,
+ * see filter_unbound_poll_fds, which saves a syscall per idle socket */
 static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set *writefds,
                                        const WS_fd_set *exceptfds, int *count_ptr )
 {
@@ -5132,7 +5578,7 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
         SetLastError(WSAEINVAL);
         return NULL;
     }
-    if (!(fds = HeapAlloc( GetProcessHeap(), 0, count * sizeof(fds[0]))))
+    if (!(fds = get_poll_fds( count )))
     {
         SetLastError( ERROR_NOT_ENOUGH_MEMORY );
         return NULL;
@@ -5142,60 +5588,32 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
         {
             fds[j].fd = get_sock_fd( readfds->fd_array[i], FILE_READ_DATA, NULL );
             if (fds[j].fd == -1) goto failed;
+            fds[j].events = POLLIN;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1)
-            {
-                fds[j].events = POLLIN;
-            }
-            else
-            {
-                release_sock_fd( readfds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
         }
     if (writefds)
         for (i = 0; i < writefds->fd_count; i++, j++)
         {
             fds[j].fd = get_sock_fd( writefds->fd_array[i], FILE_WRITE_DATA, NULL );
             if (fds[j].fd == -1) goto failed;
+            fds[j].events = POLLOUT;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1 ||
-                _get_fd_type(fds[j].fd) == SOCK_DGRAM)
-            {
-                fds[j].events = POLLOUT;
-            }
-            else
-            {
-                release_sock_fd( writefds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
         }
     if (exceptfds)
         for (i = 0; i < exceptfds->fd_count; i++, j++)
         {
+            int oob_inlined = 0;
+            socklen_t olen = sizeof(oob_inlined);
+
             fds[j].fd = get_sock_fd( exceptfds->fd_array[i], 0, NULL );
             if (fds[j].fd == -1) goto failed;
+            fds[j].events = POLLHUP;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1)
-            {
-                int oob_inlined = 0;
-                socklen_t olen = sizeof(oob_inlined);
 
-                fds[j].events = POLLHUP;
-
-                /* Check if we need to test for urgent data or not */
-                getsockopt(fds[j].fd, SOL_SOCKET, SO_OOBINLINE, (char*) &oob_inlined, &olen);
-                if (!oob_inlined)
-                    fds[j].events |= POLLPRI;
-            }
-            else
-            {
-                release_sock_fd( exceptfds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
+            /* Check if we need to test for urgent data or not */
+            getsockopt(fds[j].fd, SOL_SOCKET, SO_OOBINLINE, (char*) &oob_inlined, &olen);
+            if (!oob_inlined)
+                fds[j].events |= POLLPRI;
         }
     return fds;
 
@@ -5211,10 +5629,57 @@ failed:
     if (exceptfds)
         for (i = 0; i < exceptfds->fd_count && j < count; i++, j++)
             if (fds[j].fd != -1) release_sock_fd( exceptfds->fd_array[i], fds[j].fd );
-    HeapFree( GetProcessHeap(), 0, fds );
     return NULL;
 }
 
+/* stop polling sockets that reported events but aren't bound yet */
+/* returns the number of remaining sockets with events */
+static int filter_unbound_poll_fds( const WS_fd_set *readfds, const WS_fd_set *writefds,
+                                    const WS_fd_set *exceptfds, struct pollfd *fds )
+{
+    unsigned int i, j = 0;
+    int ret = 0;
+
+    if (readfds)
+        for (i = 0; i < readfds->fd_count; i++, j++)
+        {
+            if (!fds[j].revents) continue;
+            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1) ret++;
+            else
+            {
+                release_sock_fd( readfds->fd_array[i], fds[j].fd );
+                fds[j].fd = -1;
+                fds[j].revents = 0;
+            }
+        }
+    if (writefds)
+        for (i = 0; i < writefds->fd_count; i++, j++)
+        {
+            if (!fds[j].revents) continue;
+            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1 ||
+                _get_fd_type(fds[j].fd) == SOCK_DGRAM) ret++;
+            else
+            {
+                release_sock_fd( writefds->fd_array[i], fds[j].fd );
+                fds[j].fd = -1;
+                fds[j].revents = 0;
+            }
+        }
+    if (exceptfds)
+        for (i = 0; i < exceptfds->fd_count; i++, j++)
+        {
+            if (!fds[j].revents) continue;
+            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1) ret++;
+            else
+            {
+                release_sock_fd( exceptfds->fd_array[i], fds[j].fd );
+                fds[j].fd = -1;
+                fds[j].revents = 0;
+            }
+        }
+    return ret;
+}
+
 /* release the file descriptor obtained in fd_sets_to_poll */
 /* must be called with the original fd_set arrays, before calling get_poll_results */
 static void release_poll_fds( const WS_fd_set *readfds, const WS_fd_set *writefds,
@@ -5329,6 +5794,7 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
 {
     struct pollfd *pollfds;
     int count, ret, timeout = -1;
+    DWORD start = GetTickCount();
 
     TRACE("read %p, write %p, excp %p timeout %p\n",
           ws_readfds, ws_writefds, ws_exceptfds, ws_timeout);
@@ -5339,12 +5805,29 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
     if (ws_timeout)
         timeout = (ws_timeout->tv_sec * 1000) + (ws_timeout->tv_usec + 999) / 1000;
 
-    ret = do_poll(pollfds, count, timeout);
+    for (;;)
+    {
+        int elapsed, remaining = timeout;
+
+        if (timeout > 0)
+        {
+            elapsed = GetTickCount() - start;
+            remaining = elapsed < timeout ? timeout - elapsed : 0;
+        }
+        ret = do_poll(pollfds, count, remaining);
+        if (ret <= 0) break;
+        /* wait again if only unbound sockets reported events */
+        if (filter_unbound_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds )) break;
+        if (!remaining)
+        {
+            ret = 0;
+            break;
+        }
+    }
     release_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
 
     if (ret == -1) SetLastError(wsaErrno());
     else ret = get_poll_results( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
-    HeapFree( GetProcessHeap(), 0, pollfds );
     return ret;
 }
 
@@ -5367,7 +5850,7 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
         return SOCKET_ERROR;
     }
 
-    if (!(ufds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(ufds[0]))))
+    if (!(ufds = get_poll_fds(count)))
     {
         SetLastError(WSAENOBUFS);
         return SOCKET_ERROR;
@@ -5393,7 +5876,6 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
             wfds[i].revents = WS_POLLNVAL;
     }
 
-    HeapFree(GetProcessHeap(), 0, ufds);
     return ret;
 }
 
@@ -5498,6 +5980,7 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
     wsa->flags       = dwFlags;
     wsa->lpFlags     = &wsa->flags;
     wsa->control     = NULL;
+    wsa->batch_state = BATCH_NONE;
     wsa->n_iovecs    = dwBufferCount;
     wsa->first_iovec = 0;
     for ( i = 0; i < dwBufferCount; i++ )
@@ -5520,8 +6003,11 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         IO_STATUS_BLOCK *iosb = lpOverlapped ? (IO_STATUS_BLOCK *)lpOverlapped : &wsa->local_iosb;
         ULONG_PTR cvalue = (lpOverlapped && ((ULONG_PTR)lpOverlapped->hEvent & 1) == 0) ? (ULONG_PTR)lpOverlapped : 0;
 
+        BOOL batched = FALSE;
+
         wsa->user_overlapped = lpOverlapped;
         wsa->completion_func = lpCompletionRoutine;
+        if (n == -1) batched = ws2_batch_queue( wsa, fd, ASYNC_TYPE_WRITE );
         release_sock_fd( s, fd );
 
         if (n == -1 || n < totalLength)
@@ -5546,7 +6032,8 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
                the async is done. */
             _enable_event(SOCKET2HANDLE(s), FD_WRITE, 0, 0);
 
-            if (err != STATUS_PENDING) HeapFree( GetProcessHeap(), 0, wsa );
+            if (batched) ws2_batch_registered( wsa, err );
+            else if (err != STATUS_PENDING) release_async_io( &wsa->io );
             SetLastError(NtStatusToWSAError( err ));
             return SOCKET_ERROR;
         }
@@ -5556,7 +6043,8 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         if (lpNumberOfBytesSent) *lpNumberOfBytesSent = n;
         if (!wsa->completion_func)
         {
-            if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n );
+            if (ws2_needs_completion( cvalue, STATUS_SUCCESS, options ))
+                WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n );
             if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
             HeapFree( GetProcessHeap(), 0, wsa );
         }
@@ -7585,6 +8073,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
     wsa->addr        = lpFrom;
     wsa->addrlen.ptr = lpFromlen;
     wsa->control     = lpControlBuffer;
+    wsa->batch_state = BATCH_NONE;
     wsa->n_iovecs    = dwBufferCount;
     wsa->first_iovec = 0;
     for (i = 0; i < dwBufferCount; i++)
@@ -7623,9 +8112,11 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         if (overlapped)
         {
             IO_STATUS_BLOCK *iosb = lpOverlapped ? (IO_STATUS_BLOCK *)lpOverlapped : &wsa->local_iosb;
+            BOOL batched = FALSE;
 
             wsa->user_overlapped = lpOverlapped;
             wsa->completion_func = lpCompletionRoutine;
+            if (n == -1) batched = ws2_batch_queue( wsa, fd, ASYNC_TYPE_READ );
             release_sock_fd( s, fd );
 
             if (n == -1)
@@ -7646,7 +8137,8 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
                 }
                 SERVER_END_REQ;
 
-                if (err != STATUS_PENDING) HeapFree( GetProcessHeap(), 0, wsa );
+                if (batched) ws2_batch_registered( wsa, err );
+                else if (err != STATUS_PENDING) release_async_io( &wsa->io );
                 SetLastError(NtStatusToWSAError( err ));
                 return SOCKET_ERROR;
             }
@@ -7655,7 +8147,8 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             iosb->Information = n;
             if (!wsa->completion_func)
             {
-                if (cvalue) WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n );
+                if (ws2_needs_completion( cvalue, STATUS_SUCCESS, options ))
+                    WS_AddCompletion( s, cvalue, STATUS_SUCCESS, n );
                 if (lpOverlapped->hEvent) SetEvent( lpOverlapped->hEvent );
                 HeapFree( GetProcessHeap(), 0, wsa );
             }
@@ -3974,6 +3974,88 @@ todo_wine
     ok(FD_ISSET(fdWrite, &writefds), "fdWrite socket is not in the set\n");
     closesocket(fdWrite);
 }
+
+static DWORD WINAPI delayed_send_thread(void *param)
+{
+    SOCKET s = *(SOCKET *)param;
+
+    Sleep(200);
+    ok(send(s, "test", 4, 0) == 4, "failed to send data\n");
+    return 0;
+}
+
+/* sockets that are neither bound nor connected never become ready */
+static void test_select_unbound(void)
+{
+    SOCKET fdUnbound, fdRead, fdWrite;
+    fd_set readfds, writefds, exceptfds;
+    struct timeval select_timeout;
+    HANDLE thread;
+    DWORD ticks, id;
+    char buffer[4];
+    int ret;
+
+    fdUnbound = socket(AF_INET, SOCK_STREAM, 0);
+    ok(fdUnbound != INVALID_SOCKET, "socket failed unexpectedly: %d\n", WSAGetLastError());
+    ok(!tcp_socketpair(&fdRead, &fdWrite), "creating socket pair failed\n");
+
+    /* the wait is not cut short, and not restarted with the full timeout */
+    FD_ZERO_ALL();
+    FD_SET_ALL(fdUnbound);
+    FD_SET(fdRead, &readfds);
+    select_timeout.tv_sec = 0;
+    select_timeout.tv_usec = 300000;
+    ticks = GetTickCount();
+    ret = select(0, &readfds, &writefds, &exceptfds, &select_timeout);
+    ticks = GetTickCount() - ticks;
+    ok(ret == 0, "select returned %d\n", ret);
+    ok(ticks >= 250, "select returned after %u ms, expected 300 ms\n", ticks);
+    ok(ticks < 1000, "select returned after %u ms, expected 300 ms\n", ticks);
+    ok(!FD_ISSET(fdUnbound, &readfds), "unbound socket is in the read set\n");
+    ok(!FD_ISSET(fdUnbound, &writefds), "unbound socket is in the write set\n");
+    ok(!FD_ISSET(fdUnbound, &exceptfds), "unbound socket is in the except set\n");
+    ok(!FD_ISSET(fdRead, &readfds), "fdRead socket is in the read set\n");
+
+    /* only the sockets that are ready are reported */
+    FD_ZERO_ALL();
+    FD_SET_ALL(fdUnbound);
+    FD_SET(fdRead, &readfds);
+    FD_SET(fdWrite, &writefds);
+    ret = select(0, &readfds, &writefds, &exceptfds, &select_timeout);
+    ok(ret == 1, "select returned %d\n", ret);
+    ok(!FD_ISSET(fdUnbound, &readfds), "unbound socket is in the read set\n");
+    ok(!FD_ISSET(fdUnbound, &writefds), "unbound socket is in the write set\n");
+    ok(!FD_ISSET(fdUnbound, &exceptfds), "unbound socket is in the except set\n");
+    ok(FD_ISSET(fdWrite, &writefds), "fdWrite socket is not in the write set\n");
+
+    /* a socket becoming ready later still ends the wait */
+    thread = CreateThread(NULL, 0, delayed_send_thread, &fdWrite, 0, &id);
+    ok(thread != NULL, "CreateThread failed unexpectedly: %d\n", GetLastError());
+    FD_ZERO_ALL();
+    FD_SET_ALL(fdUnbound);
+    FD_SET(fdRead, &readfds);
+    select_timeout.tv_sec = 5;
+    select_timeout.tv_usec = 0;
+    ticks = GetTickCount();
+    ret = select(0, &readfds, &writefds, &exceptfds, &select_timeout);
+    ticks = GetTickCount() - ticks;
+    ok(ret == 1, "select returned %d\n", ret);
+    ok(ticks >= 150, "select returned after %u ms, expected 200 ms\n", ticks);
+    ok(ticks < 2000, "select returned after %u ms, expected 200 ms\n", ticks);
+    ok(FD_ISSET(fdRead, &readfds), "fdRead socket is not in the read set\n");
+    ok(!FD_ISSET(fdUnbound, &readfds), "unbound socket is in the read set\n");
+    ok(!FD_ISSET(fdUnbound, &writefds), "unbound socket is in the write set\n");
+    ok(!FD_ISSET(fdUnbound, &exceptfds), "unbound socket is in the except set\n");
+    WaitForSingleObject(thread, 1000);
+    CloseHandle(thread);
+
+    ret = recv(fdRead, buffer, sizeof(buffer), 0);
+    ok(ret == 4, "recv returned %d\n", ret);
+
+    closesocket(fdUnbound);
+    closesocket(fdRead);
+    closesocket(fdWrite);
+}
 #undef FD_SET_ALL
 #undef FD_ZERO_ALL
 
@@ -6534,6 +6616,115 @@ static BOOL poll_isset(WSAPOLLFD *fds, int max, SOCKET s, int rev)
     return FALSE;
 }
 
+static void test_WSARecvFrom_datagrams(void)
+{
+    SOCKET src, dest;
+    struct sockaddr_in addr, from[6], src_addr;
+    int addrlen, fromlen[6], len, ret, i;
+    char buf[6][16], expected[16];
+    WSABUF bufs[6];
+    WSAOVERLAPPED ov[6];
+    DWORD flags[6], bytes, dwret;
+    fd_set readfds;
+    struct timeval timeout;
+    BOOL bret;
+
+    src = socket(AF_INET, SOCK_DGRAM, 0);
+    dest = WSASocketA(AF_INET, SOCK_DGRAM, 0, NULL, 0, WSA_FLAG_OVERLAPPED);
+    ok(src != INVALID_SOCKET && dest != INVALID_SOCKET, "socket failed, error %d\n", WSAGetLastError());
+    if (src == INVALID_SOCKET || dest == INVALID_SOCKET) goto end;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ret = bind(dest, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "bind failed, error %d\n", WSAGetLastError());
+    ret = bind(src, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "bind failed, error %d\n", WSAGetLastError());
+    addrlen = sizeof(addr);
+    ret = getsockname(dest, (struct sockaddr *)&addr, &addrlen);
+    ok(!ret, "getsockname failed, error %d\n", WSAGetLastError());
+    len = sizeof(src_addr);
+    ret = getsockname(src, (struct sockaddr *)&src_addr, &len);
+    ok(!ret, "getsockname failed, error %d\n", WSAGetLastError());
+
+    /* a burst of datagrams completes the pending reads in order, each with its own datagram */
+    for (i = 0; i < 6; i++)
+    {
+        memset(buf[i], 0, sizeof(buf[i]));
+        bufs[i].buf = buf[i];
+        bufs[i].len = sizeof(buf[i]);
+        memset(&ov[i], 0, sizeof(ov[i]));
+        ov[i].hEvent = WSACreateEvent();
+        flags[i] = 0;
+        fromlen[i] = sizeof(from[i]);
+        ret = WSARecvFrom(dest, &bufs[i], 1, NULL, &flags[i], (struct sockaddr *)&from[i], &fromlen[i], &ov[i], NULL);
+        ok(ret == SOCKET_ERROR && WSAGetLastError() == ERROR_IO_PENDING,
+           "%d: WSARecvFrom returned %d, error %d\n", i, ret, WSAGetLastError());
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        sprintf(expected, "datagram %d", i);
+        ret = sendto(src, expected, strlen(expected) + i, 0, (struct sockaddr *)&addr, sizeof(addr));
+        ok(ret == strlen(expected) + i, "%d: sendto returned %d, error %d\n", i, ret, WSAGetLastError());
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        dwret = WaitForSingleObject(ov[i].hEvent, 1000);
+        ok(dwret == WAIT_OBJECT_0, "%d: wait failed, ret %u\n", i, dwret);
+        bret = WSAGetOverlappedResult(dest, &ov[i], &bytes, FALSE, &flags[i]);
+        ok(bret, "%d: WSAGetOverlappedResult failed, error %d\n", i, WSAGetLastError());
+        sprintf(expected, "datagram %d", i);
+        ok(bytes == strlen(expected) + i, "%d: got %u bytes\n", i, bytes);
+        ok(!memcmp(buf[i], expected, strlen(expected)), "%d: got %s\n", i, buf[i]);
+        ok(fromlen[i] == sizeof(from[i]), "%d: got address length %d\n", i, fromlen[i]);
+        ok(from[i].sin_port == src_addr.sin_port, "%d: got port %u, expected %u\n",
+           i, ntohs(from[i].sin_port), ntohs(src_addr.sin_port));
+        WSACloseEvent(ov[i].hEvent);
+    }
+
+    /* the reads without a datagram stay pending, and don't get any once cancelled */
+    for (i = 4; i < 6; i++)
+    {
+        dwret = WaitForSingleObject(ov[i].hEvent, 100);
+        ok(dwret == WAIT_TIMEOUT, "%d: wait returned %u\n", i, dwret);
+    }
+    bret = CancelIo((HANDLE)dest);
+    ok(bret, "CancelIo failed, error %u\n", GetLastError());
+    for (i = 4; i < 6; i++)
+    {
+        dwret = WaitForSingleObject(ov[i].hEvent, 1000);
+        ok(dwret == WAIT_OBJECT_0, "%d: wait failed, ret %u\n", i, dwret);
+        bret = WSAGetOverlappedResult(dest, &ov[i], &bytes, FALSE, &flags[i]);
+        ok(!bret && WSAGetLastError() == WSA_OPERATION_ABORTED,
+           "%d: WSAGetOverlappedResult returned %d, error %d\n", i, bret, WSAGetLastError());
+        ok(!buf[i][0], "%d: got %s\n", i, buf[i]);
+        WSACloseEvent(ov[i].hEvent);
+    }
+
+    ret = sendto(src, "datagram 4", 10, 0, (struct sockaddr *)&addr, sizeof(addr));
+    ok(ret == 10, "sendto returned %d, error %d\n", ret, WSAGetLastError());
+    FD_ZERO(&readfds);
+    FD_SET(dest, &readfds);
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    ret = select(0, &readfds, NULL, NULL, &timeout);
+    ok(ret == 1, "select returned %d\n", ret);
+    if (ret == 1)
+    {
+        memset(buf[0], 0, sizeof(buf[0]));
+        ret = recv(dest, buf[0], sizeof(buf[0]), 0);
+        ok(ret == 10, "recv returned %d, error %d\n", ret, WSAGetLastError());
+        ok(!memcmp(buf[0], "datagram 4", 10), "got %s\n", buf[0]);
+    }
+
+end:
+    if (src != INVALID_SOCKET) closesocket(src);
+    if (dest != INVALID_SOCKET) closesocket(dest);
+}
+
 static void test_WSAPoll(void)
 {
     int ix, ret, err, poll_timeout;
@@ -7989,6 +8180,16 @@ static void test_TransmitFile(void)
     ok(bret, "TransmitFile failed unexpectedly.\n");
     compare_file(file, dest, 0);
 
+    /* Test TransmitFile with a limited amount of file data */
+    SetFilePointer(file, 0, NULL, FILE_BEGIN);
+    bret = pTransmitFile(client, file, 100, 32, NULL, NULL, 0);
+    ok(bret, "TransmitFile failed unexpectedly.\n");
+    iret = recv(dest, buf, sizeof(buf), 0);
+    ok(iret == 100, "Returned an unexpected amount of data from TransmitFile (%d != 100).\n", iret);
+    SetFilePointer(file, 0, NULL, FILE_BEGIN);
+    ReadFile(file, buf + 100, 100, &num_bytes, NULL);
+    ok(memcmp(buf, buf + 100, 100) == 0, "TransmitFile file data did not match!\n");
+
     /* Test TransmitFile with both file and buffer data */
     buffers.Head = &header_msg[0];
     buffers.HeadLength = sizeof(header_msg)+1;
@@ -9142,6 +9343,70 @@ static void test_completion_port(void)
     CloseHandle(previous_port);
 }
 
+static void test_completion_notification_modes(void)
+{
+    BOOL (WINAPI *pSetFileCompletionNotificationModes)(HANDLE,UCHAR);
+    WSAOVERLAPPED ov, *olp;
+    SOCKET src, dest;
+    HANDLE port;
+    ULONG_PTR key;
+    DWORD num_bytes;
+    WSABUF wsabuf;
+    char buf[] = "hello";
+    BOOL bret;
+    int iret;
+
+    pSetFileCompletionNotificationModes = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"),
+                                                                 "SetFileCompletionNotificationModes");
+    if (!pSetFileCompletionNotificationModes)
+    {
+        win_skip("SetFileCompletionNotificationModes not available\n");
+        return;
+    }
+
+    if (tcp_socketpair(&src, &dest) != 0)
+    {
+        ok(0, "creating the socket pair failed\n");
+        return;
+    }
+
+    port = CreateIoCompletionPort((HANDLE)src, NULL, 125, 0);
+    ok(port != NULL, "failed to create completion port %u\n", GetLastError());
+
+    wsabuf.len = sizeof(buf);
+    wsabuf.buf = buf;
+
+    /* completions are posted for operations succeeding immediately by default */
+    memset(&ov, 0, sizeof(ov));
+    iret = WSASend(src, &wsabuf, 1, &num_bytes, 0, &ov, NULL);
+    ok(!iret, "WSASend failed - %d\n", WSAGetLastError());
+    olp = NULL;
+    bret = GetQueuedCompletionStatus(port, &num_bytes, &key, &olp, 1000);
+    ok(bret, "failed to get completion status %u\n", GetLastError());
+    ok(key == 125, "Key is %lu\n", key);
+    ok(num_bytes == sizeof(buf), "Number of bytes transferred is %u\n", num_bytes);
+    ok(olp == &ov, "Overlapped structure is at %p\n", olp);
+
+    bret = pSetFileCompletionNotificationModes((HANDLE)src, FILE_SKIP_COMPLETION_PORT_ON_SUCCESS);
+    ok(bret, "SetFileCompletionNotificationModes failed %u\n", GetLastError());
+
+    memset(&ov, 0, sizeof(ov));
+    iret = WSASend(src, &wsabuf, 1, &num_bytes, 0, &ov, NULL);
+    ok(!iret, "WSASend failed - %d\n", WSAGetLastError());
+    ok(num_bytes == sizeof(buf), "Number of bytes transferred is %u\n", num_bytes);
+
+    SetLastError(0xdeadbeef);
+    olp = (WSAOVERLAPPED *)0xdeadbeef;
+    bret = GetQueuedCompletionStatus(port, &num_bytes, &key, &olp, 200);
+    ok(!bret, "got unexpected completion\n");
+    ok(GetLastError() == WAIT_TIMEOUT, "Last error was %u\n", GetLastError());
+    ok(!olp, "Overlapped structure is at %p\n", olp);
+
+    closesocket(src);
+    closesocket(dest);
+    CloseHandle(port);
+}
+
 static void test_address_list_query(void)
 {
     SOCKET_ADDRESS_LIST *address_list;
@@ -9608,6 +9873,7 @@ START_TEST( sock )
     test_errors();
     test_listen();
     test_select();
+    test_select_unbound();
     test_accept();
     test_getpeername();
     test_getsockname();
@@ -9622,6 +9888,7 @@ START_TEST( sock )
     test_WSASendMsg();
     test_WSASendTo();
     test_WSARecv();
+    test_WSARecvFrom_datagrams();
     test_WSAPoll();
 
     test_events(0);
@@ -9645,6 +9912,7 @@ START_TEST( sock )
     test_WSAAsyncGetServByName();
 
     test_completion_port();
+    test_completion_notification_modes();
     test_address_list_query();
 
     /* this is an io heavy test, do it at the end so the kernel doesn't start dropping packets */
@@ -54,16 +54,10 @@ struct request_max_size
 #define LAST_USER_HANDLE  0xffef
 
 
-typedef struct
-{
-    unsigned int last_input_time;
-    unsigned int foreground_wnd_epoch;
-} shmglobal_t;
-
-
 typedef struct
 {
     int             queue_bits;
+    int             changed_bits;
     user_handle_t   input_focus;
     user_handle_t   input_capture;
     user_handle_t   input_active;
@@ -263,6 +257,32 @@ typedef struct
 } rectangle_t;
 
 
+typedef struct
+{
+    unsigned int   seq;
+    user_handle_t  handle;
+    user_handle_t  parent;
+    user_handle_t  owner;
+    unsigned int   style;
+    unsigned int   ex_style;
+    process_id_t   pid;
+    thread_id_t    tid;
+    rectangle_t    window;
+    rectangle_t    client;
+} shmwindow_t;
+
+
+#define SHM_MAX_WINDOWS 4096
+
+
+typedef struct
+{
+    unsigned int last_input_time;
+    unsigned int foreground_wnd_epoch;
+    shmwindow_t  windows[SHM_MAX_WINDOWS];
+} shmglobal_t;
+
+
 typedef struct
 {
     obj_handle_t    handle;
@@ -1467,6 +1487,10 @@ struct get_handle_fd_reply
     unsigned int access;
     unsigned int options;
 };
+/* Wine-specific bit in the get_handle_fd options, set when operations that succeed
+ * synchronously must not queue a completion packet (FILE_SKIP_COMPLETION_PORT_ON_SUCCESS);
+ * it reuses FILE_OPEN_FOR_FREE_SPACE_QUERY, which has no meaning once the file is open */
+#define FD_OPTION_SKIP_COMPLETION_ON_SUCCESS 0x00800000
 enum server_fd_type
 {
     FD_TYPE_INVALID,
@@ -1670,6 +1694,22 @@ struct enable_socket_event_reply
     struct reply_header __header;
 };
 
+
+struct wake_socket_async_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+    int          type;
+    /* VARARG(iosb,bytes); */
+    char __pad_20[4];
+};
+struct wake_socket_async_reply
+{
+    struct reply_header __header;
+    int          count;
+    char __pad_12[4];
+};
+
 struct set_socket_deferred_request
 {
     struct request_header __header;
@@ -3451,6 +3491,8 @@ struct get_window_info_reply
     thread_id_t    tid;
     atom_t         atom;
     int            is_unicode;
+    int            is_visible;
+    char __pad_36[4];
 };
 
 
@@ -3575,6 +3617,8 @@ struct get_window_tree_reply
     user_handle_t  last_sibling;
     user_handle_t  first_child;
     user_handle_t  last_child;
+    unsigned int   style;
+    char __pad_44[4];
 };
 
 
@@ -5143,6 +5187,20 @@ struct set_completion_info_reply
 
 
 
+struct set_fd_completion_mode_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+    unsigned int  flags;
+    char __pad_20[4];
+};
+struct set_fd_completion_mode_reply
+{
+    struct reply_header __header;
+};
+
+
+
 struct add_fd_completion_request
 {
     struct request_header __header;
@@ -5492,6 +5550,7 @@ enum request
     REQ_get_socket_event,
     REQ_get_socket_info,
     REQ_enable_socket_event,
+    REQ_wake_socket_async,
     REQ_set_socket_deferred,
     REQ_alloc_console,
     REQ_free_console,
@@ -5691,6 +5750,7 @@ enum request
     REQ_remove_completion,
     REQ_query_completion,
     REQ_set_completion_info,
+    REQ_set_fd_completion_mode,
     REQ_add_fd_completion,
     REQ_set_fd_disp_info,
     REQ_set_fd_name_info,
@@ -5774,6 +5834,7 @@ union generic_request
     struct get_socket_event_request get_socket_event_request;
     struct get_socket_info_request get_socket_info_request;
     struct enable_socket_event_request enable_socket_event_request;
+    struct wake_socket_async_request wake_socket_async_request;
     struct set_socket_deferred_request set_socket_deferred_request;
     struct alloc_console_request alloc_console_request;
     struct free_console_request free_console_request;
@@ -5973,6 +6034,7 @@ union generic_request
     struct remove_completion_request remove_completion_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
+    struct set_fd_completion_mode_request set_fd_completion_mode_request;
     struct add_fd_completion_request add_fd_completion_request;
     struct set_fd_disp_info_request set_fd_disp_info_request;
     struct set_fd_name_info_request set_fd_name_info_request;
@@ -6054,6 +6116,7 @@ union generic_reply
     struct get_socket_event_reply get_socket_event_reply;
     struct get_socket_info_reply get_socket_info_reply;
     struct enable_socket_event_reply enable_socket_event_reply;
+    struct wake_socket_async_reply wake_socket_async_reply;
     struct set_socket_deferred_reply set_socket_deferred_reply;
     struct alloc_console_reply alloc_console_reply;
     struct free_console_reply free_console_reply;
@@ -6253,6 +6316,7 @@ union generic_reply
     struct remove_completion_reply remove_completion_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
+    struct set_fd_completion_mode_reply set_fd_completion_mode_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
     struct set_fd_disp_info_reply set_fd_disp_info_reply;
     struct set_fd_name_info_reply set_fd_name_info_reply;
@@ -6274,6 +6338,6 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 503
+#define SERVER_PROTOCOL_VERSION 511
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
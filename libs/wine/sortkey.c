@@ -359,6 +359,15 @@ int wine_compare_string(int flags, const WCHAR *str1, int len1,
 {
     int ret;
 
+    /* identical leading chars have identical weights in every pass, skip them only once */
+    while (len1 > 0 && len2 > 0 && *str1 == *str2)
+    {
+        str1++;
+        str2++;
+        len1--;
+        len2--;
+    }
+
     ret = compare_unicode_weights(flags, str1, len1, str2, len2);
     if (!ret)
     {
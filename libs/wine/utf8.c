@@ -273,6 +273,23 @@ static int utf8_mbstowcs_compose( int flags, const char *src, int srclen, WCHAR
     return dstlen - (dstend - dst);
 }
 
+/* return the length of the 7-bit ASCII run at the start of src, checking a word at a time */
+static inline unsigned int get_ascii_run( const char *src, unsigned int srclen )
+{
+    const size_t mask = (size_t)~0 / 0xff * 0x80;
+    unsigned int len = 0;
+    size_t word;
+
+    while (len + sizeof(word) <= srclen)
+    {
+        memcpy( &word, src + len, sizeof(word) );
+        if (word & mask) break;
+        len += sizeof(word);
+    }
+    while (len < srclen && !(src[len] & 0x80)) len++;
+    return len;
+}
+
 /* query necessary dst length for src string */
 static inline int get_length_mbs_utf8( int flags, const char *src, int srclen )
 {
@@ -285,7 +302,9 @@ static inline int get_length_mbs_utf8( int flags, const char *src, int srclen )
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
-            ret++;
+            unsigned int len = get_ascii_run( src, srcend - src );
+            src += len;
+            ret += len + 1;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0x10ffff)
@@ -316,7 +335,11 @@ int wine_utf8_mbstowcs( int flags, const char *src, int srclen, WCHAR *dst, int
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
+            unsigned int i, len = get_ascii_run( src, min( srcend - src, dstend - dst - 1 ));
             *dst++ = ch;
+            for (i = 0; i < len; i++) dst[i] = (unsigned char)src[i];
+            src += len;
+            dst += len;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
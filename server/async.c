@@ -321,7 +321,8 @@ void async_set_result( struct object *obj, unsigned int status, apc_param_t tota
             thread_queue_apc( async->thread, NULL, &data );
         }
         if (async->event) set_event( async->event );
-        else if (async->queue->fd) set_fd_signaled( async->queue->fd, 1 );
+        else if (async->queue->fd && !(fd_get_completion_flags( async->queue->fd ) & FILE_SKIP_SET_EVENT_ON_HANDLE))
+            set_fd_signaled( async->queue->fd, 1 );
         async->signaled = 1;
         wake_up( &async->obj, 0 );
     }
@@ -367,6 +368,24 @@ int async_wake_up_by( struct async_queue *queue, struct process *process,
     return woken;
 }
 
+/* wake up the async of a thread with the given iosb, only if it is still pending */
+int async_wake_up_pending( struct async_queue *queue, struct thread *thread,
+                           client_ptr_t iosb, unsigned int status )
+{
+    struct async *async;
+
+    if (!queue) return 0;
+
+    LIST_FOR_EACH_ENTRY( async, &queue->queue, struct async, queue_entry )
+    {
+        if (async->thread != thread || async->data.iosb != iosb) continue;
+        if (async->status != STATUS_PENDING) return 0;
+        async_terminate( async, status );
+        return 1;
+    }
+    return 0;
+}
+
 /* wake up async operations on the queue */
 void async_wake_up( struct async_queue *queue, unsigned int status )
 {
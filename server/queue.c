@@ -487,7 +487,10 @@ static inline void update_shm_queue_bits( struct msg_queue *queue )
     shmlocal_t *shm;
     if (!queue->thread) return;
     if ((shm = queue->thread->shm))
-        shm->queue_bits = queue->wake_bits;
+    {
+        shm->queue_bits   = queue->wake_bits;
+        shm->changed_bits = queue->changed_bits;
+    }
 }
 
 /* set some queue bits */
@@ -2376,6 +2379,7 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_shm_queue_bits( queue );
     }
     else reply->wake_bits = reply->changed_bits = 0;
 }
@@ -2559,6 +2563,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_shm_queue_bits( queue );
 
     /* then check for posted messages */
     if ((filter & QS_POSTMESSAGE) &&
@@ -169,6 +169,7 @@ DECL_HANDLER(set_socket_event);
 DECL_HANDLER(get_socket_event);
 DECL_HANDLER(get_socket_info);
 DECL_HANDLER(enable_socket_event);
+DECL_HANDLER(wake_socket_async);
 DECL_HANDLER(set_socket_deferred);
 DECL_HANDLER(alloc_console);
 DECL_HANDLER(free_console);
@@ -368,6 +369,7 @@ DECL_HANDLER(add_completion);
 DECL_HANDLER(remove_completion);
 DECL_HANDLER(query_completion);
 DECL_HANDLER(set_completion_info);
+DECL_HANDLER(set_fd_completion_mode);
 DECL_HANDLER(add_fd_completion);
 DECL_HANDLER(set_fd_disp_info);
 DECL_HANDLER(set_fd_name_info);
@@ -450,6 +452,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_get_socket_event,
     (req_handler)req_get_socket_info,
     (req_handler)req_enable_socket_event,
+    (req_handler)req_wake_socket_async,
     (req_handler)req_set_socket_deferred,
     (req_handler)req_alloc_console,
     (req_handler)req_free_console,
@@ -649,6 +652,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_remove_completion,
     (req_handler)req_query_completion,
     (req_handler)req_set_completion_info,
+    (req_handler)req_set_fd_completion_mode,
     (req_handler)req_add_fd_completion,
     (req_handler)req_set_fd_disp_info,
     (req_handler)req_set_fd_name_info,
@@ -1054,6 +1058,11 @@ C_ASSERT( FIELD_OFFSET(struct enable_socket_event_request, mask) == 16 );
 C_ASSERT( FIELD_OFFSET(struct enable_socket_event_request, sstate) == 20 );
 C_ASSERT( FIELD_OFFSET(struct enable_socket_event_request, cstate) == 24 );
 C_ASSERT( sizeof(struct enable_socket_event_request) == 32 );
+C_ASSERT( FIELD_OFFSET(struct wake_socket_async_request, handle) == 12 );
+C_ASSERT( FIELD_OFFSET(struct wake_socket_async_request, type) == 16 );
+C_ASSERT( sizeof(struct wake_socket_async_request) == 24 );
+C_ASSERT( FIELD_OFFSET(struct wake_socket_async_reply, count) == 8 );
+C_ASSERT( sizeof(struct wake_socket_async_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_socket_deferred_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_socket_deferred_request, deferred) == 16 );
 C_ASSERT( sizeof(struct set_socket_deferred_request) == 24 );
@@ -1657,7 +1666,8 @@ C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, pid) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, tid) == 20 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, atom) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, is_unicode) == 28 );
-C_ASSERT( sizeof(struct get_window_info_reply) == 32 );
+C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, is_visible) == 32 );
+C_ASSERT( sizeof(struct get_window_info_reply) == 40 );
 C_ASSERT( FIELD_OFFSET(struct set_window_info_request, flags) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_window_info_request, is_unicode) == 14 );
 C_ASSERT( FIELD_OFFSET(struct set_window_info_request, handle) == 16 );
@@ -1710,7 +1720,8 @@ C_ASSERT( FIELD_OFFSET(struct get_window_tree_reply, first_sibling) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_window_tree_reply, last_sibling) == 28 );
 C_ASSERT( FIELD_OFFSET(struct get_window_tree_reply, first_child) == 32 );
 C_ASSERT( FIELD_OFFSET(struct get_window_tree_reply, last_child) == 36 );
-C_ASSERT( sizeof(struct get_window_tree_reply) == 40 );
+C_ASSERT( FIELD_OFFSET(struct get_window_tree_reply, style) == 40 );
+C_ASSERT( sizeof(struct get_window_tree_reply) == 48 );
 C_ASSERT( FIELD_OFFSET(struct set_window_pos_request, swp_flags) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_window_pos_request, paint_flags) == 14 );
 C_ASSERT( FIELD_OFFSET(struct set_window_pos_request, handle) == 16 );
@@ -2243,6 +2254,9 @@ C_ASSERT( FIELD_OFFSET(struct set_completion_info_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_completion_info_request, ckey) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_completion_info_request, chandle) == 24 );
 C_ASSERT( sizeof(struct set_completion_info_request) == 32 );
+C_ASSERT( FIELD_OFFSET(struct set_fd_completion_mode_request, handle) == 12 );
+C_ASSERT( FIELD_OFFSET(struct set_fd_completion_mode_request, flags) == 16 );
+C_ASSERT( sizeof(struct set_fd_completion_mode_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, cvalue) == 16 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, information) == 24 );
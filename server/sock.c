@@ -1410,6 +1410,26 @@ DECL_HANDLER(enable_socket_event)
     release_object( &sock->obj );
 }
 
+DECL_HANDLER(wake_socket_async)
+{
+    struct sock *sock;
+    struct async_queue *queue;
+    const client_ptr_t *iosb = get_req_data();
+    data_size_t i, count = get_req_data_size() / sizeof(*iosb);
+
+    if (!(sock = (struct sock*)get_handle_obj( current->process, req->handle, 0, &sock_ops )))
+        return;
+
+    /* stop at the first one that was cancelled or already woken up, so that
+     * the client never transfers data on behalf of an async out of order */
+    queue = (req->type == ASYNC_TYPE_READ) ? sock->read_q : sock->write_q;
+    for (i = 0; i < count; i++)
+        if (!async_wake_up_pending( queue, current, iosb[i], STATUS_ALERTED )) break;
+    reply->count = i;
+
+    release_object( &sock->obj );
+}
+
 DECL_HANDLER(set_socket_deferred)
 {
     struct sock *sock, *acceptsock;
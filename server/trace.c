@@ -1848,6 +1848,18 @@ static void dump_enable_socket_event_request( const struct enable_socket_event_r
     fprintf( stderr, ", cstate=%08x", req->cstate );
 }
 
+static void dump_wake_socket_async_request( const struct wake_socket_async_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", type=%d", req->type );
+    dump_varargs_bytes( ", iosb=", cur_size );
+}
+
+static void dump_wake_socket_async_reply( const struct wake_socket_async_reply *req )
+{
+    fprintf( stderr, " count=%d", req->count );
+}
+
 static void dump_set_socket_deferred_request( const struct set_socket_deferred_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -2997,6 +3009,7 @@ static void dump_get_window_info_reply( const struct get_window_info_reply *req
     fprintf( stderr, ", tid=%04x", req->tid );
     fprintf( stderr, ", atom=%04x", req->atom );
     fprintf( stderr, ", is_unicode=%d", req->is_unicode );
+    fprintf( stderr, ", is_visible=%d", req->is_visible );
 }
 
 static void dump_set_window_info_request( const struct set_window_info_request *req )
@@ -3090,6 +3103,7 @@ static void dump_get_window_tree_reply( const struct get_window_tree_reply *req
     fprintf( stderr, ", last_sibling=%08x", req->last_sibling );
     fprintf( stderr, ", first_child=%08x", req->first_child );
     fprintf( stderr, ", last_child=%08x", req->last_child );
+    fprintf( stderr, ", style=%08x", req->style );
 }
 
 static void dump_set_window_pos_request( const struct set_window_pos_request *req )
@@ -4175,6 +4189,12 @@ static void dump_set_completion_info_request( const struct set_completion_info_r
     fprintf( stderr, ", chandle=%04x", req->chandle );
 }
 
+static void dump_set_fd_completion_mode_request( const struct set_fd_completion_mode_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", flags=%08x", req->flags );
+}
+
 static void dump_add_fd_completion_request( const struct add_fd_completion_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4392,6 +4412,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_socket_event_request,
     (dump_func)dump_get_socket_info_request,
     (dump_func)dump_enable_socket_event_request,
+    (dump_func)dump_wake_socket_async_request,
     (dump_func)dump_set_socket_deferred_request,
     (dump_func)dump_alloc_console_request,
     (dump_func)dump_free_console_request,
@@ -4591,6 +4612,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_remove_completion_request,
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
+    (dump_func)dump_set_fd_completion_mode_request,
     (dump_func)dump_add_fd_completion_request,
     (dump_func)dump_set_fd_disp_info_request,
     (dump_func)dump_set_fd_name_info_request,
@@ -4670,6 +4692,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_socket_event_reply,
     (dump_func)dump_get_socket_info_reply,
     NULL,
+    (dump_func)dump_wake_socket_async_reply,
     NULL,
     (dump_func)dump_alloc_console_reply,
     NULL,
@@ -4873,6 +4896,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     NULL,
     NULL,
+    NULL,
     (dump_func)dump_get_window_layered_info_reply,
     NULL,
     (dump_func)dump_alloc_user_handle_reply,
@@ -4948,6 +4972,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "get_socket_event",
     "get_socket_info",
     "enable_socket_event",
+    "wake_socket_async",
     "set_socket_deferred",
     "alloc_console",
     "free_console",
@@ -5147,6 +5172,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "remove_completion",
     "query_completion",
     "set_completion_info",
+    "set_fd_completion_mode",
     "add_fd_completion",
     "set_fd_disp_info",
     "set_fd_name_info",
@@ -33,6 +33,7 @@
 #include "winternl.h"
 
 #include "object.h"
+#include "file.h"
 #include "request.h"
 #include "thread.h"
 #include "process.h"
@@ -174,6 +175,45 @@ static inline void update_pixel_format_flags( struct window *win )
         win->paint_flags |= PAINT_PIXEL_FORMAT_CHILD;
 }
 
+/* get the shared memory information of a window */
+static inline shmwindow_t *get_shm_window( struct window *win )
+{
+    unsigned int index = ((win->handle & 0xffff) - FIRST_USER_HANDLE) >> 1;
+
+    if (!shmglobal || index >= SHM_MAX_WINDOWS) return NULL;
+    return &shmglobal->windows[index];
+}
+
+/* synchronize the window state with the shared memory */
+static void update_shm_window( struct window *win )
+{
+    shmwindow_t *shm;
+
+    if (!(shm = get_shm_window( win ))) return;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+    shm->handle   = win->handle;
+    shm->parent   = win->parent ? win->parent->handle : 0;
+    shm->owner    = win->owner;
+    shm->style    = win->style;
+    shm->ex_style = win->ex_style;
+    shm->pid      = win->thread ? get_process_id( win->thread->process ) : 0;
+    shm->tid      = win->thread ? get_thread_id( win->thread ) : 0;
+    shm->window   = win->window_rect;
+    shm->client   = win->client_rect;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+}
+
+/* remove a destroyed window from the shared memory */
+static void clear_shm_window( struct window *win )
+{
+    shmwindow_t *shm;
+
+    if (!(shm = get_shm_window( win ))) return;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+    shm->handle = 0;
+    interlocked_xchg_add( (int *)&shm->seq, 1 );
+}
+
 /* link a window at the right place in the siblings list */
 static void link_window( struct window *win, struct window *previous )
 {
@@ -227,6 +267,7 @@ static void link_window( struct window *win, struct window *previous )
     }
 
     win->is_linked = 1;
+    update_shm_window( win );
 }
 
 /* change the parent of a window (or unlink the window if the new parent is NULL) */
@@ -401,6 +442,7 @@ static void detach_window_thread( struct window *win )
     /* destroyed when the desktop ref count reaches zero */
     release_object( win->desktop );
     win->thread = NULL;
+    update_shm_window( win );
 }
 
 /* get the process owning the top window of a given desktop */
@@ -527,6 +569,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     }
 
     current->desktop_users++;
+    update_shm_window( win );
     return win;
 
 failed:
@@ -624,6 +667,17 @@ static int is_visible( const struct window *win )
     return 1;
 }
 
+/* check if window and all its ancestors below the top window have the WS_VISIBLE style,
+ * and the top window is the desktop window; this matches IsWindowVisible */
+static int is_visible_on_desktop( const struct window *win )
+{
+    if (!(win->style & WS_VISIBLE)) return 0;
+    if (!win->parent) return 1;
+    for (win = win->parent; win->parent; win = win->parent)
+        if (!(win->style & WS_VISIBLE)) return 0;
+    return win == win->desktop->top_window;
+}
+
 /* same as is_visible but takes a window handle */
 int is_window_visible( user_handle_t window )
 {
@@ -1657,6 +1711,7 @@ static void set_window_pos( struct window *win, struct window *previous,
     if (!(swp_flags & SWP_NOZORDER) && win->parent) link_window( win, previous );
     if (swp_flags & SWP_SHOWWINDOW) win->style |= WS_VISIBLE;
     else if (swp_flags & SWP_HIDEWINDOW) win->style &= ~WS_VISIBLE;
+    update_shm_window( win );
 
     /* keep children at the same position relative to top right corner when the parent is mirrored */
     if (win->ex_style & WS_EX_LAYOUTRTL)
@@ -1670,6 +1725,7 @@ static void set_window_pos( struct window *win, struct window *previous,
             offset_rect( &child->window_rect, new_size - old_size, 0 );
             offset_rect( &child->visible_rect, new_size - old_size, 0 );
             offset_rect( &child->client_rect, new_size - old_size, 0 );
+            update_shm_window( child );
         }
     }
 
@@ -1855,6 +1911,7 @@ void destroy_window( struct window *win )
     if (win == progman_window) progman_window = NULL;
     if (win == taskman_window) taskman_window = NULL;
     free_hotkeys( win->desktop, win->handle );
+    clear_shm_window( win );
     free_user_handle( win->handle );
     destroy_properties( win );
     list_remove( &win->entry );
@@ -1965,6 +2022,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shm_window( desktop->top_window );
         }
     }
 
@@ -1977,6 +2035,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shm_window( desktop->msg_window );
         }
     }
 
@@ -2012,6 +2071,7 @@ DECL_HANDLER(set_window_owner)
 
     reply->prev_owner = win->owner;
     reply->full_owner = win->owner = owner ? owner->handle : 0;
+    update_shm_window( win );
 }
 
 
@@ -2027,6 +2087,7 @@ DECL_HANDLER(get_window_info)
         reply->full_handle = win->handle;
         reply->last_active = win->handle;
         reply->is_unicode  = win->is_unicode;
+        reply->is_visible  = is_visible_on_desktop( win );
         if (get_user_object( win->last_active, USER_WINDOW )) reply->last_active = win->last_active;
         if (win->thread)
         {
@@ -2085,6 +2146,8 @@ DECL_HANDLER(set_window_info)
     if (req->flags & SET_WIN_EXTRA) memcpy( win->extra_bytes + req->extra_offset,
                                             &req->extra_value, req->extra_size );
 
+    if (req->flags & (SET_WIN_STYLE | SET_WIN_EXSTYLE)) update_shm_window( win );
+
     /* changing window style triggers a non-client paint */
     if (req->flags & SET_WIN_STYLE) win->paint_flags |= PAINT_NONCLIENT;
 }
@@ -2196,6 +2259,7 @@ DECL_HANDLER(get_window_tree)
     reply->last_sibling  = 0;
     reply->first_child   = 0;
     reply->last_child    = 0;
+    reply->style         = win->style;
 
     if (win->parent)
     {